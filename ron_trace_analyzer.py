@@ -4,7 +4,7 @@ RON_TRACE_ANALYZER_DESCRIPTION = '''A helper script for analyzing ns3 Resilient
 # (c) University of California Irvine 2012
 # @author: Kyle Benson
 
-import argparse, os.path, os, decimal, math, heapq, sys, scipy.stats, itertools #numpy
+import argparse, os.path, os, decimal, math, heapq, sys, scipy.stats, itertools, struct #numpy
 
 ##################################################################################
 #################      ARGUMENTS       ###########################################
@@ -216,6 +216,13 @@ class TraceRun:
     DIRECT_ACK_INDEX = 3
     TIME_INDEX = 6
 
+    # Binary trace format written with --binary_traces
+    BINARY_MAGIC = 'RONTRACE'
+    BINARY_HEADER = struct.Struct('<8sIIq')
+    BINARY_RECORD = struct.Struct('<BBBxIqIIII')
+    SEND_RECORD, ACK_RECORD, FORWARD_RECORD = range(3)
+    INDIRECT_FLAG = 1
+
     TIME_RESOLUTION = 0.1 #In seconds
 
     def __init__(self,filename):
@@ -233,6 +240,13 @@ class TraceRun:
 
         sigDigits = int(round(-math.log(TraceRun.TIME_RESOLUTION,10)))
 
+        with open(filename, 'rb') as f:
+            isBinary = f.read(len(TraceRun.BINARY_MAGIC)) == TraceRun.BINARY_MAGIC
+
+        if isBinary:
+            self.readBinary(filename, sigDigits)
+            return
+
         with open(filename) as f:
 
             for line in f.readlines():
@@ -264,6 +278,42 @@ class TraceRun:
                     node.sends += 1
                     self.sendTimes[time] = self.sendTimes.get(time,0) + 1
 
+    def readBinary(self, filename, sigDigits):
+        '''Reads a binary trace (see scratch/ron/ron-trace-file.h), which holds the same events as the text lines.'''
+        with open(filename, 'rb') as f:
+            magic, version, recordSize, stepsPerSecond = TraceRun.BINARY_HEADER.unpack(f.read(TraceRun.BINARY_HEADER.size))
+            if version != 1 or recordSize != TraceRun.BINARY_RECORD.size:
+                raise ValueError("%s has unsupported binary trace version %d" % (filename, version))
+            data = f.read()
+
+        stepsPerSecond = float(stepsPerSecond)
+        for offset in xrange(0, len(data) - recordSize + 1, recordSize):
+            eventType, flags, hop, nodeId, steps = TraceRun.BINARY_RECORD.unpack_from(data, offset)[:5]
+            nodeId = str(nodeId)
+            time = round(steps / stepsPerSecond, sigDigits)
+
+            node = self.nodes.get(nodeId)
+            if not node:
+                node = self.nodes[nodeId] = TraceNode(nodeId)
+
+            if eventType == TraceRun.ACK_RECORD:
+                node.acks += 1
+                self.ackTimes[time] = self.ackTimes.get(time,0) + 1
+
+                if not node.firstAckTime:
+                    node.firstAckTime = time
+
+                if not flags & TraceRun.INDIRECT_FLAG:
+                    node.directAcks += 1
+
+            elif eventType == TraceRun.FORWARD_RECORD:
+                node.forwards += 1
+                self.forwardTimes[time] = self.forwardTimes.get(time,0) + 1
+
+            elif eventType == TraceRun.SEND_RECORD:
+                node.sends += 1
+                self.sendTimes[time] = self.sendTimes.get(time,0) + 1
+
     def getNNodes(self):
         '''Number of nodes that attempted contact with the server.'''
         if not self.nNodes:
@@ -29,6 +29,7 @@ else
 fi  
 
 runs=20
+workers=`nproc 2>/dev/null || echo 1`
 fail_probs='"0.1-0.2-0.3-0.4-0.5-0.6"'
 disasters[1755]='"Amsterdam,_Netherlands-London,_UnitedKingdom-Paris,_France"'
 disasters[3967]='"Herndon,_VA-Irvine,_CA-Santa_Clara,_CA"'
@@ -56,8 +57,10 @@ do
     command="$command%s "
     command="$command--fail_prob=$fail_probs "
     command="$command--file=rocketfuel/maps/$AS.cch "
+    command="$command--topology_cache=rocketfuel/maps/$AS.cch.cache "
     command="$command--disaster=${disasters[$AS]} "
     command="$command--runs=$runs "
+    command="$command--workers=$workers "
     command="$command--latencies=rocketfuel/weights/all_latencies.intra "
     command="$command--locations=rocketfuel/city_locations.txt "
     command="$command--contact_attempts=20 --timeout=0.5 --heuristic=$heuristics"
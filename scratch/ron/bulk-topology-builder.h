@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Builds a point-to-point topology described by flat arrays (an edge list with per-edge
+    delays and data rates, and per-node positions) in one pass: every device, channel,
+    /30 subnet and mobility model is created directly, without going through the per-link
+    helpers, their attribute strings and their temporary containers. **/
+
+#ifndef BULK_TOPOLOGY_BUILDER_H
+#define BULK_TOPOLOGY_BUILDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <vector>
+#include <utility>
+
+namespace ns3 {
+
+class BulkTopologyBuilder
+{
+public:
+  /** A link between the nodes at these indices of the NodeContainer given to Build. */
+  struct Edge
+  {
+    Edge () : from (0), to (0) {}
+    Edge (uint32_t from, uint32_t to) : from (from), to (to) {}
+    uint32_t from;
+    uint32_t to;
+  };
+
+  /** Wall clock time spent in each phase of the last Build, in milliseconds. */
+  struct PhaseTimes
+  {
+    int64_t links;
+    int64_t addresses;
+    int64_t mobility;
+  };
+
+  BulkTopologyBuilder ();
+
+  /** Delay and data rate of the links for which no per-edge value is given. */
+  void SetDefaultDelay (Time delay);
+  void SetDefaultDataRate (DataRate rate);
+  /** First /30 (or other) subnet given out; each link gets the next one, like
+      Ipv4AddressHelper::NewNetwork does. */
+  void SetAddressBase (Ipv4Address network, Ipv4Mask mask);
+
+  /** Connect the given nodes, which must already have an Ipv4 stack installed.
+      delays and rates are either empty, for the defaults, or have one entry per edge;
+      positions is either empty, for no mobility models, or has one entry per node.
+      Devices and interfaces are added in edge order, the 'from' end first. */
+  void Build (NodeContainer nodes, const std::vector<Edge> & edges,
+              const std::vector<Time> & delays, const std::vector<DataRate> & rates,
+              const std::vector<Vector> & positions);
+
+  uint32_t GetNEdges () const;
+  /** Device and Ipv4 interface of one end of an edge (side 0 is 'from', 1 is 'to'). */
+  Ptr<PointToPointNetDevice> GetDevice (uint32_t edge, uint32_t side) const;
+  std::pair<Ptr<Ipv4>, uint32_t> GetInterface (uint32_t edge, uint32_t side) const;
+  const PhaseTimes & GetPhaseTimes () const;
+
+private:
+  void InstallLinks (NodeContainer nodes, const std::vector<Edge> & edges,
+                     const std::vector<Time> & delays, const std::vector<DataRate> & rates);
+  void AssignAddresses (NodeContainer nodes, const std::vector<Edge> & edges);
+  void InstallMobility (NodeContainer nodes, const std::vector<Vector> & positions);
+
+  Time m_defaultDelay;
+  DataRate m_defaultRate;
+  Ipv4Address m_network;
+  Ipv4Mask m_mask;
+
+  ObjectFactory m_deviceFactory;
+  ObjectFactory m_channelFactory;
+  ObjectFactory m_queueFactory;
+
+  std::vector<Ptr<PointToPointNetDevice> > m_devices; //2 per edge
+  std::vector<Ptr<Ipv4> > m_ipv4s;                    //2 per edge
+  std::vector<uint32_t> m_interfaces;                 //2 per edge
+  PhaseTimes m_times;
+};
+
+} //namespace ns3
+
+#endif //BULK_TOPOLOGY_BUILDER_H
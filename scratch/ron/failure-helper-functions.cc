@@ -1,5 +1,8 @@
 #include "failure-helper-functions.h"
 
+#include "ns3/node-list.h"
+#include "ns3/point-to-point-net-device.h"
+
 #ifndef nslog
 #define nslog(x) NS_LOG_UNCOND(x);
 #endif
@@ -57,4 +60,23 @@ void UnfailNode (Ptr<Node> node, Time appStopTime)
     }
 }
 
+// A run that stops with packets in flight leaves them in the device queues, and the devices
+// sending them busy for good, as Simulator::Destroy cancels the end of their transmissions
+uint32_t ResetTransmitters ()
+{
+  uint32_t nreset = 0;
+
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      for (uint32_t dev = 0; dev < (*node)->GetNDevices (); dev++)
+        {
+          Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> ((*node)->GetDevice (dev));
+          if (device and device->ResetTransmitter ())
+            nreset++;
+        }
+    }
+
+  return nreset;
+}
+
 }//namespace
@@ -14,6 +14,9 @@ namespace ns3 {
   void FailNode (Ptr<Node> node);
   void UnfailNode (Ptr<Node> node, Time appStopTime);
   Ipv4Address GetNodeAddress (Ptr<Node> node);
+  /** Empty the queues of the point-to-point devices of every node and make their transmitters
+      ready, for a new run after Simulator::Destroy.  Returns the number of devices that were busy. */
+  uint32_t ResetTransmitters ();
 
 } //namespace ns3
 #endif //FAILURE_HELPER_FUNCTIONS_H
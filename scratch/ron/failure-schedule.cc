@@ -0,0 +1,399 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** A schedule of timed failures (and recoveries) of nodes, links and whole geographic
+    regions that is applied while the simulation runs, rather than all at once before it
+    starts.  Events that happen at the same time are applied together by one simulator
+    event, so schedules of tens of thousands of failures stay cheap to run. **/
+
+#include "failure-schedule.h"
+#include "failure-helper-functions.h"
+
+#include <boost/algorithm/string/replace.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("FailureSchedule");
+
+namespace ns3 {
+
+FailureSchedule::FailureSchedule (Ptr<TopologyCheckpoint> checkpoint)
+  : m_checkpoint (checkpoint),
+    m_positionGrid (Create<RonPeerTable> ()),
+    m_sorted (true),
+    m_napplied (0)
+{
+}
+
+
+bool
+FailureSchedule::Event::operator< (const Event & other) const
+{
+  return time < other.time;
+}
+
+
+void
+FailureSchedule::SetNodePosition (uint32_t nodeId, Vector position)
+{
+  if (nodeId >= m_positions.size ())
+    m_positions.resize (nodeId + 1, Vector (0.0, 0.0, 0.0));
+  m_positions[nodeId] = position;
+
+  if (position.z != 1.0)
+    {
+      m_positionGrid->RemovePeer (nodeId);
+      return;
+    }
+  RonPeerEntry entry;
+  entry.id = nodeId;
+  entry.location = position;
+  m_positionGrid->AddPeer (entry);
+}
+
+
+void
+FailureSchedule::AddNodeFailure (Time at, Ptr<Node> node)
+{
+  AddNodeEvents (at, IFACE_DOWN, node);
+}
+
+
+void
+FailureSchedule::AddNodeRecovery (Time at, Ptr<Node> node)
+{
+  AddNodeEvents (at, IFACE_UP, node);
+}
+
+
+void
+FailureSchedule::AddLinkFailure (Time at, Ptr<Node> node1, Ptr<Node> node2)
+{
+  AddLinkEvents (at, IFACE_DOWN, node1, node2);
+}
+
+
+void
+FailureSchedule::AddLinkRecovery (Time at, Ptr<Node> node1, Ptr<Node> node2)
+{
+  AddLinkEvents (at, IFACE_UP, node1, node2);
+}
+
+
+/** A failed node has all its interfaces down, as with FailNode.  Its applications keep
+    running if they already started, but they are cut off from the network. */
+void
+FailureSchedule::AddNodeEvents (Time at, EventType type, Ptr<Node> node)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, "Node " << node->GetId () << " has no Ipv4 stack!");
+
+  Event event;
+  event.time = at;
+  event.type = type;
+  event.node = node->GetId ();
+
+  for (event.iface = 0; event.iface < ipv4->GetNInterfaces (); event.iface++)
+    {
+      if (!m_events.empty () and event < m_events.back ())
+        m_sorted = false;
+      m_events.push_back (event);
+    }
+}
+
+
+void
+FailureSchedule::AddLinkEvents (Time at, EventType type, Ptr<Node> node1, Ptr<Node> node2)
+{
+  Ptr<Ipv4> ipv4 = node1->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, "Node " << node1->GetId () << " has no Ipv4 stack!");
+
+  Event event;
+  event.time = at;
+  event.type = type;
+
+  uint32_t nlinks = 0;
+  for (uint32_t dev = 0; dev < node1->GetNDevices (); dev++)
+    {
+      Ptr<NetDevice> device = node1->GetDevice (dev);
+      Ptr<Channel> channel = device->GetChannel ();
+      if (!channel)
+        continue;
+
+      for (uint32_t peer = 0; peer < channel->GetNDevices (); peer++)
+        {
+          Ptr<NetDevice> peerDevice = channel->GetDevice (peer);
+          if (peerDevice->GetNode () != node2)
+            continue;
+
+          int32_t iface = ipv4->GetInterfaceForDevice (device);
+          int32_t peerIface = node2->GetObject<Ipv4> ()->GetInterfaceForDevice (peerDevice);
+          if (iface < 0 or peerIface < 0)
+            continue;
+
+          if (!m_events.empty () and event < m_events.back ())
+            m_sorted = false;
+
+          event.node = node1->GetId ();
+          event.iface = iface;
+          m_events.push_back (event);
+          event.node = node2->GetId ();
+          event.iface = peerIface;
+          m_events.push_back (event);
+          nlinks++;
+        }
+    }
+
+  if (!nlinks)
+    NS_LOG_WARN ("No link between nodes " << node1->GetId () << " and " << node2->GetId ());
+}
+
+
+uint32_t
+FailureSchedule::AddRegionFailure (Time at, Vector center, double radius, double speed, Time duration)
+{
+  NS_LOG_FUNCTION (at << center << radius << speed << duration);
+
+  double maxRadius = radius + (speed > 0.0 ? speed * duration.GetSeconds () : 0.0);
+  uint32_t nfailed = 0;
+
+  std::vector<uint32_t> ids;
+  GetNodesWithin (center, maxRadius, ids);
+  for (std::vector<uint32_t>::const_iterator id = ids.begin ();
+       id != ids.end () and *id < NodeList::GetNNodes (); id++)
+    {
+      double distance = GetDistance (center, m_positions[*id]);
+
+      Time when = at;
+      if (distance > radius)
+        when += Seconds ((distance - radius) / speed);
+
+      AddNodeEvents (when, IFACE_DOWN, NodeList::GetNode (*id));
+      nfailed++;
+    }
+
+  NS_LOG_INFO (nfailed << " nodes fail in the region around " << center);
+  return nfailed;
+}
+
+
+void
+FailureSchedule::GetNodesWithin (Vector center, double radius, std::vector<uint32_t> & ids) const
+{
+  static const double earthRadius = 6371.0;
+  static const double toRadians = M_PI / 180.0;
+
+  // The grid is over degrees, so look in the smallest box of latitudes and longitudes holding the
+  // disk: the latitudes within its angle of the center, and the longitudes within the widest point
+  // of the disk.  Disks over a pole or across the antimeridian have no such box and are scanned.
+  double angle = radius / earthRadius;
+  double dlat = angle / toRadians;
+  double sinDlon = std::sin (angle) / std::cos (center.x * toRadians);
+  double dlon = sinDlon < 1.0 ? std::asin (sinDlon) / toRadians : 180.0;
+  std::vector<uint32_t> candidates;
+
+  if (angle < M_PI / 2 and std::fabs (center.x) + dlat < 90.0 and sinDlon < 1.0 and
+      center.y - dlon > -180.0 and center.y + dlon < 180.0)
+    {
+      std::vector<uint32_t> handles;
+      // slightly wider than the box, as the filtering below is exact
+      m_positionGrid->GetPeersWithin (center, std::sqrt (dlat * dlat + dlon * dlon) * (1 + 1e-9) + 1e-9, handles);
+      for (std::vector<uint32_t>::const_iterator handle = handles.begin (); handle != handles.end (); handle++)
+        candidates.push_back (m_positionGrid->GetPeerByHandle (*handle).id);
+      std::sort (candidates.begin (), candidates.end ());
+    }
+  else
+    {
+      for (uint32_t id = 0; id < m_positions.size (); id++)
+        {
+          // unknown positions
+          if (m_positions[id].z == 1.0)
+            candidates.push_back (id);
+        }
+    }
+
+  for (std::vector<uint32_t>::const_iterator id = candidates.begin (); id != candidates.end (); id++)
+    {
+      if (GetDistance (center, m_positions[*id]) <= radius)
+        ids.push_back (*id);
+    }
+}
+
+
+double
+FailureSchedule::GetDistance (Vector from, Vector to)
+{
+  static const double earthRadius = 6371.0;
+  static const double toRadians = M_PI / 180.0;
+
+  double dlat = (to.x - from.x) * toRadians;
+  double dlon = (to.y - from.y) * toRadians;
+  double a = std::sin (dlat / 2) * std::sin (dlat / 2) +
+    std::cos (from.x * toRadians) * std::cos (to.x * toRadians) * std::sin (dlon / 2) * std::sin (dlon / 2);
+
+  return 2 * earthRadius * std::atan2 (std::sqrt (a), std::sqrt (1 - a));
+}
+
+
+void
+FailureSchedule::ReadFile (std::string fileName, const std::map<std::string, Vector> & locations)
+{
+  std::ifstream infile (fileName.c_str ());
+  if (!infile)
+    NS_FATAL_ERROR ("Could not open failure schedule " << fileName);
+
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (infile, line))
+    {
+      lineNumber++;
+      line = line.substr (0, line.find ('#'));
+
+      std::istringstream fields (line);
+      double seconds;
+      std::string type;
+      if (!(fields >> seconds))
+        {
+          if (line.find_first_not_of (" \t\r") != std::string::npos)
+            NS_FATAL_ERROR (fileName << ":" << lineNumber << ": expected an event time");
+          continue;
+        }
+      fields >> type;
+      Time at = Seconds (seconds);
+
+      if (type == "node-down" or type == "node-up")
+        {
+          uint32_t id;
+          if (!(fields >> id) or id >= NodeList::GetNNodes ())
+            NS_FATAL_ERROR (fileName << ":" << lineNumber << ": bad node id");
+          AddNodeEvents (at, type == "node-down" ? IFACE_DOWN : IFACE_UP, NodeList::GetNode (id));
+        }
+      else if (type == "link-down" or type == "link-up")
+        {
+          uint32_t id1, id2;
+          if (!(fields >> id1 >> id2) or id1 >= NodeList::GetNNodes () or id2 >= NodeList::GetNNodes ())
+            NS_FATAL_ERROR (fileName << ":" << lineNumber << ": bad node ids");
+          AddLinkEvents (at, type == "link-down" ? IFACE_DOWN : IFACE_UP,
+                         NodeList::GetNode (id1), NodeList::GetNode (id2));
+        }
+      else if (type == "region-down")
+        {
+          std::string location;
+          double radius, speed = 0.0, duration = 0.0;
+          if (!(fields >> location >> radius))
+            NS_FATAL_ERROR (fileName << ":" << lineNumber << ": expected a location and radius");
+          fields >> speed >> duration;
+
+          location = boost::algorithm::replace_all_copy (location, "_", " ");
+          std::map<std::string, Vector>::const_iterator center = locations.find (location);
+          if (center == locations.end ())
+            NS_FATAL_ERROR (fileName << ":" << lineNumber << ": unknown location " << location);
+
+          AddRegionFailure (at, center->second, radius, speed, Seconds (duration));
+        }
+      else
+        NS_FATAL_ERROR (fileName << ":" << lineNumber << ": unknown event type " << type);
+    }
+
+  NS_LOG_INFO ("Read " << m_events.size () << " failure events from " << fileName);
+}
+
+
+void
+FailureSchedule::Install ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // Same-time events keep the order they were added in, so that e.g. a
+  // failure and a recovery at the same time don't swap
+  if (!m_sorted)
+    {
+      std::stable_sort (m_events.begin (), m_events.end ());
+      m_sorted = true;
+    }
+
+  m_napplied = 0;
+  m_failedIfaces.clear ();
+
+  uint32_t nbatches = 0;
+  for (uint32_t first = 0; first < m_events.size (); )
+    {
+      uint32_t last = first + 1;
+      while (last < m_events.size () and m_events[last].time == m_events[first].time)
+        last++;
+
+      Time delay = m_events[first].time - Simulator::Now ();
+      if (delay.IsStrictlyNegative ())
+        delay = Seconds (0.0);
+      Simulator::Schedule (delay, &FailureSchedule::ApplyEvents, Ptr<FailureSchedule> (this), first, last);
+
+      nbatches++;
+      first = last;
+    }
+
+  NS_LOG_INFO ("Scheduled " << m_events.size () << " failure events at " << nbatches << " distinct times");
+}
+
+
+/** Apply the events in [first, last), which all happen now.  Only interfaces whose state
+    actually changes are touched, as each change notifies the routing protocols. */
+void
+FailureSchedule::ApplyEvents (uint32_t first, uint32_t last)
+{
+  NS_LOG_FUNCTION (first << last);
+
+  for (uint32_t i = first; i < last; i++)
+    {
+      const Event & event = m_events[i];
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (event.node)->GetObject<Ipv4> ();
+
+      if (event.type == IFACE_DOWN and ipv4->IsUp (event.iface))
+        {
+          if (m_checkpoint)
+            m_checkpoint->FailIpv4 (ipv4, event.iface);
+          else
+            FailIpv4 (ipv4, event.iface);
+          m_failedIfaces.insert (std::make_pair (event.node, event.iface));
+        }
+      else if (event.type == IFACE_UP and !ipv4->IsUp (event.iface))
+        {
+          UnfailIpv4 (ipv4, event.iface);
+          m_failedIfaces.erase (std::make_pair (event.node, event.iface));
+        }
+    }
+
+  m_napplied += last - first;
+  NS_LOG_LOGIC ("Applied " << last - first << " failure events");
+}
+
+
+void
+FailureSchedule::Revert ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (std::set<std::pair<uint32_t, uint32_t> >::iterator iface = m_failedIfaces.begin ();
+       iface != m_failedIfaces.end (); iface++)
+    {
+      UnfailIpv4 (NodeList::GetNode (iface->first)->GetObject<Ipv4> (), iface->second);
+    }
+  m_failedIfaces.clear ();
+}
+
+
+uint32_t
+FailureSchedule::GetNEvents () const
+{
+  return m_events.size ();
+}
+
+
+uint32_t
+FailureSchedule::GetNApplied () const
+{
+  return m_napplied;
+}
+
+} //namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** A schedule of timed failures (and recoveries) of nodes, links and whole geographic
+    regions that is applied while the simulation runs, rather than all at once before it
+    starts.  Events that happen at the same time are applied together by one simulator
+    event, so schedules of tens of thousands of failures stay cheap to run. **/
+
+#ifndef FAILURE_SCHEDULE_H
+#define FAILURE_SCHEDULE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include "topology-checkpoint.h"
+#include "ron-peer-table.h"
+
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+
+namespace ns3 {
+
+class FailureSchedule : public SimpleRefCount<FailureSchedule>
+{
+public:
+  /** Failures are applied through the checkpoint, if given, so that restoring it undoes them. */
+  FailureSchedule (Ptr<TopologyCheckpoint> checkpoint = 0);
+
+  /** Set the (latitude, longitude) of a node, which is needed for it to be part of region failures. */
+  void SetNodePosition (uint32_t nodeId, Vector position);
+
+  void AddNodeFailure (Time at, Ptr<Node> node);
+  void AddNodeRecovery (Time at, Ptr<Node> node);
+  /** Fail (or recover) the interfaces at both ends of every link between the two nodes. */
+  void AddLinkFailure (Time at, Ptr<Node> node1, Ptr<Node> node2);
+  void AddLinkRecovery (Time at, Ptr<Node> node1, Ptr<Node> node2);
+
+  /** Fail every node within radius km of the center at the given time, then keep failing the
+      nodes the disaster reaches as it spreads at speed km/s for the given duration.
+      Returns the number of nodes that will fail. */
+  uint32_t AddRegionFailure (Time at, Vector center, double radius, double speed = 0.0, Time duration = Seconds (0.0));
+
+  /** Appends in increasing order the ids of the nodes with a known position within radius km of
+      the center, found through a grid over the positions rather than by checking every node. */
+  void GetNodesWithin (Vector center, double radius, std::vector<uint32_t> & ids) const;
+
+  /** Great-circle distance in km between two (latitude, longitude) positions in degrees. */
+  static double GetDistance (Vector from, Vector to);
+
+  /** Read events from a file with one event per line, where the time is in seconds and
+      location names use underscores for spaces ('#' starts a comment):
+        <time> node-down <node id>
+        <time> node-up <node id>
+        <time> link-down <node id> <node id>
+        <time> link-up <node id> <node id>
+        <time> region-down <location> <radius km> [<speed km/s> <duration s>]
+      Region centers are looked up in the given locations (name -> latitude, longitude). */
+  void ReadFile (std::string fileName, const std::map<std::string, Vector> & locations);
+
+  /** Schedule all the events in the current simulation.  Must be called again for every
+      run, as Simulator::Destroy () cancels them. */
+  void Install ();
+
+  /** Bring back up everything the schedule brought down.  Only needed without a checkpoint. */
+  void Revert ();
+
+  uint32_t GetNEvents () const;
+  /** Number of events applied in the current run. */
+  uint32_t GetNApplied () const;
+
+private:
+  enum EventType
+  {
+    IFACE_DOWN,
+    IFACE_UP
+  };
+
+  struct Event
+  {
+    Time time;
+    EventType type;
+    uint32_t node;
+    uint32_t iface;
+
+    bool operator< (const Event & other) const;
+  };
+
+  void AddNodeEvents (Time at, EventType type, Ptr<Node> node);
+  void AddLinkEvents (Time at, EventType type, Ptr<Node> node1, Ptr<Node> node2);
+  void ApplyEvents (uint32_t first, uint32_t last);
+
+  Ptr<TopologyCheckpoint> m_checkpoint;
+  std::vector<Vector> m_positions; //indexed by node id, z is 1 for known positions
+  Ptr<RonPeerTable> m_positionGrid; //the nodes with known positions, by (latitude, longitude)
+  std::vector<Event> m_events;
+  bool m_sorted;
+  uint32_t m_napplied;
+  std::set<std::pair<uint32_t, uint32_t> > m_failedIfaces; //(node id, iface) brought down, for Revert
+};
+
+} //namespace ns3
+#endif //FAILURE_SCHEDULE_H
@@ -7,6 +7,7 @@
 #include "geocron-experiment.h"
 #include "ron-trace-functions.h"
 #include "failure-helper-functions.h"
+#include "bulk-topology-builder.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
@@ -18,6 +19,12 @@
 #include <iomanip>
 #include <fstream>
 #include <ctime>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 using namespace ns3;
 
@@ -36,6 +43,15 @@ GeocronExperiment::GeocronExperiment ()
   contactAttempts = 10;
   traceFile = "";
   nruns = 1;
+  nworkers = 1;
+  seed = 0;
+  useCheckpoint = true;
+  checkpoint = Create<TopologyCheckpoint> ();
+  failureScheduleFile = "";
+  binaryTraces = false;
+  topologyCacheFile = "";
+  latencyFile = "";
+  streamIndexMark = 0;
 }
 
 
@@ -83,7 +99,7 @@ GeocronExperiment::IsDisasterNode (Ptr<Node> node)
 void
 GeocronExperiment::ReadLatencyFile (std::string latencyFile)
 {
-  // Load latency information if requested
+  // Load latency information if requested (ReadTopology reads it, from the topology cache if it can)
   if (latencyFile != "")
     {
       if (! boost::filesystem::exists(latencyFile))
@@ -91,7 +107,7 @@ GeocronExperiment::ReadLatencyFile (std::string latencyFile)
           NS_LOG_ERROR("File does not exist: " + latencyFile);
           exit(-1);
         }
-      latencies = RocketfuelTopologyReader::ReadLatencies (latencyFile);
+      this->latencyFile = latencyFile;
     }
 }
 
@@ -139,18 +155,33 @@ GeocronExperiment::ReadTopology (std::string topologyFile)
   
   RocketfuelTopologyReader topo_reader;
   topo_reader.SetFileName(topologyFile);
-  nodes = topo_reader.Read();
+  if (topologyCacheFile != "")
+    {
+      nodes = topo_reader.ReadCache (topologyCacheFile, &latencies, latencyFile);
+    }
+  if (nodes.GetN () == 0)
+    {
+      nodes = topo_reader.Read();
+      if (latencyFile != "")
+        latencies = RocketfuelTopologyReader::ReadLatencies (latencyFile);
+      if (topologyCacheFile != "")
+        {
+          topo_reader.WriteCache (topologyCacheFile, nodes, latencies, latencyFile);
+        }
+    }
   NS_LOG_INFO ("Nodes read from file: " + boost::lexical_cast<std::string> (nodes.GetN()));
 
   NS_LOG_INFO ("Assigning addresses and installing interfaces...");
 
-  PointToPointHelper pointToPoint;
-  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Gbps"));
-  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  SystemWallClockMs clock;
+  clock.Start ();
 
-  // NixHelper to install nix-vector routing
+  // NixHelper to install nix-vector routing.  Failed links stay in the
+  // paths, so nothing is ever evicted from the shared cache: routing
+  // around failures is left to the overlay.
   Ipv4NixVectorHelper nixRouting;
   nixRouting.SetAttribute("FollowDownEdges", BooleanValue (true));
+  nixRouting.SetAttribute("SharedCache", BooleanValue (true));
   Ipv4StaticRoutingHelper staticRouting;
   Ipv4ListRoutingHelper routingList;
   routingList.Add (staticRouting, 0);
@@ -159,67 +190,73 @@ GeocronExperiment::ReadTopology (std::string topologyFile)
   stack.SetRoutingHelper (routingList); // has effect on the next Install ()
   stack.Install (nodes);
 
-  //For each link in topology, add a connection between nodes and assign IP
-  //addresses to the new network they've created between themselves.
-  Ipv4AddressHelper address;
-  address.SetBase ("10.1.0.0", "255.255.255.252");
-  //NetDeviceContainer router_devices;
-  //Ipv4InterfaceContainer router_interfaces;
+  int64_t stackMs = clock.End ();
+  clock.Start ();
 
-  NS_LOG_INFO ("Generating links and checking failure model.");
+  // Flatten the links into the arrays the builder takes: node indices, delays and
+  // positions.  Remember where nodes are, as the locations may not have been read yet.
+  std::vector<uint32_t> nodeIndex (NodeList::GetNNodes ());
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    nodeIndex[nodes.Get (i)->GetId ()] = i;
+  nodeLocations.resize (NodeList::GetNNodes ());
+
+  uint32_t nLinks = topo_reader.LinksSize ();
+  std::vector<BulkTopologyBuilder::Edge> edges;
+  edges.reserve (nLinks);
+  std::vector<Time> delays;
+  if (latencies.size())
+    delays.reserve (nLinks);
+  std::vector<Vector> positions (nodes.GetN (), Vector (0.0, 0.0, 0.0));
 
   for (TopologyReader::ConstLinksIterator iter = topo_reader.LinksBegin();
        iter != topo_reader.LinksEnd(); iter++) {
     std::string fromLocation = iter->GetAttribute ("From Location");
     std::string toLocation = iter->GetAttribute ("To Location");
+    uint32_t fromId = iter->GetFromNode ()->GetId ();
+    uint32_t toId = iter->GetToNode ()->GetId ();
 
-    //NS_LOG_INFO ("Link from " << fromLocation << " to " << toLocation);
+    edges.push_back (BulkTopologyBuilder::Edge (nodeIndex[fromId], nodeIndex[toId]));
 
     // Set latency for this link if we loaded that information
     if (latencies.size())
       {
         std::map<std::string, std::string>::iterator latency = latencies.find (fromLocation + " -> " + toLocation);
-        //if (iter->GetAttributeFailSafe ("Latency", latency))
-        
-        if (latency != latencies.end())
-          {
-            pointToPoint.SetChannelAttribute ("Delay", StringValue (latency->second + "ms"));
-          }
-        else
-          {
-            latency = latencies.find (toLocation + " -> " + fromLocation);
-            if (latency != latencies.end())
-              pointToPoint.SetChannelAttribute ("Delay", StringValue (latency->second + "ms"));
-            else
-              pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
-          }
+        if (latency == latencies.end())
+          latency = latencies.find (toLocation + " -> " + fromLocation);
+        delays.push_back (latency != latencies.end() ? Time::FromDouble (std::atof (latency->second.c_str ()), Time::MS) : MilliSeconds (2));
       }
 
-    Ptr<Node> from_node = iter->GetFromNode();
-    Ptr<Node> to_node = iter->GetToNode();
-    NodeContainer both_nodes (from_node);
-    both_nodes.Add (to_node);
+    nodeLocations[fromId] = fromLocation;
+    nodeLocations[toId] = toLocation;
 
-    NetDeviceContainer new_devs = pointToPoint.Install (both_nodes);
-    NetDeviceContainer from_dev;
-    from_dev.Add(new_devs.Get(0));
-    NetDeviceContainer to_dev;
-    to_dev.Add(new_devs.Get(1));
-    //router_devices.Add(new_devs);
+    // Mobility model to set positions for geographically-correlated information
+    std::map<std::string, Vector>::iterator location = locations.find (fromLocation);
+    if (location != locations.end ())
+      positions[nodeIndex[fromId]] = location->second;
+    location = locations.find (toLocation);
+    if (location != locations.end ())
+      positions[nodeIndex[toId]] = location->second;
+  }
 
-    Ipv4InterfaceContainer new_interfaces = address.Assign (new_devs);
-    //router_interfaces.Add(new_interfaces);
-    address.NewNetwork();
+  int64_t flattenMs = clock.End ();
 
-    // Mobility model to set positions for geographically-correlated information
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAllocator = CreateObject<ListPositionAllocator> ();
-    Vector fromPosition = locations.count (fromLocation)  ? (locations.find (fromLocation))->second : Vector (0.0, 0.0, 0.0);
-    Vector toPosition = locations.count (toLocation) ? (locations.find (toLocation))->second : Vector (0.0, 0.0, 0.0);
-    positionAllocator->Add (fromPosition);
-    positionAllocator->Add (toPosition);
-    mobility.SetPositionAllocator (positionAllocator);
-    mobility.Install (both_nodes);
+  NS_LOG_INFO ("Generating links and checking failure model.");
+
+  BulkTopologyBuilder builder;
+  builder.SetDefaultDelay (MilliSeconds (2));
+  builder.SetDefaultDataRate (DataRate ("100Gbps"));
+  builder.SetAddressBase ("10.1.0.0", "255.255.255.252");
+  builder.Build (nodes, edges, delays, std::vector<DataRate> (), positions);
+
+  clock.Start ();
+
+  uint32_t link = 0;
+  for (TopologyReader::ConstLinksIterator iter = topo_reader.LinksBegin();
+       iter != topo_reader.LinksEnd(); iter++, link++) {
+    std::string fromLocation = iter->GetAttribute ("From Location");
+    std::string toLocation = iter->GetAttribute ("To Location");
+    Ptr<Node> from_node = iter->GetFromNode();
+    Ptr<Node> to_node = iter->GetToNode();
 
     // If the node is in a disaster region, add it to the corresponding list
     for (std::vector<std::string>::iterator disasterLocation = disasterLocations->begin ();
@@ -236,16 +273,21 @@ GeocronExperiment::ReadTopology (std::string topologyFile)
 
         // Failure model: if either endpoint is in the disaster location,
         // add it to the list of potential ifaces to kill
-        if (iter->GetAttribute ("From Location") == *disasterLocation ||
-            iter->GetAttribute ("To Location") == *disasterLocation)
-          //random.GetValue () <= currFprob)
+        if (fromLocation == *disasterLocation || toLocation == *disasterLocation)
           {
-            potentialIfacesToKill[*disasterLocation].Add(new_interfaces.Get (0));
-            potentialIfacesToKill[*disasterLocation].Add(new_interfaces.Get (1));
+            potentialIfacesToKill[*disasterLocation].Add(builder.GetInterface (link, 0));
+            potentialIfacesToKill[*disasterLocation].Add(builder.GetInterface (link, 1));
           }
       }
   }
 
+  int64_t disasterMs = clock.End ();
+  const BulkTopologyBuilder::PhaseTimes & times = builder.GetPhaseTimes ();
+  NS_LOG_UNCOND ("Topology of " << nodes.GetN () << " nodes and " << nLinks << " links built: "
+               << stackMs << " ms internet stack, " << flattenMs << " ms link arrays, "
+               << times.links << " ms devices and channels, " << times.addresses << " ms addresses, "
+               << times.mobility << " ms mobility, " << disasterMs << " ms disaster regions");
+
   NS_LOG_INFO ("Topology finished.  Choosing & installing clients.");
 
   NodeContainer overlayNodes;
@@ -371,40 +413,209 @@ GeocronExperiment::AutoSetTraceFile ()
       newTraceFile.replace_extension (".out(" + boost::lexical_cast<std::string> (copy++) + ")");
     }
 
-  boost::filesystem::create_directories (newTraceFile.parent_path ());
+  // Other sweep workers may be creating the same directories concurrently
+  boost::system::error_code ec;
+  boost::filesystem::create_directories (newTraceFile.parent_path (), ec);
 
   SetTraceFile (newTraceFile.string ());
 }
 
 
-/** Run through all the possible combinations of disaster locations, failure probabilities,
-    heuristics, and other parameters for the given number of runs. */
-void
-GeocronExperiment::RunAllScenarios ()
+/** Enumerate all the possible combinations of disaster locations, failure probabilities,
+    heuristics, and other parameters for the given number of runs, in the order the
+    serial sweep visits them. */
+std::vector<GeocronExperiment::Scenario>
+GeocronExperiment::GetScenarios ()
 {
+  std::vector<Scenario> scenarios;
+  Scenario scenario;
+
   for (std::vector<std::string>::iterator disasterLocation = disasterLocations->begin ();
        disasterLocation != disasterLocations->end (); disasterLocation++)
     {
-      SetDisasterLocation (*disasterLocation);
+      scenario.location = *disasterLocation;
       for (std::vector<double>::iterator fprob = failureProbabilities->begin ();
            fprob != failureProbabilities->end (); fprob++)
         {
-          SetFailureProbability (*fprob);
+          scenario.fprob = *fprob;
           for (std::vector<int>::iterator heuristic = heuristics->begin ();
                heuristic != heuristics->end (); heuristic++)
             {
-              currHeuristic = (RonPathHeuristic::Heuristic)*heuristic;
-              SeedManager::SetSeed(std::time (NULL));
-
-              for (currRun = 0; currRun < nruns; currRun++)
+              scenario.heuristic = *heuristic;
+              for (scenario.run = 0; scenario.run < nruns; scenario.run++)
                 {
-                  SeedManager::SetRun(currRun);
-                  AutoSetTraceFile ();
-                  Run ();
+                  scenarios.push_back (scenario);
                 }
             }
         }
     }
+
+  return scenarios;
+}
+
+
+/** Run through all the scenarios of the sweep, either serially in this process or spread
+    across nworkers forked processes that share the topology built by ReadTopology.
+    Either way, a given scenario produces the same results: each run starts from the same
+    seed, run number and random stream index no matter which runs came before it. */
+void
+GeocronExperiment::RunAllScenarios ()
+{
+  if (!seed)
+    seed = std::time (NULL);
+  streamIndexMark = SeedManager::GetNextStreamIndex ();
+
+  if (useCheckpoint)
+    checkpoint->Capture ();
+
+  if (failureScheduleFile != "")
+    LoadFailureSchedule ();
+
+  std::vector<Scenario> scenarios = GetScenarios ();
+
+  NS_LOG_INFO ("Running " << scenarios.size () << " scenarios with seed " << seed);
+
+  if (nworkers > 1 and scenarios.size () > 1)
+    {
+      RunScenariosInParallel (scenarios);
+      return;
+    }
+
+  for (std::vector<Scenario>::iterator scenario = scenarios.begin ();
+       scenario != scenarios.end (); scenario++)
+    {
+      RunScenario (*scenario);
+    }
+}
+
+
+/** Read the timed failures applied during every run.  Their node positions come from the
+    locations file, so region failures only affect nodes in known locations. */
+void
+GeocronExperiment::LoadFailureSchedule ()
+{
+  failureSchedule = Create<FailureSchedule> (useCheckpoint ? checkpoint : 0);
+
+  for (uint32_t id = 0; id < nodeLocations.size (); id++)
+    {
+      std::map<std::string,Vector>::iterator location = locations.find (nodeLocations[id]);
+      if (location != locations.end ())
+        failureSchedule->SetNodePosition (id, location->second);
+    }
+
+  failureSchedule->ReadFile (failureScheduleFile, locations);
+}
+
+
+/** Set up the parameters and random number streams for the given scenario and run it. */
+void
+GeocronExperiment::RunScenario (const Scenario & scenario)
+{
+  SetDisasterLocation (scenario.location);
+  SetFailureProbability (scenario.fprob);
+  currHeuristic = (RonPathHeuristic::Heuristic)scenario.heuristic;
+  currRun = scenario.run;
+
+  SeedManager::SetSeed (seed);
+  SeedManager::SetRun (currRun);
+  SeedManager::ResetNextStreamIndex (streamIndexMark);
+
+  AutoSetTraceFile ();
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Run ();
+  int64_t elapsed = clock.End ();
+
+  NS_LOG_UNCOND ("Finished " << currLocation << ", fprob=" << currFprob << ", heuristic=" << currHeuristic
+                 << ", run=" << currRun << " in " << elapsed << " ms (pid " << getpid () << ")");
+}
+
+
+/** Fork nworkers processes, each of which inherits the already built topology
+    (copy-on-write) and repeatedly pulls the index of the next scenario to run from a
+    shared pipe until none are left.  Each scenario writes to its own trace file. */
+void
+GeocronExperiment::RunScenariosInParallel (const std::vector<Scenario> & scenarios)
+{
+  int workQueue[2];
+  if (pipe (workQueue) != 0)
+    {
+      NS_FATAL_ERROR ("Could not create work queue: " << std::strerror (errno));
+    }
+
+  uint32_t nprocs = std::min<uint32_t> (nworkers, scenarios.size ());
+  std::vector<pid_t> workers;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  for (uint32_t i = 0; i < nprocs; i++)
+    {
+      // Don't let the children inherit (and later duplicate) pending output
+      std::cout.flush ();
+      std::clog.flush ();
+
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Could not fork sweep worker: " << std::strerror (errno));
+        }
+
+      if (pid == 0)
+        {
+          close (workQueue[1]);
+
+          // Every index is written atomically as one fixed-size record, so concurrent
+          // readers never see a partial one.
+          uint32_t job;
+          ssize_t nread;
+          while ((nread = read (workQueue[0], &job, sizeof (job))) != 0)
+            {
+              if (nread < 0 and errno == EINTR)
+                continue;
+              if (nread != sizeof (job))
+                _exit (1);
+              RunScenario (scenarios[job]);
+            }
+
+          close (workQueue[0]);
+          std::cout.flush ();
+          _exit (0);
+        }
+
+      workers.push_back (pid);
+    }
+
+  close (workQueue[0]);
+
+  for (uint32_t job = 0; job < scenarios.size (); job++)
+    {
+      if (write (workQueue[1], &job, sizeof (job)) != sizeof (job))
+        {
+          NS_FATAL_ERROR ("Could not queue scenario " << job << ": " << std::strerror (errno));
+        }
+    }
+
+  // Closing the write end lets idle workers see the end of the queue
+  close (workQueue[1]);
+
+  uint32_t failures = 0;
+  for (std::vector<pid_t>::iterator worker = workers.begin ();
+       worker != workers.end (); worker++)
+    {
+      int status = 0;
+      pid_t done;
+      while ((done = waitpid (*worker, &status, 0)) < 0 and errno == EINTR);
+      if (done < 0 or !WIFEXITED (status) or WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_ERROR ("Sweep worker " << *worker << " did not finish cleanly");
+          failures++;
+        }
+    }
+
+  NS_LOG_UNCOND ("Ran " << scenarios.size () << " scenarios on " << nprocs << " workers in "
+                 << clock.End () << " ms" << (failures ? " (some workers failed!)" : ""));
 }
 
 
@@ -417,7 +628,18 @@ GeocronExperiment::ConnectAppTraces ()
   (void) PacketSent;
   (void) AckReceived;
 
-  if (traceFile != "")
+  if (traceFile != "" and binaryTraces)
+    {
+      traceWriter = Create<RonTraceWriter> (traceFile);
+
+      for (ApplicationContainer::Iterator itr = clientApps.Begin ();
+           itr != clientApps.End (); itr++)
+        {
+          Ptr<RonClient> app = DynamicCast<RonClient> (*itr);
+          app->ConnectTraces (traceWriter);
+        }
+    }
+  else if (traceFile != "")
     {
       Ptr<OutputStreamWrapper> traceOutputStream;
       AsciiTraceHelper asciiTraceHelper;
@@ -440,6 +662,15 @@ GeocronExperiment::Run ()
   // Random variable for determining if links fail during the disaster
   UniformVariable random;
   
+  // Undo whatever the previous run changed before choosing anything for this one
+  if (useCheckpoint and checkpoint->IsCaptured ())
+    {
+      SystemWallClockMs clock;
+      clock.Start ();
+      uint32_t nrestored = checkpoint->Restore ();
+      NS_LOG_INFO ("Restored " << nrestored << " changed nodes from checkpoint in " << clock.End () << " ms");
+    }
+
   NS_LOG_INFO ("Choosing server and failed nodes.");
 
   NodeContainer failNodes;
@@ -472,11 +703,23 @@ GeocronExperiment::Run ()
   NS_LOG_INFO ("Server is at: " << serverAddress);
 
   //Application
-  RonServerHelper ronServer (9);
-
-  ApplicationContainer serverApps = ronServer.Install (serverNode);
-  serverApps.Start (Seconds (1.0));
-  serverApps.Stop (appStopTime);
+  // A node keeps the server installed by the first run that chose it, which is started again
+  // by later runs rather than installed a second time on the same port
+  Ptr<Application> serverApp;
+  std::map<uint32_t, Ptr<Application> >::iterator server = serverApps.find (serverNode->GetId ());
+  if (server == serverApps.end ())
+    {
+      RonServerHelper ronServer (9);
+      serverApp = ronServer.Install (serverNode).Get (0);
+      serverApps[serverNode->GetId ()] = serverApp;
+    }
+  else
+    {
+      serverApp = server->second;
+      Simulator::ScheduleWithContext (serverNode->GetId (), Seconds (0.0), &Application::Start, serverApp);
+    }
+  serverApp->SetStartTime (Seconds (1.0));
+  serverApp->SetStopTime (appStopTime);
   
   Ptr<RonPeerEntry> serverPeer = Create<RonPeerEntry> (serverNode);
 
@@ -492,6 +735,9 @@ GeocronExperiment::Run ()
   //////////      Update client apps with new params                  ////////////
   ////////////////////////////////////////////////////////////////////////////////
 
+  // Clients in the same region share their rankings of the peers for each destination
+  Ptr<RonRankingCache> peerRankings = Create<RonRankingCache> (overlayPeers);
+
   for (ApplicationContainer::Iterator app = clientApps.Begin ();
        app != clientApps.End (); app++)
     {
@@ -499,9 +745,8 @@ GeocronExperiment::Run ()
 
       //TODO: different heuristics
       Ptr<RonPathHeuristic> heuristic = RonPathHeuristic::CreateHeuristic (currHeuristic);
-      // Must set heuristic first so that source will be set and heuristic can make its heap
       ronClient->SetHeuristic (heuristic);
-      heuristic->SetPeerTable (overlayPeers);
+      heuristic->SetRankingCache (peerRankings);
       ronClient->SetRemotePeer (serverPeer);
 
       if (!IsDisasterNode ((*app)->GetNode ())) //report_disaster && 
@@ -527,16 +772,26 @@ GeocronExperiment::Run ()
   for (Ipv4InterfaceContainer::Iterator iface = potentialIfacesToKill[currLocation].Begin ();
        iface != potentialIfacesToKill[currLocation].End (); iface++)
     {
-      FailIpv4 (iface->first, iface->second);
+      if (useCheckpoint)
+        checkpoint->FailIpv4 (iface->first, iface->second);
+      else
+        FailIpv4 (iface->first, iface->second);
     }
 
   // Fail the nodes that were chosen
   for (NodeContainer::Iterator node = failNodes.Begin ();
        node != failNodes.End (); node++)
     {
-      FailNode (*node);
+      if (useCheckpoint)
+        checkpoint->FailNode (*node);
+      else
+        FailNode (*node);
     }
 
+  // Timed failures happen while the simulation runs
+  if (failureSchedule)
+    failureSchedule->Install ();
+
   // pointToPoint.EnablePcap("rocketfuel-example",router_devices.Get(0),true);
 
   NS_LOG_UNCOND ("Starting simulation on map file " << topologyFile << ": " << std::endl
@@ -544,26 +799,65 @@ GeocronExperiment::Run ()
                  << disasterNodes[currLocation].size () << " nodes in " << currLocation << " total" << std::endl
                  << std::endl << "Failure probability: " << currFprob << std::endl
                  << failNodes.GetN () << " nodes failed" << std::endl
-                 << potentialIfacesToKill[currLocation].GetN () / 2 << " links failed");
+                 << potentialIfacesToKill[currLocation].GetN () / 2 << " links failed" << std::endl
+                 << (failureSchedule ? failureSchedule->GetNEvents () : 0) << " timed failure events");
 
   Simulator::Stop (simulationLength);
+  uint64_t eventsAllocated = Simulator::GetEventsAllocated ();
+  uint64_t eventsRecycled = Simulator::GetEventsRecycled ();
   Simulator::Run ();
+  NS_LOG_INFO ((Simulator::GetEventsAllocated () - eventsAllocated) << " events allocated during the run, "
+               << (Simulator::GetEventsRecycled () - eventsRecycled) << " of them recycled, "
+               << Simulator::GetEventBytesLive () << " bytes of events still live");
+  Ptr<DefaultSimulatorImpl> simulatorImpl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  if (simulatorImpl)
+    {
+      uint64_t nexecuted = simulatorImpl->GetNExecutedEvents ();
+      uint64_t ndead = simulatorImpl->GetNDeadEvents ();
+      NS_LOG_INFO (ndead << " cancelled events left the event list, " << nexecuted << " events ran (dead-event ratio "
+                   << (nexecuted + ndead ? (double)ndead / (nexecuted + ndead) : 0.0) << "), at most "
+                   << simulatorImpl->GetMaxCancelledEvents () << " cancelled events held at once, "
+                   << simulatorImpl->GetNCompactions () << " compactions");
+    }
   Simulator::Destroy ();
 
-  NS_LOG_INFO ("Next simulation run...");
-
-  // Unfail the links that were chosen
-  for (Ipv4InterfaceContainer::Iterator iface = potentialIfacesToKill[currLocation].Begin ();
-       iface != potentialIfacesToKill[currLocation].End (); iface++)
+  // The records must be on disk before a sweep worker moves on, as it exits without cleaning up
+  if (traceWriter)
     {
-      UnfailIpv4 (iface->first, iface->second);
+      NS_LOG_INFO ("Wrote " << traceWriter->GetNRecords () << " trace records");
+      traceWriter->Close ();
+      traceWriter = NULL;
     }
 
-  // Unfail the nodes that were chosen
-  for (NodeContainer::Iterator node = failNodes.Begin ();
-       node != failNodes.End (); node++)
+  NS_LOG_INFO (peerRankings->GetNRankings () << " peer rankings were shared by " << clientApps.GetN () << " clients");
+  NS_LOG_INFO ("Next simulation run...");
+
+  // Without a checkpoint, the failures must be undone by hand (the checkpoint is
+  // instead restored at the start of the next run)
+  if (!useCheckpoint)
     {
-      UnfailNode (*node, appStopTime);
+      SystemWallClockMs clock;
+      clock.Start ();
+
+      // Unfail the links that were chosen
+      for (Ipv4InterfaceContainer::Iterator iface = potentialIfacesToKill[currLocation].Begin ();
+           iface != potentialIfacesToKill[currLocation].End (); iface++)
+        {
+          UnfailIpv4 (iface->first, iface->second);
+        }
+
+      // Unfail the nodes that were chosen
+      for (NodeContainer::Iterator node = failNodes.Begin ();
+           node != failNodes.End (); node++)
+        {
+          UnfailNode (*node, appStopTime);
+        }
+
+      if (failureSchedule)
+        failureSchedule->Revert ();
+
+      uint32_t nreset = ResetTransmitters ();
+      NS_LOG_INFO ("Unfailed topology and reset " << nreset << " busy transmitters in " << clock.End () << " ms");
     }
   
   //serverNode->GetObject<Ipv4NixVectorRouting> ()->FlushGlobalNixRoutingCache ();
@@ -575,6 +869,7 @@ GeocronExperiment::Run ()
       Ptr<RonClient> ronClient = DynamicCast<RonClient> (*app);
       ronClient->Reset ();
     }
+  serverApp->Reset ();
 }
     /* Was used in a (failed) attempt to mimic the actual addresses from the file to exploit topology information...
 
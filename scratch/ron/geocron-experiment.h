@@ -23,6 +23,9 @@
 #include "ron-helper.h"
 #include "ron-client.h"
 #include "ron-server.h"
+#include "topology-checkpoint.h"
+#include "failure-schedule.h"
+#include "ron-trace-file.h"
 
 #include <iostream>
 #include <sstream>
@@ -35,6 +38,15 @@ namespace ns3 {
 
 class GeocronExperiment {
 public:
+  /** One point of the parameter sweep, i.e. the inputs of a single simulation run. */
+  struct Scenario
+  {
+    std::string location;
+    double fprob;
+    int heuristic;
+    uint32_t run;
+  };
+
   GeocronExperiment ();
 
   void ReadTopology (std::string topologyFile);
@@ -65,26 +77,49 @@ public:
   uint32_t maxNDevs;
   uint32_t contactAttempts;
   uint32_t nruns;
+  // Number of worker processes RunAllScenarios forks; 0 or 1 runs everything in this process
+  uint32_t nworkers;
+  // Seed shared by every run of the sweep; 0 means pick one from the clock
+  uint32_t seed;
+  // Roll failures back by restoring a checkpoint of the topology rather than unfailing them
+  bool useCheckpoint;
+  // File of timed failures to apply during every run (see FailureSchedule::ReadFile)
+  std::string failureScheduleFile;
+  // Write traces as binary records (see ron-trace-file.h) instead of text lines
+  bool binaryTraces;
+  // Binary cache of the topology file (see TopologyReader::WriteCache); empty for none
+  std::string topologyCacheFile;
 
 private:
   bool IsDisasterNode (Ptr<Node> node);
   void AutoSetTraceFile ();
+  std::vector<Scenario> GetScenarios ();
+  void RunScenario (const Scenario & scenario);
+  void RunScenariosInParallel (const std::vector<Scenario> & scenarios);
+  void LoadFailureSchedule ();
 
   RonPathHeuristic::Heuristic currHeuristic;
   std::string currLocation;
   double currFprob;
   uint32_t currRun; //keep at 32 as it's used as a string later
+  uint64_t streamIndexMark; //first rng stream index used by every run
   Time timeout;
   Time simulationLength;
 
   NodeContainer nodes;
+  Ptr<TopologyCheckpoint> checkpoint;
+  Ptr<FailureSchedule> failureSchedule;
   ApplicationContainer clientApps;
+  std::map<uint32_t, Ptr<Application> > serverApps; //by node id, for the nodes chosen as server so far
   Ptr<RonPeerTable> overlayPeers;
+  std::string latencyFile;
   std::map<std::string,std::string> latencies;
   std::string topologyFile;
   std::map<std::string,Vector> locations;
+  std::vector<std::string> nodeLocations; //indexed by node id
 
   std::string traceFile;
+  Ptr<RonTraceWriter> traceWriter; //while a run writes binary traces
   Time appStopTime;
 
   // These maps hold nodes and ifaces of interest for the associated disaster region
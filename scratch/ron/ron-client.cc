@@ -563,6 +563,23 @@ RonClient::ConnectTraces (Ptr<OutputStreamWrapper> traceOutputStream)
   this->TraceConnectWithoutContext ("Forward", m_forwardcb);
   this->TraceConnectWithoutContext ("Send", m_sendcb);
 }
+
+
+void
+RonClient::ConnectTraces (Ptr<RonTraceWriter> traceWriter)
+{
+  this->TraceDisconnectWithoutContext ("Ack", m_ackcb);
+  this->TraceDisconnectWithoutContext ("Send", m_sendcb);
+  this->TraceDisconnectWithoutContext ("Forward", m_forwardcb);
+
+  m_ackcb = MakeBoundCallback (&AckReceivedBinary, traceWriter);
+  m_sendcb = MakeBoundCallback (&PacketSentBinary, traceWriter);
+  m_forwardcb = MakeBoundCallback (&PacketForwardedBinary, traceWriter);
+
+  this->TraceConnectWithoutContext ("Ack", m_ackcb);
+  this->TraceConnectWithoutContext ("Forward", m_forwardcb);
+  this->TraceConnectWithoutContext ("Send", m_sendcb);
+}
   
 
 } // Namespace ns3
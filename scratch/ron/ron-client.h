@@ -28,6 +28,7 @@
 #include "ron-header.h"
 #include "ron-peer-table.h"
 #include "ron-path-heuristic.h"
+#include "ron-trace-file.h"
 
 #include <list>
 #include <set>
@@ -146,6 +147,7 @@ public:
 
   Ipv4Address GetAddress () const;
   void ConnectTraces (Ptr<OutputStreamWrapper> traceOutputStream);
+  void ConnectTraces (Ptr<RonTraceWriter> traceWriter);
 
 protected:
   virtual void DoDispose (void);
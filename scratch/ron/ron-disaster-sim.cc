@@ -12,6 +12,8 @@
 #include "ron-client.h"
 #include "ron-server.h"
 #include "geocron-experiment.h"
+#include "ron-heuristic-benchmark.h"
+#include "ron-trace-file.h"
 
 #include <boost/tokenizer.hpp>
 //#include <boost/regex.hpp>
@@ -48,6 +50,10 @@ main (int argc, char *argv[])
   std::string disaster_location = "Los Angeles, CA";
   bool tracing = false;
   double timeout = 1.0;
+  uint32_t benchmarkPeers = 0;
+  uint32_t benchmarkNodes = 0;
+  std::string convertTrace = "";
+  double compactCancelled = 0.0;
 
   CommandLine cmd;
   cmd.AddValue ("file", "File to read network topology from", filename);
@@ -68,9 +74,42 @@ main (int argc, char *argv[])
   cmd.AddValue ("timeout", "Seconds to wait for server reply before attempting contact through the overlay.", timeout);
   cmd.AddValue ("contact_attempts", "Number of times a reporting node will attempt to contact the server "
                 "(it will use the overlay after the first attempt).  Default is 1 (no overlay).", exp.contactAttempts);
+  cmd.AddValue ("workers", "Number of processes to spread the runs across (they share the topology, which is only built once).", exp.nworkers);
+  cmd.AddValue ("checkpoint", "Roll back failures between runs by restoring a checkpoint of the topology "
+                "instead of unfailing each link and node.", exp.useCheckpoint);
+  cmd.AddValue ("failure_schedule", "File of timed node/link/region failures to apply during every run.", exp.failureScheduleFile);
+  cmd.AddValue ("seed", "Seed used for every run (0 picks one from the clock).  "
+                "Runs with the same seed and run number give the same results however many workers are used.", exp.seed);
+  cmd.AddValue ("topology_cache", "Binary cache of the topology: read instead of the topology file while that file is unchanged, "
+                "and written after parsing it otherwise.", exp.topologyCacheFile);
+  cmd.AddValue ("binary_traces", "Write compact binary traces instead of text (convert them with --convert_trace).", exp.binaryTraces);
+  cmd.AddValue ("convert_trace", "Instead of simulating, print this binary trace file as text.", convertTrace);
+  cmd.AddValue ("compact_cancelled", "Compact the event list once this fraction of its events are cancelled timers (0 never does).", compactCancelled);
+  cmd.AddValue ("benchmark_heuristic", "Instead of simulating, time the path heuristics on up to this many peers.", benchmarkPeers);
+  cmd.AddValue ("benchmark_regions", "Instead of simulating, time finding the nodes in disaster regions among up to this many nodes.", benchmarkNodes);
 
   cmd.Parse (argc,argv);
 
+  if (convertTrace != "")
+    {
+      ConvertTraceToText (convertTrace, std::cout);
+      return 0;
+    }
+
+  if (benchmarkPeers)
+    {
+      BenchmarkHeuristics (benchmarkPeers);
+      return 0;
+    }
+
+  if (benchmarkNodes)
+    {
+      BenchmarkRegionQueries (benchmarkNodes);
+      return 0;
+    }
+
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CompactCancelledFraction", DoubleValue (compactCancelled));
+
   // Parse string args for possible multiple arguments
   typedef boost::tokenizer<boost::char_separator<char> > 
     tokenizer;
@@ -113,6 +152,7 @@ main (int argc, char *argv[])
       LogComponentEnable ("RonTracers", LOG_LEVEL_INFO);
       LogComponentEnable ("RonClientApplication", LOG_LEVEL_INFO);
       LogComponentEnable ("GeocronExperiment", LOG_LEVEL_INFO);
+      LogComponentEnable ("FailureSchedule", LOG_LEVEL_INFO);
       LogComponentEnable ("RonServerApplication", LOG_LEVEL_INFO);
       LogComponentEnable ("RonHeader", LOG_LEVEL_INFO);
       LogComponentEnable ("RonDisasterSimulation", LOG_LEVEL_INFO);
@@ -154,8 +194,8 @@ main (int argc, char *argv[])
   exp.failureProbabilities = failureProbabilities;
   exp.SetTimeout (Seconds (timeout));
 
-  exp.ReadTopology (filename);
   exp.ReadLatencyFile (latencyFile);
+  exp.ReadTopology (filename);
   exp.ReadLocationFile (locationFile);
   //exp.SetTraceFile (traceFile);
   exp.RunAllScenarios ();
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Microbenchmarks of the overlay path heuristics and of finding the nodes in a disaster
+    region, run with the ron program's --benchmark_heuristic and --benchmark_regions options
+    instead of a simulation. **/
+
+#include "ron-heuristic-benchmark.h"
+#include "ron-path-heuristic.h"
+#include "failure-schedule.h"
+
+#include "ns3/system-wall-clock-ms.h"
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+namespace ns3 {
+
+/** The orthogonal heuristic as it was computed before peers were scored in batches: the whole
+    triangle for both peers on every comparison.  Returns true if peer1 is a worse choice than
+    peer2, so that the front of the heap is the best peer. */
+static bool
+LegacyOrthogonalWorse (Ptr<RonPeerEntry> source, Ptr<RonPeerEntry> destination, RonPeerEntry peer1, RonPeerEntry peer2)
+{
+  Vector va = source->location;
+  Vector vb = destination->location;
+  Vector vc1 = peer1.location;
+  Vector vc2 = peer2.location;
+
+  if ((vc1.x == va.x and vc1.y == va.y) or (vc1.x == vb.x and vc1.y == vb.y))
+    return true;
+  if ((vc2.x == va.x and vc2.y == va.y) or (vc2.x == vb.x and vc2.y == vb.y))
+    return false;
+
+  double orthogonal = M_PI / 2.0;
+
+  double ab_dist = CalculateDistance (va, vb);
+  double ac1_dist = CalculateDistance (va, vc1);
+  double ac2_dist = CalculateDistance (va, vc2);
+  double bc1_dist = CalculateDistance (vb, vc1);
+  double bc2_dist = CalculateDistance (vb, vc2);
+
+  double c1_ang = acos ((ac1_dist * ac1_dist + bc1_dist * bc1_dist - ab_dist * ab_dist) /
+                        (2 * ac1_dist * bc1_dist));
+  double c2_ang = acos ((ac2_dist * ac2_dist + bc2_dist * bc2_dist - ab_dist * ab_dist) /
+                        (2 * ac2_dist * bc2_dist));
+  double a1_ang = acos ((ac1_dist * ac1_dist + ab_dist * ab_dist - bc1_dist * bc1_dist) /
+                        (2 * ac1_dist * ab_dist));
+  double a2_ang = acos ((ac2_dist * ac2_dist + ab_dist * ab_dist - bc2_dist * bc2_dist) /
+                        (2 * ac2_dist * ab_dist));
+
+  double perpDist1 = ac1_dist * sin (a1_ang);
+  double perpDist2 = ac2_dist * sin (a2_ang);
+
+  double ac_ideal_dist = sqrt ((ab_dist * ab_dist) / 2);
+  double ideal_dist = sqrt (ac_ideal_dist * ac_ideal_dist - ab_dist * ab_dist / 4);
+
+  double ang1_err = std::fabs ((c1_ang - orthogonal) / orthogonal);
+  double ang2_err = std::fabs ((c2_ang - orthogonal) / orthogonal);
+  double dist1_err = std::fabs ((perpDist1 - ideal_dist) / ideal_dist);
+  double dist2_err = std::fabs ((perpDist2 - ideal_dist) / ideal_dist);
+
+  return (ang1_err * ang1_err + dist1_err * dist1_err) > (ang2_err * ang2_err + dist2_err * dist2_err);
+}
+
+
+void
+BenchmarkHeuristics (uint32_t maxPeers, uint32_t npicks)
+{
+  static const uint32_t ndestinations = 200;
+  UniformVariable latitude (25.0, 49.0);
+  UniformVariable longitude (-124.0, -67.0);
+
+  std::cout << "peers\tpicks\tdestinations\theap (ms)\tscored (ms)\tsame best peer" << std::endl;
+
+  for (uint32_t npeers = 1000; npeers <= maxPeers; npeers += (npeers < 5000 ? 1000 : 5000))
+    {
+      Ptr<RonPeerTable> table = Create<RonPeerTable> ();
+      for (uint32_t id = 0; id < npeers; id++)
+        {
+          RonPeerEntry entry;
+          entry.id = id;
+          entry.location = Vector (latitude.GetValue (), longitude.GetValue (), 0.0);
+          table->AddPeer (entry);
+        }
+
+      Ptr<RonPeerEntry> source = Create<RonPeerEntry> ();
+      source->id = npeers;
+      source->location = Vector (latitude.GetValue (), longitude.GetValue (), 0.0);
+
+      std::vector<Ptr<RonPeerEntry> > destinations;
+      for (uint32_t i = 0; i < ndestinations; i++)
+        {
+          destinations.push_back (Create<RonPeerEntry> ());
+          destinations.back ()->id = npeers + 1 + i;
+          destinations.back ()->location = Vector (latitude.GetValue (), longitude.GetValue (), 0.0);
+        }
+
+      std::vector<int> heapBest, scoredBest;
+      SystemWallClockMs clock;
+
+      clock.Start ();
+      for (uint32_t i = 0; i < ndestinations; i++)
+        {
+          std::vector<RonPeerEntry> heap;
+          for (RonPeerTable::Iterator itr = table->Begin (); itr != table->End (); itr++)
+            heap.push_back (*itr);
+          boost::function<bool (RonPeerEntry, RonPeerEntry)> comparator =
+            boost::bind (&LegacyOrthogonalWorse, source, destinations[i], _1, _2);
+          std::make_heap (heap.begin (), heap.end (), comparator);
+
+          heapBest.push_back (heap.front ().id);
+          for (uint32_t pick = 0; pick < npicks and !heap.empty (); pick++)
+            {
+              std::pop_heap (heap.begin (), heap.end (), comparator);
+              heap.pop_back ();
+            }
+        }
+      int64_t heapMs = clock.End ();
+
+      clock.Start ();
+      for (uint32_t i = 0; i < ndestinations; i++)
+        {
+          Ptr<RonPathHeuristic> heuristic = RonPathHeuristic::CreateHeuristic (RonPathHeuristic::ORTHOGONAL);
+          heuristic->SetSourcePeer (source);
+          heuristic->SetPeerTable (table);
+
+          scoredBest.push_back (heuristic->GetNextPeer (destinations[i]).id);
+          for (uint32_t pick = 1; pick < npicks and pick < npeers; pick++)
+            heuristic->GetNextPeer (destinations[i]);
+        }
+      int64_t scoredMs = clock.End ();
+
+      uint32_t nsame = 0;
+      for (uint32_t i = 0; i < ndestinations; i++)
+        nsame += heapBest[i] == scoredBest[i];
+
+      std::cout << npeers << "\t" << npicks << "\t" << ndestinations << "\t"
+                << heapMs << "\t" << scoredMs << "\t" << nsame << "/" << ndestinations << std::endl;
+    }
+}
+
+
+/** A (latitude, longitude) mostly in the US, and otherwise anywhere, so that regions over the
+    poles and across the antimeridian come up too. */
+static Vector
+RandomPosition (UniformVariable & random)
+{
+  if (random.GetValue () < 0.9)
+    return Vector (random.GetValue (25.0, 49.0), random.GetValue (-124.0, -67.0), 1.0);
+  return Vector (random.GetValue (-90.0, 90.0), random.GetValue (-180.0, 180.0), 1.0);
+}
+
+
+void
+BenchmarkRegionQueries (uint32_t maxNodes)
+{
+  static const uint32_t nregions = 1000;
+  UniformVariable random;
+
+  std::cout << "nodes\tregions\tscan (ms)\tgrid (ms)\tsame nodes" << std::endl;
+
+  for (uint32_t nnodes = 1000; nnodes <= maxNodes; nnodes += (nnodes < 5000 ? 1000 : 5000))
+    {
+      FailureSchedule schedule;
+      std::vector<Vector> positions;
+      for (uint32_t id = 0; id < nnodes; id++)
+        {
+          positions.push_back (RandomPosition (random));
+          schedule.SetNodePosition (id, positions.back ());
+        }
+
+      std::vector<Vector> centers;
+      std::vector<double> radii;
+      for (uint32_t i = 0; i < nregions; i++)
+        {
+          centers.push_back (RandomPosition (random));
+          radii.push_back (random.GetValue (10.0, 1500.0));
+        }
+
+      std::vector<std::vector<uint32_t> > scanned (nregions), found (nregions);
+      SystemWallClockMs clock;
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nregions; i++)
+        {
+          for (uint32_t id = 0; id < nnodes; id++)
+            {
+              if (FailureSchedule::GetDistance (centers[i], positions[id]) <= radii[i])
+                scanned[i].push_back (id);
+            }
+        }
+      int64_t scanMs = clock.End ();
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nregions; i++)
+        schedule.GetNodesWithin (centers[i], radii[i], found[i]);
+      int64_t gridMs = clock.End ();
+
+      uint32_t nsame = 0;
+      for (uint32_t i = 0; i < nregions; i++)
+        nsame += scanned[i] == found[i];
+
+      std::cout << nnodes << "\t" << nregions << "\t"
+                << scanMs << "\t" << gridMs << "\t" << nsame << "/" << nregions << std::endl;
+    }
+}
+
+} //namespace
@@ -0,0 +1,26 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Microbenchmarks of the overlay path heuristics and of finding the nodes in a disaster
+    region, run with the ron program's --benchmark_heuristic and --benchmark_regions options
+    instead of a simulation. **/
+
+#ifndef RON_HEURISTIC_BENCHMARK_H
+#define RON_HEURISTIC_BENCHMARK_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/** Times picking the best npicks peers with OrthogonalRonPathHeuristic against the heap of
+    pairwise peer comparisons it used before, for tables of 1000 up to maxPeers peers at random
+    locations, and prints the results. */
+void BenchmarkHeuristics (uint32_t maxPeers, uint32_t npicks = 10);
+
+/** Times finding the nodes within disaster regions of random centers and radii with
+    FailureSchedule::GetNodesWithin against checking the distance to every node, for 1000 up to
+    maxNodes nodes mostly in the US and a few anywhere, and prints the results along with how
+    many regions both found the same nodes in. */
+void BenchmarkRegionQueries (uint32_t maxNodes);
+
+} //namespace
+#endif //RON_HEURISTIC_BENCHMARK_H
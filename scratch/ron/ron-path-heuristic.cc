@@ -17,7 +17,8 @@
  */
 
 #include "ron-path-heuristic.h"
-#include "boost/bind.hpp"
+#include <algorithm>
+#include <limits>
 #include <cmath>
 
 using namespace ns3;
@@ -27,71 +28,94 @@ using namespace ns3;
 ////////////////////////////////////////////////////////////////////////////////
 
 
-bool 
-RandomRonPathHeuristic::ComparePeers (Ptr<RonPeerEntry> destination, RonPeerEntry peer1, RonPeerEntry peer2)
+void
+RandomRonPathHeuristic::ScorePeers (Ptr<RonPeerEntry> destination, const RonPeerTable & table,
+                                    std::vector<double> & scores)
 {
-  return random.GetValue () < 0.5;
-  //return rand () % 2;
+  for (uint32_t i = 0; i < scores.size (); i++)
+    scores[i] = random.GetValue ();
 }
 
 
 bool
-OrthogonalRonPathHeuristic::ComparePeers (Ptr<RonPeerEntry> destination, RonPeerEntry peer1, RonPeerEntry peer2)
+RandomRonPathHeuristic::CanShareRankings () const
 {
-  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+  return false;
+}
 
-  // don't bother solving if either choice is within the source or destination's region
-  if (SameRegion (*m_source, peer1) or SameRegion (*destination, peer1))
-    return false;
-  if (SameRegion (*m_source, peer2) or SameRegion (*destination, peer2))
-    return true;
 
-  double pi = 3.14159265;
-  double orthogonal = pi/2.0;
+void
+OrthogonalRonPathHeuristic::ScorePeers (Ptr<RonPeerEntry> destination, const RonPeerTable & table,
+                                        std::vector<double> & scores)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+
+  const double orthogonal = M_PI / 2.0;
+  const uint32_t npeers = scores.size ();
 
   /*  We have a triangle where the source is point a, destination is point b, and overlay peer is c.
       We compute angle c and want it to be as close to right as possible (hence orthogonal).
       We also want the distance of the line from c to a point on line ab such that the lines are perpendicular. */
-  Vector3D va = m_source->location;
-  Vector3D vb = destination->location;
-  Vector3D vc1 = peer1.location;
-  Vector3D vc2 = peer2.location;
-
-  double ab_dist = CalculateDistance (va, vb);
-  double ac1_dist = CalculateDistance (va, vc1);
-  double ac2_dist = CalculateDistance (va, vc2);
-  double bc1_dist = CalculateDistance (vb, vc1);
-  double bc2_dist = CalculateDistance (vb, vc2);
-
-  // compute angles with law of cosines
-  double c1_ang = acos ((ac1_dist * ac1_dist + bc1_dist * bc1_dist - ab_dist * ab_dist) /
-                        (2 * ac1_dist * bc1_dist));
-  double c2_ang = acos ((ac2_dist * ac2_dist + bc2_dist * bc2_dist - ab_dist * ab_dist) /
-                        (2 * ac2_dist * bc2_dist));
-
-  // compute bc angles for finding the perpendicular distance
-  double a1_ang = acos ((ac1_dist * ac1_dist + ab_dist * ab_dist - bc1_dist * bc1_dist) /
-                        (2 * ac1_dist * ab_dist));
-  double a2_ang = acos ((ac2_dist * ac2_dist + ab_dist * ab_dist - bc2_dist * bc2_dist) /
-                        (2 * ac2_dist * ab_dist));
-
-  // find perpendicular distances using law of sines
-  double perpDist1 = ac1_dist * sin (a1_ang);
-  double perpDist2 = ac2_dist * sin (a2_ang);
+  const Vector va = m_source->location;
+  const Vector vb = destination->location;
+  const double ab_dist = CalculateDistance (va, vb);
+  const double ab_dist2 = ab_dist * ab_dist;
 
   // ideal distance is when c is located halfway between a and b,
-  // which would make an isosceles triangle, so legs are easy to compute
-  double ac_ideal_dist = sqrt ((ab_dist * ab_dist) / 2);
-  double ideal_dist = sqrt (ac_ideal_dist * ac_ideal_dist - ab_dist * ab_dist / 4);
-  
-  // find 'percent error' from ideals
-  double ang1_err = abs ((c1_ang - orthogonal) / orthogonal);
-  double ang2_err = abs ((c2_ang - orthogonal) / orthogonal);
-  double dist1_err = abs ((perpDist1 - ideal_dist) / ideal_dist);
-  double dist2_err = abs ((perpDist2 - ideal_dist) / ideal_dist);
+  // which would make an isosceles right triangle with height ab/2
+  const double ideal_dist = ab_dist / 2;
+
+  if (!npeers)
+    return;
+  const RonPeerLocations & locations = table.GetLocations ();
+  const double *x = &locations.x[0];
+  const double *y = &locations.y[0];
+  const double *z = &locations.z[0];
+  double *score = &scores[0];
+  m_distErr.resize (npeers);
+  double *distErr = &m_distErr[0];
+
+  // Plain arithmetic on the coordinate columns, which the compiler can vectorize: leaves the
+  // cosine of angle c in score and the squared perpendicular distance error in distErr.
+  // The cosines are clamped as rounding can push them just out of [-1, 1].
+  for (uint32_t i = 0; i < npeers; i++)
+    {
+      double ac_dist2 = (x[i] - va.x) * (x[i] - va.x) + (y[i] - va.y) * (y[i] - va.y) + (z[i] - va.z) * (z[i] - va.z);
+      double bc_dist2 = (x[i] - vb.x) * (x[i] - vb.x) + (y[i] - vb.y) * (y[i] - vb.y) + (z[i] - vb.z) * (z[i] - vb.z);
+      double ac_dist = std::sqrt (ac_dist2);
+      double bc_dist = std::sqrt (bc_dist2);
+
+      // law of cosines for angle c, and for angle a to find the perpendicular distance ac * sin (a)
+      double c_cos = std::max (-1.0, std::min (1.0, (ac_dist2 + bc_dist2 - ab_dist2) / (2 * ac_dist * bc_dist)));
+      double a_cos = std::max (-1.0, std::min (1.0, (ac_dist2 + ab_dist2 - bc_dist2) / (2 * ac_dist * ab_dist)));
+      double perpDist = ac_dist * std::sqrt (1.0 - a_cos * a_cos);
+
+      // find 'percent error' from the ideal distance
+      double err = (perpDist - ideal_dist) / ideal_dist;
+      score[i] = c_cos;
+      distErr[i] = err * err;
+    }
+
+  // we want to minimize the sum of the squared errors to further penalize deviations from the ideal
+  for (uint32_t i = 0; i < npeers; i++)
+    {
+      double err = (std::acos (score[i]) - orthogonal) / orthogonal;
+      score[i] = err * err + distErr[i];
+    }
+
+  // degenerate triangles, such as peers in the source or destination's region, are not numbers
+  for (uint32_t i = 0; i < npeers; i++)
+    {
+      if (ab_dist == 0.0 or score[i] != score[i])
+        score[i] = NO_SCORE;
+    }
 
-  // we want to minimize the square of these two values to further penalize deviations from the ideal
-  return (ang1_err * ang1_err + dist1_err * dist1_err) < (ang2_err * ang2_err + dist2_err * dist2_err);
+  // don't bother with peers within the source or destination's region
+  m_region.clear ();
+  table.GetPeersAt (va, m_region);
+  table.GetPeersAt (vb, m_region);
+  for (std::vector<uint32_t>::iterator peer = m_region.begin (); peer != m_region.end (); peer++)
+    score[*peer] = NO_SCORE;
 }
 
 
@@ -114,18 +138,54 @@ RonPathHeuristic::CreateHeuristic (Heuristic heuristic)
 }
 
 
+const double RonPathHeuristic::NO_SCORE = std::numeric_limits<double>::infinity ();
+
+
+RonPathHeuristic::~RonPathHeuristic ()
+{
+}
+
+
 RonPeerEntry
 RonPathHeuristic::GetNextPeer (Ptr<RonPeerEntry> destination)
 {
   NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+  NS_ASSERT_MSG (m_rankings, "You must set the peer table before using the heuristic!");
+
+  // a ranking made before peers were added to the table is made again, starting over from its best peer
+  std::map<int, Cursor>::iterator cursor = m_cursors.find (destination->id);
+  if (cursor != m_cursors.end () and cursor->second.version != peers->GetVersion ())
+    {
+      m_cursors.erase (cursor);
+      cursor = m_cursors.end ();
+    }
+  if (cursor == m_cursors.end ())
+    {
+      Ptr<RonPeerRanking> ranking = m_rankings->GetRanking (m_source->location, destination->id);
+      if (!ranking)
+        {
+          std::vector<double> scores (peers->GetNHandles ());
+          ScorePeers (destination, *peers, scores);
+          ranking = Create<RonPeerRanking> (scores);
+          m_rankings->AddRanking (m_source->location, destination->id, ranking);
+        }
+
+      cursor = m_cursors.insert (std::make_pair (destination->id, Cursor ())).first;
+      cursor->second.ranking = ranking;
+      cursor->second.version = peers->GetVersion ();
+      cursor->second.next = 0;
+    }
 
-  if (peerHeap.size () <= 0)
-    throw NoValidPeerException();
+  // peers already handed out for another destination, or removed from the table, are skipped
+  Cursor & c = cursor->second;
+  while (c.next < c.ranking->GetN ())
+    {
+      uint32_t peer = c.ranking->GetPeer (c.next++);
+      if (peers->IsValidHandle (peer) and m_used.insert (peers->GetPeerByHandle (peer).id).second)
+        return peers->GetPeerByHandle (peer);
+    }
 
-  RonPeerEntry ret = peerHeap.front ();
-  std::pop_heap (peerHeap.begin (), peerHeap.end (), GetPeerComparator (destination));
-  peerHeap.pop_back ();
-  return ret;
+  throw NoValidPeerException();
 }
 
 
@@ -140,13 +200,32 @@ void
 RonPathHeuristic::SetPeerTable (Ptr<RonPeerTable> table)
 {
   peers = table;
+  m_rankings = Create<RonRankingCache> (table);
+  m_cursors.clear ();
+  m_used.clear ();
+}
+
 
-  for (RonPeerTable::Iterator itr = peers->Begin (); itr != peers->End (); itr++)
+void
+RonPathHeuristic::SetRankingCache (Ptr<RonRankingCache> cache)
+{
+  if (!CanShareRankings ())
     {
-      peerHeap.push_back (*itr);
+      SetPeerTable (cache->GetPeerTable ());
+      return;
     }
 
-  std::make_heap (peerHeap.begin (), peerHeap.end (), GetPeerComparator ());
+  peers = cache->GetPeerTable ();
+  m_rankings = cache;
+  m_cursors.clear ();
+  m_used.clear ();
+}
+
+
+bool
+RonPathHeuristic::CanShareRankings () const
+{
+  return true;
 }
 
 
@@ -164,18 +243,125 @@ RonPathHeuristic::GetSourcePeer ()
 }
 
 
-boost::function<bool (RonPeerEntry peer1, RonPeerEntry peer2)>
-//void *
-RonPathHeuristic::GetPeerComparator (Ptr<RonPeerEntry> destination /* = NULL*/)
+RonPeerRanking::RonPeerRanking (std::vector<double> & scores)
+  : m_nsorted (0)
+{
+  m_scores.swap (scores);
+  m_order.resize (m_scores.size ());
+  for (uint32_t peer = 0; peer < m_order.size (); peer++)
+    m_order[peer] = peer;
+}
+
+
+uint32_t
+RonPeerRanking::GetN () const
+{
+  return m_order.size ();
+}
+
+
+uint32_t
+RonPeerRanking::GetPeer (uint32_t rank)
+{
+  NS_ASSERT (rank < m_order.size ());
+  while (rank >= m_nsorted)
+    SortNextPeers ();
+  return m_order[rank];
+}
+
+
+/** Sorts the next batch of the ranking, doubling the batch size each time, so
+    that only the few best peers usually tried get sorted. */
+void
+RonPeerRanking::SortNextPeers ()
+{
+  static const uint32_t minBatch = 8;
+
+  uint32_t end = std::min<uint32_t> (m_order.size (), m_nsorted + std::max (minBatch, m_nsorted));
+  std::partial_sort (m_order.begin () + m_nsorted, m_order.begin () + end, m_order.end (),
+                     ScoreLess (m_scores));
+  m_nsorted = end;
+}
+
+
+RonPeerRanking::ScoreLess::ScoreLess (const std::vector<double> & scores)
+  : m_scores (scores)
+{
+}
+
+
+bool
+RonPeerRanking::ScoreLess::operator() (uint32_t peer1, uint32_t peer2) const
+{
+  if (m_scores[peer1] != m_scores[peer2])
+    return m_scores[peer1] < m_scores[peer2];
+  return peer1 < peer2;
+}
+
+
+RonRankingCache::RonRankingCache (Ptr<RonPeerTable> table)
+  : m_table (table),
+    m_version (table->GetVersion ())
+{
+}
+
+
+Ptr<RonPeerTable>
+RonRankingCache::GetPeerTable () const
+{
+  return m_table;
+}
+
+
+Ptr<RonPeerRanking>
+RonRankingCache::GetRanking (Vector source, int destination) const
+{
+  if (m_version != m_table->GetVersion ())
+    return NULL;
+
+  std::map<RankingKey, Ptr<RonPeerRanking> >::const_iterator ranking = m_rankings.find (RankingKey (source, destination));
+  if (ranking == m_rankings.end ())
+    return NULL;
+  return ranking->second;
+}
+
+
+void
+RonRankingCache::AddRanking (Vector source, int destination, Ptr<RonPeerRanking> ranking)
+{
+  if (m_version != m_table->GetVersion ())
+    {
+      m_rankings.clear ();
+      m_version = m_table->GetVersion ();
+    }
+  m_rankings[RankingKey (source, destination)] = ranking;
+}
+
+
+uint32_t
+RonRankingCache::GetNRankings () const
+{
+  return m_rankings.size ();
+}
+
+
+RonRankingCache::RankingKey::RankingKey (Vector source, int destination)
+  : x (source.x),
+    y (source.y),
+    z (source.z),
+    destination (destination)
 {
-  return boost::bind (&RonPathHeuristic::ComparePeers, this, destination, _1, _2);
 }
 
 
 bool
-RonPathHeuristic::SameRegion (RonPeerEntry peer1, RonPeerEntry peer2)
+RonRankingCache::RankingKey::operator< (const RankingKey & other) const
 {
-  Vector3D loc1 = peer1.location;
-  Vector3D loc2 = peer2.location;
-  return loc1.x == loc2.x and loc1.y == loc2.y;
+  if (destination != other.destination)
+    return destination < other.destination;
+  if (x != other.x)
+    return x < other.x;
+  if (y != other.y)
+    return y < other.y;
+  return z < other.z;
 }
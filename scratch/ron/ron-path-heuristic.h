@@ -20,15 +20,78 @@
 #define RON_PATH_HEURISTIC_H
 
 #include "ron-peer-table.h"
-#include "boost/function.hpp"
 #include <vector>
+#include <map>
+#include <set>
 
 namespace ns3 {
 
 //TODO: enum for choosing which heuristic?
 
-/** This class represents a heuristic for choosing overlay paths.  Derived classes must override the ComparePeers
-    function to implement the actual heuristic logic. */
+/** The peers of a table ranked best first, as intermediaries from one source region to one destination.
+    The ranking is sorted lazily, in batches that double in size, as far down as it has been read. */
+class RonPeerRanking : public SimpleRefCount<RonPeerRanking>
+{
+public:
+  /** Takes over the scores (lower is better) of the peers, leaving scores empty. */
+  RonPeerRanking (std::vector<double> & scores);
+
+  uint32_t GetN () const;
+  /** Returns the handle of the peer at the given rank. */
+  uint32_t GetPeer (uint32_t rank);
+
+private:
+  /** Orders peer indices by score, ties going to the first peer in the table. */
+  class ScoreLess
+  {
+  public:
+    ScoreLess (const std::vector<double> & scores);
+    bool operator() (uint32_t peer1, uint32_t peer2) const;
+  private:
+    const std::vector<double> & m_scores;
+  };
+
+  void SortNextPeers ();
+
+  std::vector<double> m_scores;
+  std::vector<uint32_t> m_order;
+  uint32_t m_nsorted; //m_order is sorted by score up to here
+};
+
+/** The rankings of the peers of a table made so far, by source region and destination.  Heuristics whose
+    scores only depend on those share one cache between all the clients, so a ranking is made and stored
+    once per region instead of once per client.  The rankings are dropped once peers are added to the table,
+    since a reused handle would otherwise be ranked with the score of the peer it used to belong to. */
+class RonRankingCache : public SimpleRefCount<RonRankingCache>
+{
+public:
+  RonRankingCache (Ptr<RonPeerTable> table);
+
+  Ptr<RonPeerTable> GetPeerTable () const;
+
+  /** Returns the ranking for sources at the given location, or NULL if it hasn't been made for the current peers yet. */
+  Ptr<RonPeerRanking> GetRanking (Vector source, int destination) const;
+  void AddRanking (Vector source, int destination, Ptr<RonPeerRanking> ranking);
+  uint32_t GetNRankings () const;
+
+private:
+  struct RankingKey
+  {
+    RankingKey (Vector source, int destination);
+    bool operator< (const RankingKey & other) const;
+
+    double x, y, z;
+    int destination;
+  };
+
+  Ptr<RonPeerTable> m_table;
+  uint32_t m_version; //of the table when the rankings were made
+  std::map<RankingKey, Ptr<RonPeerRanking> > m_rankings;
+};
+
+/** This class represents a heuristic for choosing overlay paths.  Derived classes must override the ScorePeers
+    function to implement the actual heuristic logic.  All the peers are scored at once when a destination is
+    first asked for, and then handed out best first through a cursor into the ranking of that destination. */
 class RonPathHeuristic : public SimpleRefCount<RonPathHeuristic>
 {
 public:
@@ -39,10 +102,16 @@ public:
     };
 
   static Ptr<RonPathHeuristic> CreateHeuristic (Heuristic heuristic);
-  
+
+  virtual ~RonPathHeuristic ();
+
+  /** Returns the best peer for reaching destination that hasn't been handed out yet (for any destination). */
   RonPeerEntry GetNextPeer (Ptr<RonPeerEntry> destination);
   Ipv4Address GetNextPeerAddress (Ptr<RonPeerEntry> destination);
+  /** Use the peers of the table, with rankings private to this heuristic. */
   void SetPeerTable (Ptr<RonPeerTable> table);
+  /** Use the peers of the cache's table, sharing its rankings if this heuristic allows it. */
+  void SetRankingCache (Ptr<RonRankingCache> cache);
   void SetSourcePeer (Ptr<RonPeerEntry> peer);
   Ptr<RonPeerEntry> GetSourcePeer ();
 
@@ -56,28 +125,51 @@ public:
   };
 
 protected:
-  std::vector<RonPeerEntry> peerHeap;
+  /** Score given to peers that should only be tried once every other peer has been. */
+  static const double NO_SCORE;
+
   Ptr<RonPeerTable> peers;
   UniformVariable random; //for random decisions
   Ptr<RonPeerEntry> m_source;
 
-  /** Returns true if peer1 has 'higher priority' than peer2, false otherwise.*/
-  virtual bool ComparePeers (Ptr<RonPeerEntry> destination, RonPeerEntry peer1, RonPeerEntry peer2) = 0;
-  virtual bool SameRegion (RonPeerEntry peer1, RonPeerEntry peer2);
+  /** Fills scores, which has one entry per handle of the table, with the score of each peer as an
+      intermediary towards destination.  Lower scores are better; those of unused handles are ignored. */
+  virtual void ScorePeers (Ptr<RonPeerEntry> destination, const RonPeerTable & table,
+                           std::vector<double> & scores) = 0;
+
+  /** Whether the scores only depend on the source location and the destination, so that
+      rankings can be shared with other heuristics of the same type. */
+  virtual bool CanShareRankings () const;
 
 private:
-  boost::function<bool (RonPeerEntry peer1, RonPeerEntry peer2)> GetPeerComparator (Ptr<RonPeerEntry> destination = NULL);
+  struct Cursor
+  {
+    Ptr<RonPeerRanking> ranking;
+    uint32_t version; //of the table when the ranking was made
+    uint32_t next;    //rank of the next peer to try
+  };
+
+  Ptr<RonRankingCache> m_rankings;
+  std::map<int, Cursor> m_cursors; //by destination id
+  std::set<int> m_used;            //ids of the peers already handed out, as handles may be reused
 };
 
 class RandomRonPathHeuristic : public RonPathHeuristic
 {
-  virtual bool ComparePeers (Ptr<RonPeerEntry> destination, RonPeerEntry peer1, RonPeerEntry peer2);
+  virtual void ScorePeers (Ptr<RonPeerEntry> destination, const RonPeerTable & table,
+                           std::vector<double> & scores);
+  // every client must make its own random choices
+  virtual bool CanShareRankings () const;
 };
 
 
 class OrthogonalRonPathHeuristic : public RonPathHeuristic
 {
-  virtual bool ComparePeers (Ptr<RonPeerEntry> destination, RonPeerEntry peer1, RonPeerEntry peer2);
+  virtual void ScorePeers (Ptr<RonPeerEntry> destination, const RonPeerTable & table,
+                           std::vector<double> & scores);
+
+  std::vector<double> m_distErr;  //squared distance errors, kept between calls to avoid reallocating
+  std::vector<uint32_t> m_region; //peers in the source or destination's region
 };
 
 } //namespace
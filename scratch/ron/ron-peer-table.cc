@@ -19,11 +19,15 @@
 #include "ron-peer-table.h"
 #include "failure-helper-functions.h"
 
-#include <boost/range/functions.hpp>
+#include <algorithm>
+#include <cmath>
 
 using namespace ns3;
 
-RonPeerEntry::RonPeerEntry () {}
+RonPeerEntry::RonPeerEntry ()
+  : id (-1)
+{
+}
 
 RonPeerEntry::RonPeerEntry (Ptr<Node> node)
   {
@@ -38,24 +42,61 @@ RonPeerEntry::RonPeerEntry (Ptr<Node> node)
   }
 
 
+RonPeerTable::RonPeerTable (double cellSize)
+  : m_npeers (0),
+    m_version (0),
+    m_cellSize (cellSize)
+{
+  NS_ASSERT (cellSize > 0.0);
+}
+
+
 int
 RonPeerTable::GetN ()
 {
-  return peers.size ();
+  return m_npeers;
 }
 
 
 RonPeerEntry
 RonPeerTable::AddPeer (RonPeerEntry entry)
 {
-  if (peers.count (entry.id) != 0)
+  NS_ASSERT_MSG (entry.id >= 0, "Peers need an id to be in a table");
+
+  uint32_t handle = GetHandle (entry.id);
+  if (handle != NO_HANDLE)
     {
-      RonPeerEntry temp = (*(peers.find (entry.id))).second;
-      peers[entry.id] = entry;
+      RonPeerEntry temp = m_entries[handle];
+      UnindexLocation (handle);
+      m_entries[handle] = entry;
+      IndexLocation (handle);
+      m_version++;
       return temp;
     }
+
+  if (!m_freeHandles.empty ())
+    {
+      handle = m_freeHandles.back ();
+      m_freeHandles.pop_back ();
+      m_entries[handle] = entry;
+    }
   else
-    return peers[entry.id] = entry;
+    {
+      handle = m_entries.size ();
+      m_entries.push_back (entry);
+      m_locations.x.push_back (0.0);
+      m_locations.y.push_back (0.0);
+      m_locations.z.push_back (0.0);
+    }
+
+  if ((uint32_t)entry.id >= m_handles.size ())
+    m_handles.resize (entry.id + 1, NO_HANDLE);
+  m_handles[entry.id] = handle;
+  m_npeers++;
+  m_version++;
+  IndexLocation (handle);
+
+  return entry;
 }
 
 
@@ -70,33 +111,38 @@ RonPeerTable::AddPeer (Ptr<Node> node)
 bool
 RonPeerTable::RemovePeer (int id)
 {
-  bool retValue = false;
-  if (peers.count (id))
-    retValue = true;
-  peers.erase (peers.find (id));
-  return retValue;
+  uint32_t handle = GetHandle (id);
+  if (handle == NO_HANDLE)
+    return false;
+
+  UnindexLocation (handle);
+  m_entries[handle] = RonPeerEntry ();
+  m_handles[id] = NO_HANDLE;
+  m_freeHandles.push_back (handle);
+  m_npeers--;
+  return true;
 }
 
 
-Ptr<RonPeerEntry>
-RonPeerTable::GetPeer (int id)
+const RonPeerEntry *
+RonPeerTable::GetPeer (int id) const
 {
-  if (peers.count (id))
-    return Create<RonPeerEntry> ((*(peers.find (id))).second);
-  else
+  uint32_t handle = GetHandle (id);
+  if (handle == NO_HANDLE)
     return NULL;
+  return &m_entries[handle];
 }
 
 
 bool
-RonPeerTable::IsInTable (int id)
+RonPeerTable::IsInTable (int id) const
 {
-  return peers.count (id);
+  return GetHandle (id) != NO_HANDLE;
 }
 
 
 bool
-RonPeerTable::IsInTable (Iterator itr)
+RonPeerTable::IsInTable (Iterator itr) const
 {
   return IsInTable ((*itr).id);
 }
@@ -105,17 +151,135 @@ RonPeerTable::IsInTable (Iterator itr)
 RonPeerTable::Iterator
 RonPeerTable::Begin ()
 {
-  return boost::begin (boost::adaptors::values (peers));
-/*template<typename T1, typename T2> T2& take_second(const std::pair<T1, T2> &a_pair)
-{
-  return a_pair.second;
-}
-boost::make_transform_iterator(a_map.begin(), take_second<int, string>),*/
+  return boost::make_filter_iterator (IsPresent (), m_entries.begin (), m_entries.end ());
 }
 
 
 RonPeerTable::Iterator
 RonPeerTable::End ()
 {
-  return boost::end (boost::adaptors::values (peers));
+  return boost::make_filter_iterator (IsPresent (), m_entries.end (), m_entries.end ());
+}
+
+
+bool
+RonPeerTable::IsPresent::operator() (const RonPeerEntry & entry) const
+{
+  return entry.id >= 0;
+}
+
+
+uint32_t
+RonPeerTable::GetHandle (int id) const
+{
+  if (id < 0 or (uint32_t)id >= m_handles.size ())
+    return NO_HANDLE;
+  return m_handles[id];
+}
+
+
+uint32_t
+RonPeerTable::GetNHandles () const
+{
+  return m_entries.size ();
+}
+
+
+bool
+RonPeerTable::IsValidHandle (uint32_t handle) const
+{
+  return handle < m_entries.size () and m_entries[handle].id >= 0;
+}
+
+
+const RonPeerEntry &
+RonPeerTable::GetPeerByHandle (uint32_t handle) const
+{
+  NS_ASSERT (IsValidHandle (handle));
+  return m_entries[handle];
+}
+
+
+const RonPeerLocations &
+RonPeerTable::GetLocations () const
+{
+  return m_locations;
+}
+
+
+uint32_t
+RonPeerTable::GetVersion () const
+{
+  return m_version;
+}
+
+
+void
+RonPeerTable::GetPeersAt (Vector location, std::vector<uint32_t> & handles) const
+{
+  Grid::const_iterator cell = m_grid.find (GetCell (location.x, location.y));
+  if (cell == m_grid.end ())
+    return;
+
+  for (std::vector<uint32_t>::const_iterator handle = cell->second.begin ();
+       handle != cell->second.end (); handle++)
+    {
+      if (m_locations.x[*handle] == location.x and m_locations.y[*handle] == location.y)
+        handles.push_back (*handle);
+    }
+}
+
+
+void
+RonPeerTable::GetPeersWithin (Vector center, double radius, std::vector<uint32_t> & handles) const
+{
+  CellKey low = GetCell (center.x - radius, center.y - radius);
+  CellKey high = GetCell (center.x + radius, center.y + radius);
+
+  // only the occupied cells in the columns overlapping the region are visited
+  for (Grid::const_iterator cell = m_grid.lower_bound (low);
+       cell != m_grid.end () and cell->first.first <= high.first; cell++)
+    {
+      if (cell->first.second < low.second or cell->first.second > high.second)
+        continue;
+
+      for (std::vector<uint32_t>::const_iterator handle = cell->second.begin ();
+           handle != cell->second.end (); handle++)
+        {
+          double dx = m_locations.x[*handle] - center.x;
+          double dy = m_locations.y[*handle] - center.y;
+          if (dx * dx + dy * dy <= radius * radius)
+            handles.push_back (*handle);
+        }
+    }
+}
+
+
+RonPeerTable::CellKey
+RonPeerTable::GetCell (double x, double y) const
+{
+  return CellKey ((int64_t)std::floor (x / m_cellSize), (int64_t)std::floor (y / m_cellSize));
+}
+
+
+void
+RonPeerTable::IndexLocation (uint32_t handle)
+{
+  const Vector & location = m_entries[handle].location;
+  m_locations.x[handle] = location.x;
+  m_locations.y[handle] = location.y;
+  m_locations.z[handle] = location.z;
+  m_grid[GetCell (location.x, location.y)].push_back (handle);
+}
+
+
+void
+RonPeerTable::UnindexLocation (uint32_t handle)
+{
+  Grid::iterator cell = m_grid.find (GetCell (m_locations.x[handle], m_locations.y[handle]));
+  NS_ASSERT (cell != m_grid.end ());
+
+  cell->second.erase (std::find (cell->second.begin (), cell->second.end (), handle));
+  if (cell->second.empty ())
+    m_grid.erase (cell);
 }
@@ -23,7 +23,8 @@
 #include "ns3/core-module.h"
 #include "ns3/mobility-module.h"
 
-#include <boost/range/adaptor/map.hpp>
+#include <boost/iterator/filter_iterator.hpp>
+#include <vector>
 #include <map>
 
 //TODO: enum for choosing which heuristic?
@@ -48,13 +49,32 @@ public:
   //TODO: failures reported counter / timer
 };  
 
+/** Locations of the peers in handle order, one column per coordinate so scans run over flat arrays. */
+struct RonPeerLocations
+{
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+};
+
+/** The peers of an overlay, stored densely and addressed by handles: small integers that stay the
+    same for as long as the peer is in the table, so lookups by handle or id never allocate.  The
+    locations are also kept in columns, with a grid over (x, y) for finding the peers in a region. */
 class RonPeerTable : public SimpleRefCount<RonPeerTable>
 {
  private:
-  typedef std::map<int, RonPeerEntry> underlyingMapType;
-  typedef boost::range_detail::select_second_mutable_range<underlyingMapType> underlyingIterator;
+  struct IsPresent
+  {
+    bool operator() (const RonPeerEntry & entry) const;
+  };
+  typedef std::vector<RonPeerEntry> underlyingVectorType;
  public:
-  typedef boost::range_iterator<underlyingIterator>::type Iterator;
+  typedef boost::filter_iterator<IsPresent, underlyingVectorType::iterator> Iterator;
+
+  static const uint32_t NO_HANDLE = 0xffffffff;
+
+  /** Grid cells used to index locations are cellSize wide in both x and y. */
+  RonPeerTable (double cellSize = 1.0);
 
   int GetN ();
 
@@ -62,18 +82,50 @@ class RonPeerTable : public SimpleRefCount<RonPeerTable>
   RonPeerEntry AddPeer (RonPeerEntry entry);
   /** Returns old entry if it existed, else new one. */
   RonPeerEntry AddPeer (Ptr<Node> node);
-  /** Returns true if entry existed. */
+  /** Returns true if entry existed.  The handle of the peer may be reused by later peers. */
   bool RemovePeer (int id);
-  /** Returns iterator to requested entry. Use IsInTable to verify its prescence in the table. */
-  Ptr<RonPeerEntry> GetPeer (int id);
-  bool IsInTable (int id);
-  bool IsInTable (Iterator itr);
+  /** Returns the requested entry, which stays valid until the table is modified, or NULL if it isn't in the table. */
+  const RonPeerEntry * GetPeer (int id) const;
+  bool IsInTable (int id) const;
+  bool IsInTable (Iterator itr) const;
   //TODO: other forms of get/remove
   Iterator Begin ();
   Iterator End ();
 
+  /** Returns the handle of the peer with this id, or NO_HANDLE. */
+  uint32_t GetHandle (int id) const;
+  /** One past the largest handle in use, for sizing arrays indexed by handle. */
+  uint32_t GetNHandles () const;
+  bool IsValidHandle (uint32_t handle) const;
+  const RonPeerEntry & GetPeerByHandle (uint32_t handle) const;
+  /** Locations of the peers by handle (those of unused handles are meaningless). */
+  const RonPeerLocations & GetLocations () const;
+
+  /** Changes whenever a peer is given a handle, new or reused, or replaced, so that whatever is kept by
+      handle (such as rankings of the peers) can tell it is stale. */
+  uint32_t GetVersion () const;
+
+  /** Appends the handles of the peers at the same (x, y) as location, which the heuristics consider one region. */
+  void GetPeersAt (Vector location, std::vector<uint32_t> & handles) const;
+  /** Appends the handles of the peers within distance radius of center in the (x, y) plane. */
+  void GetPeersWithin (Vector center, double radius, std::vector<uint32_t> & handles) const;
+
  private:
-  std::map<int, RonPeerEntry> peers;
+  typedef std::pair<int64_t, int64_t> CellKey;
+  typedef std::map<CellKey, std::vector<uint32_t> > Grid;
+
+  CellKey GetCell (double x, double y) const;
+  void IndexLocation (uint32_t handle);
+  void UnindexLocation (uint32_t handle);
+
+  underlyingVectorType m_entries;    //by handle, with an id of -1 for unused handles
+  RonPeerLocations m_locations;      //by handle
+  std::vector<uint32_t> m_handles;   //by peer id
+  std::vector<uint32_t> m_freeHandles;
+  uint32_t m_npeers;
+  uint32_t m_version;
+  double m_cellSize;
+  Grid m_grid;
 };
 
 } //namespace
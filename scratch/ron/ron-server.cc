@@ -68,6 +68,16 @@ RonServer::DoDispose (void)
   Application::DoDispose ();
 }
 
+void
+RonServer::DoReset (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // A fresh socket is bound when the server is started again
+  StopApplication ();
+  m_socket = 0;
+}
+
 void 
 RonServer::StartApplication (void)
 {
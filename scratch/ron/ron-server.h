@@ -49,6 +49,7 @@ public:
 
 protected:
   virtual void DoDispose (void);
+  virtual void DoReset (void);
 
 private:
 
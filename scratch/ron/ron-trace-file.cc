@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Compact binary traces of RON client events, see ron-trace-file.h for the format. **/
+
+#include "ron-trace-file.h"
+
+#include <cstring>
+
+NS_LOG_COMPONENT_DEFINE ("RonTraceFile");
+
+namespace ns3 {
+
+static const char traceMagic[8] = {'R', 'O', 'N', 'T', 'R', 'A', 'C', 'E'};
+static const uint32_t traceVersion = 1;
+static const uint32_t headerSize = 24;
+static const uint32_t recordSize = 32;
+
+static void
+WriteLe (uint8_t *buffer, uint64_t value, uint32_t nbytes)
+{
+  for (uint32_t i = 0; i < nbytes; i++)
+    buffer[i] = (value >> (8 * i)) & 0xff;
+}
+
+
+static uint64_t
+ReadLe (const uint8_t *buffer, uint32_t nbytes)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < nbytes; i++)
+    value |= (uint64_t)buffer[i] << (8 * i);
+  return value;
+}
+
+
+RonTraceWriter::RonTraceWriter (std::string fileName, uint32_t bufferSize)
+  : m_file (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc),
+    m_buffer (std::max (bufferSize, recordSize)),
+    m_used (0),
+    m_nrecords (0)
+{
+  if (!m_file)
+    NS_FATAL_ERROR ("Could not open trace file " << fileName);
+
+  uint8_t header[headerSize];
+  std::memcpy (header, traceMagic, sizeof (traceMagic));
+  WriteLe (header + 8, traceVersion, 4);
+  WriteLe (header + 12, recordSize, 4);
+  WriteLe (header + 16, Seconds (1.0).GetTimeStep (), 8);
+  m_file.write ((const char *)header, headerSize);
+}
+
+
+RonTraceWriter::~RonTraceWriter ()
+{
+  Close ();
+}
+
+
+void
+RonTraceWriter::Write (const RonTraceRecord & record)
+{
+  if (!m_file.is_open ())
+    return;
+  if (m_used + recordSize > m_buffer.size ())
+    Flush ();
+
+  uint8_t *buffer = &m_buffer[m_used];
+  buffer[0] = record.type;
+  buffer[1] = record.flags;
+  buffer[2] = record.hop;
+  buffer[3] = 0;
+  WriteLe (buffer + 4, record.node, 4);
+  WriteLe (buffer + 8, record.time, 8);
+  WriteLe (buffer + 16, record.seq, 4);
+  WriteLe (buffer + 20, record.origin.Get (), 4);
+  WriteLe (buffer + 24, record.nextDest.Get (), 4);
+  WriteLe (buffer + 28, record.finalDest.Get (), 4);
+
+  m_used += recordSize;
+  m_nrecords++;
+}
+
+
+void
+RonTraceWriter::Flush ()
+{
+  if (!m_file.is_open ())
+    return;
+
+  m_file.write ((const char *)&m_buffer[0], m_used);
+  m_file.flush ();
+  m_used = 0;
+}
+
+
+void
+RonTraceWriter::Close ()
+{
+  Flush ();
+  if (m_file.is_open ())
+    m_file.close ();
+}
+
+
+uint64_t
+RonTraceWriter::GetNRecords () const
+{
+  return m_nrecords;
+}
+
+
+RonTraceReader::RonTraceReader (std::string fileName)
+  : m_file (fileName.c_str (), std::ios::in | std::ios::binary),
+    m_stepsPerSecond (0)
+{
+  uint8_t header[headerSize];
+  if (!m_file.read ((char *)header, headerSize) or std::memcmp (header, traceMagic, sizeof (traceMagic)) != 0)
+    NS_FATAL_ERROR (fileName << " is not a binary RON trace");
+
+  uint32_t version = ReadLe (header + 8, 4);
+  uint32_t size = ReadLe (header + 12, 4);
+  if (version != traceVersion or size != recordSize)
+    NS_FATAL_ERROR (fileName << " has unsupported trace version " << version << " (record size " << size << ")");
+
+  m_stepsPerSecond = ReadLe (header + 16, 8);
+}
+
+
+bool
+RonTraceReader::Read (RonTraceRecord & record)
+{
+  uint8_t buffer[recordSize];
+  if (!m_file.read ((char *)buffer, recordSize))
+    return false;
+
+  record.type = buffer[0];
+  record.flags = buffer[1];
+  record.hop = buffer[2];
+  record.node = ReadLe (buffer + 4, 4);
+  record.time = ReadLe (buffer + 8, 8);
+  record.seq = ReadLe (buffer + 16, 4);
+  record.origin.Set (ReadLe (buffer + 20, 4));
+  record.nextDest.Set (ReadLe (buffer + 24, 4));
+  record.finalDest.Set (ReadLe (buffer + 28, 4));
+  return true;
+}
+
+
+int64_t
+RonTraceReader::GetStepsPerSecond () const
+{
+  return m_stepsPerSecond;
+}
+
+
+bool
+RonTraceReader::IsTraceFile (std::string fileName)
+{
+  std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (traceMagic)];
+  return file.read (magic, sizeof (magic)) and std::memcmp (magic, traceMagic, sizeof (magic)) == 0;
+}
+
+
+void
+ConvertTraceToText (std::string fileName, std::ostream & out)
+{
+  RonTraceReader reader (fileName);
+  double stepsPerSecond = reader.GetStepsPerSecond ();
+
+  RonTraceRecord record;
+  while (reader.Read (record))
+    {
+      double seconds = record.time / stepsPerSecond;
+      bool indirect = record.flags & RonTraceRecord::INDIRECT;
+
+      switch (record.type)
+        {
+        case RonTraceRecord::SEND:
+          out << "Node " << record.node << " sent " << (indirect ? "indirect" : "direct")
+              << " packet at " << seconds << "\n";
+          break;
+        case RonTraceRecord::ACK:
+          out << "Node " << record.node << " received " << (indirect ? "indirect" : "direct")
+              << " ACK at " << seconds << "\n";
+          break;
+        case RonTraceRecord::FORWARD:
+          out << "Node " << record.node << " forwarded packet (hop=" << (int)record.hop << ") at " << seconds
+              << " from " << record.origin << " to " << record.nextDest << " and eventually " << record.finalDest << "\n";
+          break;
+        default:
+          NS_LOG_WARN ("Unknown record type " << (int)record.type << " in " << fileName);
+        }
+    }
+}
+
+} //namespace ns3
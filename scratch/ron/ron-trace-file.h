@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Compact binary traces of RON client events.  A trace file is a header followed by
+    fixed-size records, all little-endian:
+      header (24 bytes): "RONTRACE", uint32 version, uint32 record size, int64 time steps per second
+      record (32 bytes): uint8 type, uint8 flags, uint8 hop, uint8 unused, uint32 node id,
+                         int64 time in steps, uint32 seq, uint32 origin, uint32 next destination,
+                         uint32 final destination (addresses as host-order integers)
+    Records are written through a large buffer, which must be flushed (or the writer closed)
+    before the process ends, as the sweep's worker processes exit without running destructors. **/
+
+#ifndef RON_TRACE_FILE_H
+#define RON_TRACE_FILE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct RonTraceRecord
+{
+  enum Type
+  {
+    SEND = 0,
+    ACK = 1,
+    FORWARD = 2
+  };
+  enum Flags
+  {
+    INDIRECT = 1 // the packet went (or is going) through the overlay
+  };
+
+  uint8_t type;
+  uint8_t flags;
+  uint8_t hop;
+  uint32_t node;
+  int64_t time; // in time steps
+  uint32_t seq;
+  Ipv4Address origin;
+  Ipv4Address nextDest;
+  Ipv4Address finalDest;
+};
+
+class RonTraceWriter : public SimpleRefCount<RonTraceWriter>
+{
+public:
+  /** Creates (truncating) the file and writes its header. */
+  RonTraceWriter (std::string fileName, uint32_t bufferSize = 1 << 20);
+  ~RonTraceWriter ();
+
+  void Write (const RonTraceRecord & record);
+  /** Writes out the buffered records. */
+  void Flush ();
+  /** Flushes and closes the file; further records are dropped. */
+  void Close ();
+
+  uint64_t GetNRecords () const;
+
+private:
+  std::ofstream m_file;
+  std::vector<uint8_t> m_buffer;
+  uint32_t m_used;
+  uint64_t m_nrecords;
+};
+
+class RonTraceReader : public SimpleRefCount<RonTraceReader>
+{
+public:
+  /** Opens the file and reads its header, failing fatally if it isn't a binary RON trace. */
+  RonTraceReader (std::string fileName);
+
+  /** Returns false once there are no more records. */
+  bool Read (RonTraceRecord & record);
+  int64_t GetStepsPerSecond () const;
+
+  /** Whether the file starts like a binary RON trace. */
+  static bool IsTraceFile (std::string fileName);
+
+private:
+  std::ifstream m_file;
+  int64_t m_stepsPerSecond;
+};
+
+/** Writes the records of a binary trace as the lines the text trace sinks write. */
+void ConvertTraceToText (std::string fileName, std::ostream & out);
+
+} //namespace ns3
+#endif //RON_TRACE_FILE_H
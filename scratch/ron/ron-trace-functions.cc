@@ -45,4 +45,42 @@ void PacketSent (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t
   NS_LOG_INFO (s.str ());
   *stream->GetStream () << s.str() << std::endl;
 }
+
+
+static void WriteRecord (Ptr<RonTraceWriter> writer, RonTraceRecord::Type type, Ptr<const Packet> p, uint32_t nodeId)
+{
+  RonHeader head;
+  p->PeekHeader (head);
+
+  RonTraceRecord record;
+  record.type = type;
+  record.flags = head.IsForward () ? RonTraceRecord::INDIRECT : 0;
+  record.hop = head.GetHop ();
+  record.node = nodeId;
+  record.time = Simulator::Now ().GetTimeStep ();
+  record.seq = head.GetSeq ();
+  record.origin = head.GetOrigin ();
+  record.nextDest = head.GetNextDest ();
+  record.finalDest = head.GetFinalDest ();
+
+  writer->Write (record);
+}
+
+
+void AckReceivedBinary (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId)
+{
+  WriteRecord (writer, RonTraceRecord::ACK, p, nodeId);
+}
+
+
+void PacketForwardedBinary (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId)
+{
+  WriteRecord (writer, RonTraceRecord::FORWARD, p, nodeId);
+}
+
+
+void PacketSentBinary (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId)
+{
+  WriteRecord (writer, RonTraceRecord::SEND, p, nodeId);
+}
 } //ns3 namespace
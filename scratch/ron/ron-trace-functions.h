@@ -11,6 +11,7 @@
 #include "ron-helper.h"
 #include "ron-client.h"
 #include "ron-server.h"
+#include "ron-trace-file.h"
 
 #ifndef RON_TRACE_FUNCTIONS_H
 #define RON_TRACE_FUNCTIONS_H
@@ -22,6 +23,11 @@ namespace ns3 {
 void AckReceived (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId);
 void PacketForwarded (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId);
 void PacketSent (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId);
+
+// The same events as binary records
+void AckReceivedBinary (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId);
+void PacketForwardedBinary (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId);
+void PacketSentBinary (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId);
   
   //}; //class
 
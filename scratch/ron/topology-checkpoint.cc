@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Captures the state of a fully built topology (every node in the NodeList) once, then
+    rolls back only the objects that were changed since, so that many simulation runs can
+    share one topology without rebuilding it or leaking state between runs.  See the header
+    for what is rolled back. **/
+
+#include "topology-checkpoint.h"
+#include "failure-helper-functions.h"
+
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+
+NS_LOG_COMPONENT_DEFINE ("TopologyCheckpoint");
+
+namespace ns3 {
+
+TopologyCheckpoint::TopologyCheckpoint ()
+  : m_captured (false)
+{
+}
+
+
+void
+TopologyCheckpoint::Capture ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_nodes.clear ();
+  m_nodes.resize (NodeList::GetNNodes ());
+  m_changed.clear ();
+
+  for (NodeList::Iterator itr = NodeList::Begin (); itr != NodeList::End (); itr++)
+    {
+      Ptr<Node> node = *itr;
+      NodeState & state = m_nodes[node->GetId ()];
+
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (ipv4)
+        {
+          state.interfaces.resize (ipv4->GetNInterfaces ());
+          for (uint32_t iface = 0; iface < ipv4->GetNInterfaces (); iface++)
+            {
+              state.interfaces[iface].up = ipv4->IsUp (iface);
+              state.interfaces[iface].forwarding = ipv4->IsForwarding (iface);
+            }
+        }
+
+      for (uint32_t app = 0; app < node->GetNApplications (); app++)
+        {
+          TimeValue start, stop;
+          node->GetApplication (app)->GetAttribute ("StartTime", start);
+          node->GetApplication (app)->GetAttribute ("StopTime", stop);
+          state.appStartTimes.push_back (start.Get ());
+          state.appStopTimes.push_back (stop.Get ());
+        }
+    }
+
+  m_captured = true;
+  NS_LOG_INFO ("Captured state of " << m_nodes.size () << " nodes");
+}
+
+
+bool
+TopologyCheckpoint::IsCaptured () const
+{
+  return m_captured;
+}
+
+
+void
+TopologyCheckpoint::MarkChanged (Ptr<Node> node)
+{
+  NS_ASSERT_MSG (m_captured, "Capture the topology before changing it!");
+  m_changed.insert (node->GetId ());
+}
+
+
+void
+TopologyCheckpoint::FailIpv4 (Ptr<Ipv4> ipv4, uint32_t iface)
+{
+  MarkChanged (ipv4->GetObject<Node> ());
+  ns3::FailIpv4 (ipv4, iface);
+}
+
+
+void
+TopologyCheckpoint::FailNode (Ptr<Node> node)
+{
+  MarkChanged (node);
+  ns3::FailNode (node);
+}
+
+
+uint32_t
+TopologyCheckpoint::GetNChanged () const
+{
+  return m_changed.size ();
+}
+
+
+uint32_t
+TopologyCheckpoint::Restore ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint32_t nrestored = m_changed.size ();
+
+  for (std::set<uint32_t>::iterator id = m_changed.begin (); id != m_changed.end (); id++)
+    {
+      NS_ASSERT (*id < m_nodes.size ());
+      RestoreNode (NodeList::GetNode (*id), m_nodes[*id]);
+    }
+
+  m_changed.clear ();
+
+  // The transmitters start out idle with empty queues, so there is nothing to capture
+  uint32_t nreset = ResetTransmitters ();
+  NS_LOG_INFO ("Restored " << nrestored << " nodes and reset " << nreset << " busy transmitters");
+
+  return nrestored;
+}
+
+
+void
+TopologyCheckpoint::RestoreNode (Ptr<Node> node, const NodeState & state)
+{
+  NS_LOG_LOGIC ("Restoring node " << node->GetId ());
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t iface = 0; iface < state.interfaces.size (); iface++)
+    {
+      // Only touch what actually changed: SetUp/SetDown notify the routing protocols
+      if (ipv4->IsUp (iface) != state.interfaces[iface].up)
+        {
+          if (state.interfaces[iface].up)
+            ipv4->SetUp (iface);
+          else
+            ipv4->SetDown (iface);
+        }
+      if (ipv4->IsForwarding (iface) != state.interfaces[iface].forwarding)
+        ipv4->SetForwarding (iface, state.interfaces[iface].forwarding);
+    }
+
+  // Applications installed after the capture are left alone
+  for (uint32_t app = 0; app < state.appStopTimes.size () and app < node->GetNApplications (); app++)
+    {
+      node->GetApplication (app)->SetAttribute ("StartTime", TimeValue (state.appStartTimes[app]));
+      node->GetApplication (app)->SetAttribute ("StopTime", TimeValue (state.appStopTimes[app]));
+    }
+
+  FlushArpCaches (node);
+}
+
+
+/** Flush the ARP caches of a node and of every node sharing a channel with it, as they may
+    hold entries (pending or dead) that were created while the node was failed.  Point-to-point
+    devices do not use ARP, so this only matters for the other kinds of links. */
+void
+TopologyCheckpoint::FlushArpCaches (Ptr<Node> node)
+{
+  for (uint32_t dev = 0; dev < node->GetNDevices (); dev++)
+    {
+      Ptr<Channel> channel = node->GetDevice (dev)->GetChannel ();
+      if (!channel)
+        continue;
+
+      for (uint32_t peer = 0; peer < channel->GetNDevices (); peer++)
+        {
+          Ptr<NetDevice> device = channel->GetDevice (peer);
+          Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+          if (!ipv4)
+            continue;
+
+          int32_t iface = ipv4->GetInterfaceForDevice (device);
+          if (iface < 0)
+            continue;
+
+          Ptr<ArpCache> cache = ipv4->GetInterface (iface)->GetArpCache ();
+          if (cache)
+            cache->Flush ();
+        }
+    }
+}
+
+} //namespace ns3
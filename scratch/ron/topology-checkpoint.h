@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Captures the state of a fully built topology (every node in the NodeList) once, then
+    rolls back only the objects that were changed since, so that many simulation runs can
+    share one topology without rebuilding it or leaking state between runs.
+
+    What is rolled back: whether interfaces are up and forwarding, the start and stop times
+    of applications, the ARP caches next to changed nodes, and the queues and transmitters
+    of all point-to-point devices.  Routing caches follow from the interface changes;
+    anything else (such as application state) must be reset by its owner. **/
+
+#ifndef TOPOLOGY_CHECKPOINT_H
+#define TOPOLOGY_CHECKPOINT_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <vector>
+#include <set>
+
+namespace ns3 {
+
+class TopologyCheckpoint : public SimpleRefCount<TopologyCheckpoint>
+{
+public:
+  TopologyCheckpoint ();
+
+  /** Record the current state of every node in the NodeList.  Should be called once the
+      topology and its applications have been built, before any failures are applied. */
+  void Capture ();
+  bool IsCaptured () const;
+
+  /** Fail the given interface, remembering that its node must be restored later. */
+  void FailIpv4 (Ptr<Ipv4> ipv4, uint32_t iface);
+  /** Fail the given node, remembering that it must be restored later. */
+  void FailNode (Ptr<Node> node);
+  /** Remember that a node was modified through some other means and must be restored. */
+  void MarkChanged (Ptr<Node> node);
+
+  /** Bring every node changed since the last restore back to its captured state.
+      Only the changed nodes (and the neighbours sharing their channels) are touched, except
+      for the point-to-point transmitters, which are reset everywhere as traffic in flight
+      when a run stops is not limited to the changed nodes.  Returns the number of nodes
+      restored. */
+  uint32_t Restore ();
+  uint32_t GetNChanged () const;
+
+private:
+  struct InterfaceState
+  {
+    bool up;
+    bool forwarding;
+  };
+
+  struct NodeState
+  {
+    std::vector<InterfaceState> interfaces;
+    std::vector<Time> appStartTimes;
+    std::vector<Time> appStopTimes;
+  };
+
+  void RestoreNode (Ptr<Node> node, const NodeState & state);
+  void FlushArpCaches (Ptr<Node> node);
+
+  bool m_captured;
+  std::vector<NodeState> m_nodes; //indexed by node id
+  std::set<uint32_t> m_changed;
+};
+
+} //namespace ns3
+#endif //TOPOLOGY_CHECKPOINT_H
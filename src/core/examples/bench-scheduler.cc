@@ -0,0 +1,294 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Compares the event schedulers on the classic "hold" model: the queue is
+// filled with events, then each step removes the next event and inserts a
+// new one at the time of the removed event plus a delay.  The delays come
+// either from a built-in profile shaped like the event times of a kind of
+// simulation, or from a log of the events a real run scheduled, captured with
+//
+//   NS_LOG="DefaultSimulatorImpl=level_function" ./waf --run ... 2> run.log
+//
+// and replayed with --log=run.log.  Each scheduler runs in its own process
+// so that its peak memory use can be told apart from the others'.
+
+#include "ns3/core-module.h"
+#include "ns3/list-scheduler.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/heap-scheduler.h"
+#include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BenchScheduler");
+
+static uint64_t
+Delay (double seconds)
+{
+  return Seconds (seconds).GetTimeStep ();
+}
+
+/* RON overlay runs: per-client timers of about a second, contact
+ * timeouts and the latencies of packets crossing the backbone */
+static void
+MakeRonDelays (uint32_t n, std::vector<uint64_t> &delays)
+{
+  Ptr<UniformRandomVariable> u = CreateObject<UniformRandomVariable> ();
+  Ptr<ExponentialRandomVariable> latency = CreateObject<ExponentialRandomVariable> ();
+  latency->SetAttribute ("Mean", DoubleValue (0.01));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double p = u->GetValue ();
+      if (p < 0.3)
+        {
+          delays.push_back (Delay (1.0 + u->GetValue (-0.05, 0.05)));
+        }
+      else if (p < 0.5)
+        {
+          delays.push_back (Delay (0.5));
+        }
+      else
+        {
+          delays.push_back (Delay (latency->GetValue ()));
+        }
+    }
+}
+
+/* point-to-point runs: transmission and propagation delays of a few
+ * microseconds to milliseconds */
+static void
+MakeP2pDelays (uint32_t n, std::vector<uint64_t> &delays)
+{
+  Ptr<ExponentialRandomVariable> delay = CreateObject<ExponentialRandomVariable> ();
+  delay->SetAttribute ("Mean", DoubleValue (0.002));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      delays.push_back (Delay (delay->GetValue ()));
+    }
+}
+
+/* wifi runs: slot-sized backoff and interframe delays, a few ack
+ * timeouts, and beacons every 102.4 ms */
+static void
+MakeWifiDelays (uint32_t n, std::vector<uint64_t> &delays)
+{
+  Ptr<UniformRandomVariable> u = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double p = u->GetValue ();
+      if (p < 0.8)
+        {
+          delays.push_back (Delay (9e-6 * u->GetInteger (1, 16)));
+        }
+      else if (p < 0.95)
+        {
+          delays.push_back (Delay (u->GetValue (50e-6, 400e-6)));
+        }
+      else
+        {
+          delays.push_back (Delay (0.1024));
+        }
+    }
+}
+
+/* the delays of the Schedule and ScheduleWithContext calls logged
+ * by DefaultSimulatorImpl */
+static void
+ReadLogDelays (std::string fileName, std::vector<uint64_t> &delays)
+{
+  std::ifstream log (fileName.c_str ());
+  if (!log)
+    {
+      NS_FATAL_ERROR ("Could not open " << fileName);
+    }
+
+  std::string line;
+  while (std::getline (log, line))
+    {
+      std::string::size_type call = line.find ("DefaultSimulatorImpl:Schedule");
+      if (call == std::string::npos)
+        {
+          continue;
+        }
+      // Schedule(this, delay, event) or ScheduleWithContext(this, context, delay, event)
+      bool withContext = line.compare (call + 29, 12, "WithContext(") == 0;
+      if (!withContext && line.compare (call + 29, 1, "(") != 0)
+        {
+          continue;
+        }
+      std::string args = line.substr (line.find ('(', call) + 1);
+      for (std::string::iterator c = args.begin (); c != args.end (); ++c)
+        {
+          if (*c == ',' || *c == ')')
+            {
+              *c = ' ';
+            }
+        }
+      std::istringstream fields (args);
+      std::string self, context;
+      int64_t delay;
+      fields >> self;
+      if (withContext)
+        {
+          fields >> context;
+        }
+      if (fields >> delay && delay >= 0)
+        {
+          delays.push_back (delay);
+        }
+    }
+
+  if (delays.empty ())
+    {
+      NS_FATAL_ERROR ("No scheduled events in " << fileName);
+    }
+}
+
+/* runs the hold model and prints the events per second and the
+ * peak memory growth of the process */
+static void
+Bench (std::string name, const std::vector<uint64_t> &delays, uint32_t pending, uint32_t steps)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (name);
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  long startRss = usage.ru_maxrss;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_context = 0;
+  ev.key.m_uid = 0;
+  uint32_t next = 0;
+  for (uint32_t i = 0; i < pending; i++)
+    {
+      ev.key.m_ts = delays[next];
+      ev.key.m_uid++;
+      next = (next + 1) % delays.size ();
+      scheduler->Insert (ev);
+    }
+  for (uint32_t i = 0; i < steps; i++)
+    {
+      Scheduler::Event current = scheduler->RemoveNext ();
+      ev.key.m_ts = current.key.m_ts + delays[next];
+      ev.key.m_uid++;
+      next = (next + 1) % delays.size ();
+      scheduler->Insert (ev);
+    }
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+    }
+
+  int64_t ms = clock.End ();
+  getrusage (RUSAGE_SELF, &usage);
+
+  std::cout << std::setw (24) << std::left << name << std::right
+            << std::setw (14) << (uint64_t)(pending + steps) * 1000 / std::max (ms, (int64_t)1) << " events/s"
+            << std::setw (10) << usage.ru_maxrss - startRss << " KiB peak" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string profile = "ron";
+  std::string logFile = "";
+  std::string schedulers = "ns3::ListScheduler,ns3::MapScheduler,ns3::HeapScheduler,"
+    "ns3::CalendarScheduler,ns3::LadderScheduler";
+  uint32_t pending = 100000;
+  uint32_t steps = 5000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("profile", "Delay profile to use: ron, p2p or wifi", profile);
+  cmd.AddValue ("log", "DefaultSimulatorImpl function log to replay the delays of, instead of a profile", logFile);
+  cmd.AddValue ("schedulers", "Comma-separated TypeIds of the schedulers to compare", schedulers);
+  cmd.AddValue ("pending", "Number of events in the queue", pending);
+  cmd.AddValue ("steps", "Number of events to remove and insert once the queue is full", steps);
+  cmd.Parse (argc, argv);
+
+  std::vector<uint64_t> delays;
+  if (logFile != "")
+    {
+      ReadLogDelays (logFile, delays);
+      profile = logFile;
+    }
+  else if (profile == "ron")
+    {
+      MakeRonDelays (1000000, delays);
+    }
+  else if (profile == "p2p")
+    {
+      MakeP2pDelays (1000000, delays);
+    }
+  else if (profile == "wifi")
+    {
+      MakeWifiDelays (1000000, delays);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown profile " << profile);
+    }
+
+  std::cout << "Delays from " << profile << " (" << delays.size () << "), "
+            << pending << " pending events, " << steps << " steps" << std::endl;
+
+  std::istringstream names (schedulers);
+  std::string name;
+  while (std::getline (names, name, ','))
+    {
+      // the list scheduler is O(n) per insert, which makes it too slow for large queues
+      if (name == "ns3::ListScheduler" && pending > 10000)
+        {
+          std::cout << std::setw (24) << std::left << name << " skipped, too many pending events" << std::endl;
+          continue;
+        }
+
+      std::cout.flush ();
+      pid_t child = fork ();
+      if (child < 0)
+        {
+          NS_FATAL_ERROR ("Could not fork");
+        }
+      if (child == 0)
+        {
+          Bench (name, delays, pending, steps);
+          std::cout.flush ();
+          _exit (0);
+        }
+      int status;
+      waitpid (child, &status, 0);
+    }
+
+  return 0;
+}
@@ -18,7 +18,14 @@
  * Authors: Mathieu Lacage <mathieu.lacage@gmail.com>
  */
 #include "attribute-construction-list.h"
+#include "object-base.h"
+#include "pointer.h"
+#include "string.h"
 #include "log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
 
 namespace ns3 {
 
@@ -80,4 +87,125 @@ AttributeConstructionList::End (void) const
   return m_list.end();
 }
 
+AttributeConstructionPlan::AttributeConstructionPlan (TypeId tid, const AttributeConstructionList &attributes)
+  : m_tid (tid),
+    m_generation (TypeId::GetRegistryGeneration ())
+{
+  NS_LOG_FUNCTION (this << tid << &attributes);
+
+  // name=value pairs from the environment
+  std::vector<std::pair<std::string, std::string> > defaults;
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  if (envVar != 0)
+    {
+      std::string env = std::string (envVar);
+      std::string::size_type cur = 0;
+      std::string::size_type next = 0;
+      while (next != std::string::npos)
+        {
+          next = env.find (";", cur);
+          std::string tmp = std::string (env, cur, next-cur);
+          std::string::size_type equal = tmp.find ("=");
+          if (equal != std::string::npos)
+            {
+              defaults.push_back (std::make_pair (tmp.substr (0, equal),
+                                                  tmp.substr (equal+1, tmp.size () - equal - 1)));
+            }
+          cur = next + 1;
+        }
+    }
+#endif /* HAVE_GETENV */
+
+  // loop over the inheritance tree back to the Object base class.
+  do {
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+            {
+              continue;
+            }
+          struct Step step;
+          step.accessor = info.accessor;
+          step.checker = info.checker;
+          Ptr<AttributeValue> value = attributes.Find (info.checker);
+          if (value != 0)
+            {
+              AddValue (step, value);
+            }
+          if (!defaults.empty ())
+            {
+              std::string fullName = tid.GetAttributeFullName (i);
+              for (uint32_t j = 0; j < defaults.size (); j++)
+                {
+                  if (defaults[j].first == fullName)
+                    {
+                      AddValue (step, Create<StringValue> (defaults[j].second));
+                    }
+                }
+            }
+          AddValue (step, info.initialValue);
+          m_steps.push_back (step);
+        }
+      tid = tid.GetParent ();
+    } while (tid != ObjectBase::GetTypeId ());
+}
+
+void
+AttributeConstructionPlan::AddValue (struct Step &step, Ptr<const AttributeValue> value) const
+{
+  NS_LOG_FUNCTION (this << &step << value);
+  struct Value v;
+  if (step.checker->Check (*value))
+    {
+      v.value = value;
+      v.valid = true;
+    }
+  else if (dynamic_cast<PointerValue *> (PeekPointer (step.checker->Create ())) != 0)
+    {
+      v.value = value;
+      v.valid = false;
+    }
+  else
+    {
+      v.value = step.checker->CreateValidValue (*value);
+      v.valid = true;
+      if (v.value == 0)
+        {
+          // could never be set
+          return;
+        }
+    }
+  step.values.push_back (v);
+}
+
+TypeId
+AttributeConstructionPlan::GetTypeId (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_tid;
+}
+
+bool
+AttributeConstructionPlan::IsUpToDate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_generation == TypeId::GetRegistryGeneration ();
+}
+
+AttributeConstructionPlan::CIterator
+AttributeConstructionPlan::Begin (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_steps.begin ();
+}
+
+AttributeConstructionPlan::CIterator
+AttributeConstructionPlan::End (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_steps.end ();
+}
+
 } // namespace ns3
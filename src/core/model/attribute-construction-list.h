@@ -21,7 +21,9 @@
 #define ATTRIBUTE_CONSTRUCTION_LIST_H
 
 #include "attribute.h"
+#include "type-id.h"
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -45,6 +47,53 @@ private:
   std::list<struct Item> m_list;
 };
 
+/**
+ * \brief an AttributeConstructionList resolved against a TypeId
+ *
+ * Lists, for every attribute of the type and of its parents which can
+ * be set at construction time, the values ObjectBase::ConstructSelf
+ * tries in turn: the one from the AttributeConstructionList, those from
+ * the NS_ATTRIBUTE_DEFAULT environment variable and the initial value.
+ * The attributes are looked up, the environment variable is read and
+ * the values given as strings are parsed once, when the plan is built,
+ * so that a plan can construct many objects quickly.  The strings given
+ * for PointerValue attributes are the exception: they describe an
+ * object to create, and each instance must get its own.
+ *
+ * A plan is out of date once an attribute or its initial value is
+ * changed on any TypeId (see TypeId::GetRegistryGeneration).
+ */
+class AttributeConstructionPlan : public SimpleRefCount<AttributeConstructionPlan>
+{
+public:
+  struct Value
+  {
+    Ptr<const AttributeValue> value;
+    // true if the checker accepts the value as is, false if it must
+    // be converted by AttributeChecker::CreateValidValue first
+    bool valid;
+  };
+  struct Step
+  {
+    Ptr<const AttributeAccessor> accessor;
+    Ptr<const AttributeChecker> checker;
+    std::vector<struct Value> values;
+  };
+  typedef std::vector<struct Step>::const_iterator CIterator;
+
+  AttributeConstructionPlan (TypeId tid, const AttributeConstructionList &attributes);
+  TypeId GetTypeId (void) const;
+  bool IsUpToDate (void) const;
+  CIterator Begin (void) const;
+  CIterator End (void) const;
+private:
+  void AddValue (struct Step &step, Ptr<const AttributeValue> value) const;
+
+  TypeId m_tid;
+  uint32_t m_generation;
+  std::vector<struct Step> m_steps;
+};
+
 } // namespace ns3
 
 #endif /* ATTRIBUTE_CONSTRUCTION_LIST_H */
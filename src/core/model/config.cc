@@ -27,6 +27,8 @@
 #include "log.h"
 
 #include <sstream>
+#include <algorithm>
+#include <map>
 
 NS_LOG_COMPONENT_DEFINE ("Config");
 
@@ -147,79 +149,129 @@ class ArrayMatcher
 public:
   ArrayMatcher (std::string element);
   bool Matches (uint32_t i) const;
+  /**
+   * Find the indices which can match, in increasing order, when they are
+   * all in [0,n[ and there are at most n of them, so that they can be
+   * looked up directly rather than by going through every item of a
+   * container.
+   */
+  bool GetCandidates (uint32_t n, std::vector<uint32_t> *candidates) const;
 private:
+  void Parse (std::string element);
   bool StringToUint32 (std::string str, uint32_t *value) const;
   std::string m_element;
+  bool m_all;
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+// The element is parsed once into the ranges of indices it matches:
+// "*", "a|b", "[x-y]" and plain numbers.
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
+        {
+          m_ranges.push_back (std::make_pair (min, max));
+        }
+      return;
+    }
+  uint32_t value;
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
+      return true;
+    }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator range = m_ranges.begin ();
+       range != m_ranges.end (); range++)
+    {
+      if (i >= range->first && i <= range->second)
         {
           NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
           return true;
         }
-      else
+    }
+  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
+  return false;
+}
+bool
+ArrayMatcher::GetCandidates (uint32_t n, std::vector<uint32_t> *candidates) const
+{
+  NS_LOG_FUNCTION (this << n << candidates);
+  if (m_all)
+    {
+      return false;
+    }
+  uint64_t count = 0;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator range = m_ranges.begin ();
+       range != m_ranges.end (); range++)
+    {
+      if (range->second >= n)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
           return false;
         }
+      count += range->second - range->first + 1;
     }
-  uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (count > n)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
+      return false;
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-  return false;
+  candidates->clear ();
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator range = m_ranges.begin ();
+       range != m_ranges.end (); range++)
+    {
+      for (uint32_t i = range->first; i <= range->second; i++)
+        {
+          candidates->push_back (i);
+        }
+    }
+  std::sort (candidates->begin (), candidates->end ());
+  candidates->erase (std::unique (candidates->begin (), candidates->end ()), candidates->end ());
+  return true;
 }
 
 bool
@@ -233,6 +285,12 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 }
 
 
+/**
+ * Walks the object graph along a path.  The path is split into its items
+ * once, when the resolver is created, and the type of every "$type" item
+ * and the matcher of every container index are looked up or parsed the
+ * first time they are needed only.
+ */
 class Resolver
 {
 public:
@@ -242,13 +300,22 @@ public:
   void Resolve (Ptr<Object> root);
 private:
   void Canonicalize (void);
-  void DoResolve (std::string path, Ptr<Object> root);
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoResolve (uint32_t index, Ptr<Object> root);
+  void DoArrayResolve (uint32_t index, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t index, Ptr<Object> root, Ptr<const ObjectPtrContainerAccessor> accessor);
   void DoResolveOne (Ptr<Object> object);
   std::string GetResolvedPath (void) const;
+  TypeId GetItemTypeId (uint32_t item);
+  const ArrayMatcher &GetItemMatcher (uint32_t item);
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
+  Resolver (const Resolver &o);
+  Resolver &operator = (const Resolver &o);
   std::vector<std::string> m_workStack;
   std::string m_path;
+  std::vector<std::string> m_items;
+  std::vector<TypeId> m_tids;
+  std::vector<bool> m_tidValid;
+  std::vector<ArrayMatcher *> m_matchers;
 };
 
 Resolver::Resolver (std::string path)
@@ -256,10 +323,25 @@ Resolver::Resolver (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", start)) != std::string::npos)
+    {
+      m_items.push_back (m_path.substr (start, next - start));
+      start = next + 1;
+    }
+  m_tids.resize (m_items.size ());
+  m_tidValid.resize (m_items.size (), false);
+  m_matchers.resize (m_items.size (), 0);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
+  for (std::vector<ArrayMatcher *>::iterator i = m_matchers.begin (); i != m_matchers.end (); i++)
+    {
+      delete *i;
+    }
 }
 void
 Resolver::Canonicalize (void)
@@ -286,7 +368,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -302,6 +384,29 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
+TypeId
+Resolver::GetItemTypeId (uint32_t item)
+{
+  NS_LOG_FUNCTION (this << item);
+  if (!m_tidValid[item])
+    {
+      m_tids[item] = TypeId::LookupByName (m_items[item].substr (1, m_items[item].size () - 1));
+      m_tidValid[item] = true;
+    }
+  return m_tids[item];
+}
+
+const ArrayMatcher &
+Resolver::GetItemMatcher (uint32_t item)
+{
+  NS_LOG_FUNCTION (this << item);
+  if (m_matchers[item] == 0)
+    {
+      m_matchers[item] = new ArrayMatcher (m_items[item]);
+    }
+  return *m_matchers[item];
+}
+
 void 
 Resolver::DoResolveOne (Ptr<Object> object)
 {
@@ -312,13 +417,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t index, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << index << root);
 
-  if (next == std::string::npos)
+  if (index == m_items.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -334,8 +437,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const std::string &item = m_items[index];
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -346,11 +448,11 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
+      std::string::size_type offset = item.find ("Names");
       if (offset == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (index + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -367,7 +469,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (index + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -387,17 +489,16 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   if (dollarPos == 0)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      NS_LOG_DEBUG ("GetObject="<<item<<" on path="<<GetResolvedPath ());
+      TypeId tid = GetItemTypeId (index);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<item<<") failed on path="<<GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (index + 1, object);
       m_workStack.pop_back ();
     }
   else 
@@ -430,7 +531,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
                 }
               foundMatch = true;
               m_workStack.push_back (info.name);
-              DoResolve (pathLeft, object);
+              DoResolve (index + 1, object);
               m_workStack.pop_back ();
             }
           // attempt to cast to an object vector.
@@ -438,12 +539,21 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
             dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
           if (vectorChecker != 0)
             {
-              NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath ());
               foundMatch = true;
-              ObjectPtrContainerValue vector;
-              root->GetAttribute (info.name, vector);
               m_workStack.push_back (info.name);
-              DoArrayResolve (pathLeft, vector);
+              Ptr<const ObjectPtrContainerAccessor> accessor =
+                DynamicCast<const ObjectPtrContainerAccessor> (info.accessor);
+              if (accessor != 0)
+                {
+                  DoArrayResolve (index + 1, root, accessor);
+                }
+              else
+                {
+                  ObjectPtrContainerValue vector;
+                  root->GetAttribute (info.name, vector);
+                  DoArrayResolve (index + 1, vector);
+                }
               m_workStack.pop_back ();
             }
           // this could be anything else and we don't know what to do with it.
@@ -458,20 +568,15 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t index, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << index << &container);
+  if (index == m_items.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  const ArrayMatcher &matcher = GetItemMatcher (index);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -480,12 +585,66 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (index + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
 }
 
+// When the item only names a few indices of a container whose indices are
+// the positions of its items, as in object vectors, the items at those
+// positions are looked up directly.  Otherwise (object maps are indexed by
+// key) the whole container is copied and searched, as
+// ObjectPtrContainerValue orders it.
+void
+Resolver::DoArrayResolve (uint32_t index, Ptr<Object> root, Ptr<const ObjectPtrContainerAccessor> accessor)
+{
+  NS_LOG_FUNCTION(this << index << root << accessor);
+  if (index == m_items.size ())
+    {
+      return;
+    }
+  uint32_t n;
+  if (!accessor->GetN (PeekPointer (root), &n))
+    {
+      return;
+    }
+
+  std::vector<uint32_t> candidates;
+  if (accessor->IsIndexedByPosition () &&
+      GetItemMatcher (index).GetCandidates (n, &candidates))
+    {
+      std::vector<Ptr<Object> > objects;
+      objects.reserve (candidates.size ());
+      for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+        {
+          uint32_t itemIndex;
+          objects.push_back (accessor->GetItem (PeekPointer (root), *i, &itemIndex));
+          if (itemIndex != *i)
+            {
+              objects.clear ();
+              break;
+            }
+        }
+      if (objects.size () == candidates.size ())
+        {
+          for (uint32_t i = 0; i < candidates.size (); i++)
+            {
+              std::ostringstream oss;
+              oss << candidates[i];
+              m_workStack.push_back (oss.str ());
+              DoResolve (index + 1, objects[i]);
+              m_workStack.pop_back ();
+            }
+          return;
+        }
+    }
+
+  ObjectPtrContainerValue vector;
+  accessor->Get (PeekPointer (root), vector);
+  DoArrayResolve (index, vector);
+}
+
 
 class ConfigImpl 
 {
@@ -495,6 +654,8 @@ public:
   void Connect (std::string path, const CallbackBase &cb);
   void DisconnectWithoutContext (std::string path, const CallbackBase &cb);
   void Disconnect (std::string path, const CallbackBase &cb);
+  void ConnectWithoutContext (const std::vector<std::string> &paths, const CallbackBase &cb);
+  void Connect (const std::vector<std::string> &paths, const CallbackBase &cb);
   Config::MatchContainer LookupMatches (std::string path);
 
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -570,6 +731,44 @@ ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
   container.Disconnect (leaf, cb);
 }
 
+// The paths of one call are resolved against the same object graph, so
+// the objects matched by a path are looked up once for all the trace
+// sources connected through it.
+void
+ConfigImpl::ConnectWithoutContext (const std::vector<std::string> &paths, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << paths.size () << &cb);
+  std::map<std::string, Config::MatchContainer> matches;
+  for (std::vector<std::string>::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      std::string root, leaf;
+      ParsePath (*i, &root, &leaf);
+      std::map<std::string, Config::MatchContainer>::iterator container = matches.find (root);
+      if (container == matches.end ())
+        {
+          container = matches.insert (std::make_pair (root, LookupMatches (root))).first;
+        }
+      container->second.ConnectWithoutContext (leaf, cb);
+    }
+}
+void
+ConfigImpl::Connect (const std::vector<std::string> &paths, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << paths.size () << &cb);
+  std::map<std::string, Config::MatchContainer> matches;
+  for (std::vector<std::string>::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      std::string root, leaf;
+      ParsePath (*i, &root, &leaf);
+      std::map<std::string, Config::MatchContainer>::iterator container = matches.find (root);
+      if (container == matches.end ())
+        {
+          container = matches.insert (std::make_pair (root, LookupMatches (root))).first;
+        }
+      container->second.Connect (leaf, cb);
+    }
+}
+
 Config::MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
 {
@@ -586,7 +785,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver (path);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -736,6 +935,18 @@ Disconnect (std::string path, const CallbackBase &cb)
   NS_LOG_FUNCTION (path << &cb);
   Singleton<ConfigImpl>::Get ()->Disconnect (path, cb);
 }
+void
+ConnectWithoutContext (const std::vector<std::string> &paths, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (paths.size () << &cb);
+  Singleton<ConfigImpl>::Get ()->ConnectWithoutContext (paths, cb);
+}
+void
+Connect (const std::vector<std::string> &paths, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (paths.size () << &cb);
+  Singleton<ConfigImpl>::Get ()->Connect (paths, cb);
+}
 Config::MatchContainer LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (path);
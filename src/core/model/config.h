@@ -116,6 +116,26 @@ void Connect (std::string path, const CallbackBase &cb);
  * This function undoes the work of Config::ConnectWithContext.
  */
 void Disconnect (std::string path, const CallbackBase &cb);
+/**
+ * \param paths the paths to match trace sources.
+ * \param cb the callback to connect to the matching trace sources.
+ *
+ * This function connects the input callback to the trace sources
+ * matched by every input path, like calling Config::ConnectWithoutContext
+ * for each of them.  The objects matched by paths which differ only in
+ * their trace source are looked up once.
+ */
+void ConnectWithoutContext (const std::vector<std::string> &paths, const CallbackBase &cb);
+/**
+ * \param paths the paths to match trace sources.
+ * \param cb the callback to connect to the matching trace sources.
+ *
+ * This function connects the input callback to the trace sources
+ * matched by every input path, like calling Config::Connect
+ * for each of them.  The objects matched by paths which differ only in
+ * their trace source are looked up once.
+ */
+void Connect (const std::vector<std::string> &paths, const CallbackBase &cb);
 
 /**
  * \brief hold a set of objects which match a specific search string.
@@ -25,10 +25,14 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "double.h"
+#include "uinteger.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 // Note:  Logging in this file is largely avoided due to the
 // number of calls that are made to these functions and the possibility
@@ -46,6 +50,17 @@ DefaultSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DefaultSimulatorImpl")
     .SetParent<SimulatorImpl> ()
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("CompactCancelledFraction",
+                   "Take the cancelled events out of the event list as soon as they make up "
+                   "more than this fraction of it, rather than when their time comes (0 to disable).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&DefaultSimulatorImpl::m_compactFraction),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("CompactMinEvents",
+                   "Never compact event lists with fewer events than this.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_compactMinEvents),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -64,8 +79,14 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
+  m_cancelledEvents = 0;
+  m_executedEvents = 0;
+  m_deadEvents = 0;
+  m_maxCancelledEvents = 0;
+  m_compactions = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  EventImpl::BindToCurrentThread ();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -137,7 +158,20 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (next.impl->IsCancelled ())
+    {
+      m_deadEvents++;
+      // events can also be cancelled through their EventImpl
+      if (m_cancelledEvents > 0)
+        {
+          m_cancelledEvents--;
+        }
+    }
+  else
+    {
+      m_executedEvents++;
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -185,6 +219,7 @@ DefaultSimulatorImpl::Run (void)
   NS_LOG_FUNCTION (this);
   // Set the current threadId as the main threadId
   m_main = SystemThread::Self();
+  EventImpl::BindToCurrentThread ();
   ProcessEventsWithContext ();
   m_stop = false;
 
@@ -353,9 +388,77 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          // destroy events are not in the event list
+          return;
+        }
+      m_cancelledEvents++;
+      m_maxCancelledEvents = std::max (m_maxCancelledEvents, m_cancelledEvents);
+      if (m_compactFraction > 0.0
+          && m_unscheduledEvents >= (int)m_compactMinEvents
+          && m_cancelledEvents > m_compactFraction * m_unscheduledEvents)
+        {
+          Compact ();
+        }
     }
 }
 
+void
+DefaultSimulatorImpl::Compact (void)
+{
+  NS_LOG_FUNCTION (this << m_cancelledEvents << m_unscheduledEvents);
+  // Removing the events one by one is linear for most schedulers, so the
+  // list is rebuilt instead.  As this only happens once a fixed fraction
+  // of the events are cancelled, it costs O(log n) per cancelled event.
+  std::vector<Scheduler::Event> live;
+  live.reserve (m_unscheduledEvents - m_cancelledEvents);
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->RemoveNext ();
+      if (next.impl->IsCancelled ())
+        {
+          next.impl->Unref ();
+          m_unscheduledEvents--;
+          m_deadEvents++;
+        }
+      else
+        {
+          live.push_back (next);
+        }
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = live.begin (); i != live.end (); ++i)
+    {
+      m_events->Insert (*i);
+    }
+  m_cancelledEvents = 0;
+  m_compactions++;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetNExecutedEvents (void) const
+{
+  return m_executedEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetNDeadEvents (void) const
+{
+  return m_deadEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetMaxCancelledEvents (void) const
+{
+  return m_maxCancelledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetNCompactions (void) const
+{
+  return m_compactions;
+}
+
 bool
 DefaultSimulatorImpl::IsExpired (const EventId &ev) const
 {
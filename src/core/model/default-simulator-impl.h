@@ -60,10 +60,32 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \returns the number of events run so far
+   */
+  uint64_t GetNExecutedEvents (void) const;
+  /**
+   * \returns the number of cancelled events taken out of the event
+   *          list so far, whether they reached the front of the list
+   *          or were compacted away
+   */
+  uint64_t GetNDeadEvents (void) const;
+  /**
+   * \returns the largest number of cancelled events that the event
+   *          list held at once
+   */
+  uint32_t GetMaxCancelledEvents (void) const;
+  /**
+   * \returns the number of times the event list was compacted
+   */
+  uint32_t GetNCompactions (void) const;
+
 private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
+  /* takes the cancelled events out of the event list */
+  void Compact (void);
  
   struct EventWithContext {
     uint32_t context;
@@ -88,6 +110,17 @@ private:
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
 
+  // cancelled events still in the event list; once they make up more
+  // than m_compactFraction of it, the list is compacted
+  uint32_t m_cancelledEvents;
+  double m_compactFraction;
+  uint32_t m_compactMinEvents;
+
+  uint64_t m_executedEvents;
+  uint64_t m_deadEvents;
+  uint32_t m_maxCancelledEvents;
+  uint32_t m_compactions;
+
   SystemThread::ThreadId m_main;
 };
 
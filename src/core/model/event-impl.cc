@@ -20,11 +20,249 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
+#include <new>
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
 namespace ns3 {
 
+namespace {
+
+/* Free lists of event blocks, one per multiple of GRANULARITY bytes.
+ * Each block is a separate allocation, so that blocks can move freely
+ * between the free lists and the system allocator.  Blocks larger than
+ * the largest class always come from the system allocator.
+ *
+ * Only the owner, the thread running the simulation, uses the free lists
+ * and the plain counters.  Other threads count the events they make and
+ * delete under a lock.  An event made by one side may be deleted by the
+ * other, so either byte counter may wrap around: only their sum, taken
+ * modulo 2^64, is meaningful.
+ *
+ * The pool is created on first use and never deleted, as events may
+ * still be deleted by static destructors at exit. */
+struct EventPool
+{
+  enum
+  {
+    GRANULARITY = 16,
+    NCLASSES = 16
+  };
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  EventPool ();
+  bool IsOwner (void) const;
+  void CountForeign (uint64_t nAllocated, int64_t bytes);
+  void GetForeign (uint64_t *nAllocated, uint64_t *bytes);
+
+  FreeBlock *freeLists[NCLASSES];
+  uint64_t nAllocated;
+  uint64_t nRecycled;
+  uint64_t bytesLive;
+  uint64_t nForeignAllocated;
+  uint64_t foreignBytesLive;
+#ifdef HAVE_PTHREAD_H
+  pthread_t owner; // the thread running the simulation
+  pthread_mutex_t foreignLock;
+#endif /* HAVE_PTHREAD_H */
+};
+
+EventPool::EventPool ()
+  : nAllocated (0),
+    nRecycled (0),
+    bytesLive (0),
+    nForeignAllocated (0),
+    foreignBytesLive (0)
+{
+  for (uint32_t i = 0; i < NCLASSES; i++)
+    {
+      freeLists[i] = 0;
+    }
+#ifdef HAVE_PTHREAD_H
+  // until a simulator binds the pool, the first thread to make an event
+  owner = pthread_self ();
+  pthread_mutex_init (&foreignLock, 0);
+#endif /* HAVE_PTHREAD_H */
+}
+
+bool
+EventPool::IsOwner (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  return pthread_equal (owner, pthread_self ());
+#else
+  return true;
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+EventPool::CountForeign (uint64_t n, int64_t bytes)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&foreignLock);
+#endif /* HAVE_PTHREAD_H */
+  nForeignAllocated += n;
+  foreignBytesLive += bytes;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&foreignLock);
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+EventPool::GetForeign (uint64_t *n, uint64_t *bytes)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&foreignLock);
+#endif /* HAVE_PTHREAD_H */
+  *n = nForeignAllocated;
+  *bytes = foreignBytesLive;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&foreignLock);
+#endif /* HAVE_PTHREAD_H */
+}
+
+EventPool &
+GetEventPool (void)
+{
+  static EventPool *pool = new EventPool ();
+  return *pool;
+}
+
+} // anonymous namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  EventPool &pool = GetEventPool ();
+  uint32_t sizeClass = (size - 1) / EventPool::GRANULARITY;
+  if (sizeClass >= EventPool::NCLASSES)
+    {
+      if (pool.IsOwner ())
+        {
+          pool.nAllocated++;
+          pool.bytesLive += size;
+        }
+      else
+        {
+          pool.CountForeign (1, size);
+        }
+      return ::operator new (size);
+    }
+  if (!pool.IsOwner ())
+    {
+      pool.CountForeign (1, (sizeClass + 1) * EventPool::GRANULARITY);
+      // may end up in a free list once deleted
+      return ::operator new ((sizeClass + 1) * EventPool::GRANULARITY);
+    }
+  pool.nAllocated++;
+  pool.bytesLive += (sizeClass + 1) * EventPool::GRANULARITY;
+
+  EventPool::FreeBlock *block = pool.freeLists[sizeClass];
+  if (block != 0)
+    {
+      pool.freeLists[sizeClass] = block->next;
+      pool.nRecycled++;
+      return block;
+    }
+  return ::operator new ((sizeClass + 1) * EventPool::GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  EventPool &pool = GetEventPool ();
+  uint32_t sizeClass = (size - 1) / EventPool::GRANULARITY;
+  if (!pool.IsOwner ())
+    {
+      if (sizeClass >= EventPool::NCLASSES)
+        {
+          pool.CountForeign (0, -(int64_t)size);
+        }
+      else
+        {
+          pool.CountForeign (0, -(int64_t)((sizeClass + 1) * EventPool::GRANULARITY));
+        }
+      ::operator delete (p);
+      return;
+    }
+
+  if (sizeClass >= EventPool::NCLASSES)
+    {
+      pool.bytesLive -= size;
+      ::operator delete (p);
+      return;
+    }
+  pool.bytesLive -= (sizeClass + 1) * EventPool::GRANULARITY;
+
+  EventPool::FreeBlock *block = static_cast<EventPool::FreeBlock *> (p);
+  block->next = pool.freeLists[sizeClass];
+  pool.freeLists[sizeClass] = block;
+}
+
+uint64_t
+EventImpl::GetNAllocated (void)
+{
+  EventPool &pool = GetEventPool ();
+  uint64_t n, bytes;
+  pool.GetForeign (&n, &bytes);
+  return pool.nAllocated + n;
+}
+
+uint64_t
+EventImpl::GetNRecycled (void)
+{
+  return GetEventPool ().nRecycled;
+}
+
+uint64_t
+EventImpl::GetBytesLive (void)
+{
+  EventPool &pool = GetEventPool ();
+  uint64_t n, bytes;
+  pool.GetForeign (&n, &bytes);
+  return pool.bytesLive + bytes;
+}
+
+void
+EventImpl::BindToCurrentThread (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+#ifdef HAVE_PTHREAD_H
+  GetEventPool ().owner = pthread_self ();
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+EventImpl::ReleaseFreeLists (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  EventPool &pool = GetEventPool ();
+  if (!pool.IsOwner ())
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < EventPool::NCLASSES; i++)
+    {
+      while (pool.freeLists[i] != 0)
+        {
+          EventPool::FreeBlock *block = pool.freeLists[i];
+          pool.freeLists[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
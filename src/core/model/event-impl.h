@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 namespace ns3 {
@@ -58,6 +59,40 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Events are allocated from free lists of blocks of a few sizes,
+   * so that scheduling and running events rarely goes through malloc.
+   * Events made by threads other than the one running the simulation
+   * (as in real time emulation) bypass the free lists.
+   */
+  static void *operator new (std::size_t size);
+  static void operator delete (void *p, std::size_t size);
+
+  /**
+   * \returns the number of events allocated so far
+   */
+  static uint64_t GetNAllocated (void);
+  /**
+   * \returns the number of events allocated so far which reused
+   *          the memory of a deleted event
+   */
+  static uint64_t GetNRecycled (void);
+  /**
+   * \returns the number of bytes taken by the events which
+   *          have not been deleted yet
+   */
+  static uint64_t GetBytesLive (void);
+  /**
+   * Give back to the system the memory kept for allocating events.
+   */
+  static void ReleaseFreeLists (void);
+  /**
+   * Make the calling thread the one whose events go through the free
+   * lists.  Simulator implementations call this from the thread which
+   * runs the simulation.
+   */
+  static void BindToCurrentThread (void);
+
 protected:
   virtual void Notify (void) = 0;
 
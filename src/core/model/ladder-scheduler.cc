@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+static bool
+IsLater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomMax (0),
+    m_count (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_count++;
+
+  if (ev.key.m_ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = m_topMax = ev.key.m_ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ev.key.m_ts);
+          m_topMax = std::max (m_topMax, ev.key.m_ts);
+        }
+      m_top.push_back (ev);
+      return;
+    }
+
+  // the coarsest rung whose buckets still to come cover the event takes it
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ev.key.m_ts >= rung.start + rung.current * rung.width)
+        {
+          uint32_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.nBuckets);
+          rung.buckets[bucket].push_back (ev);
+          rung.count++;
+          return;
+        }
+    }
+
+  m_bottomMax = m_bottom.empty () ? ev.key.m_ts : std::max (m_bottomMax, ev.key.m_ts);
+  m_bottom.push_back (ev);
+  std::push_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+
+  // a crowded bottom is spread over a rung that reaches up to where the
+  // rungs above (or the top) take over, so that inserts stay cheap
+  if (m_bottom.size () > THRESHOLD && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottomMax)
+    {
+      uint64_t end = m_topStart;
+      if (m_nRungs > 0)
+        {
+          const Rung &rung = m_rungs[m_nRungs - 1];
+          end = rung.start + rung.current * rung.width;
+        }
+      uint64_t start = m_bottom.front ().key.m_ts;
+      NS_LOG_LOGIC ("spread " << m_bottom.size () << " events from the bottom");
+      SpawnRung (m_bottom, start, end - start);
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_count == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      // moving events down the ladder doesn't change what the queue holds
+      const_cast<LadderScheduler *> (this)->FillBottom ();
+    }
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      FillBottom ();
+    }
+  Scheduler::Event ev = m_bottom.front ();
+  std::pop_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+  m_bottom.pop_back ();
+  m_count--;
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  m_count--;
+
+  if (ev.key.m_ts <= m_bottomMax && RemoveFromBottom (ev))
+    {
+      return;
+    }
+
+  for (uint32_t r = 0; r < m_nRungs; r++)
+    {
+      Rung &rung = m_rungs[r];
+      if (ev.key.m_ts >= rung.start + rung.current * rung.width
+          && ev.key.m_ts < rung.start + rung.nBuckets * rung.width)
+        {
+          if (RemoveFrom (rung.buckets[(ev.key.m_ts - rung.start) / rung.width], ev))
+            {
+              rung.count--;
+              return;
+            }
+        }
+    }
+
+  bool found = RemoveFrom (m_top, ev);
+  NS_ASSERT (found);
+}
+
+bool
+LadderScheduler::RemoveFrom (Bucket &bucket, const Event &ev)
+{
+  for (Bucket::iterator i = bucket.begin (); i != bucket.end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          *i = bucket.back ();
+          bucket.pop_back ();
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+LadderScheduler::RemoveFromBottom (const Event &ev)
+{
+  uint32_t k = 0;
+  while (k < m_bottom.size () && m_bottom[k].key.m_uid != ev.key.m_uid)
+    {
+      k++;
+    }
+  if (k == m_bottom.size ())
+    {
+      return false;
+    }
+  NS_ASSERT (ev.impl == m_bottom[k].impl);
+  m_bottom[k] = m_bottom.back ();
+  m_bottom.pop_back ();
+  if (k == m_bottom.size ())
+    {
+      return true;
+    }
+
+  // the event moved into the hole goes up or down to its place
+  std::push_heap (m_bottom.begin (), m_bottom.begin () + k + 1, IsLater);
+  uint32_t n = m_bottom.size ();
+  while (2 * k + 1 < n)
+    {
+      uint32_t child = 2 * k + 1;
+      if (child + 1 < n && IsLater (m_bottom[child], m_bottom[child + 1]))
+        {
+          child++;
+        }
+      if (!IsLater (m_bottom[k], m_bottom[child]))
+        {
+          break;
+        }
+      std::swap (m_bottom[k], m_bottom[child]);
+      k = child;
+    }
+  return true;
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  while (m_bottom.empty ())
+    {
+      while (m_nRungs > 0 && m_rungs[m_nRungs - 1].count == 0)
+        {
+          m_nRungs--;
+        }
+
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          NS_LOG_LOGIC ("move " << m_top.size () << " events from the top");
+          if (m_top.size () <= THRESHOLD || m_topMin == m_topMax)
+            {
+              m_topStart = m_topMax + 1;
+              SortIntoBottom (m_top);
+            }
+          else
+            {
+              SpawnRung (m_top, m_topMin, m_topMax - m_topMin + 1);
+              const Rung &rung = m_rungs[0];
+              m_topStart = rung.start + rung.nBuckets * rung.width;
+            }
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = rung.start + rung.current * rung.width;
+      rung.current++;
+      rung.count -= bucket.size ();
+
+      if (bucket.size () > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          SpawnRung (bucket, bucketStart, rung.width);
+        }
+      else
+        {
+          SortIntoBottom (bucket);
+        }
+    }
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &events, uint64_t start, uint64_t span)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << span);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+
+  // about one event per bucket
+  uint64_t n = events.size ();
+  rung.width = std::max ((span + n - 1) / n, (uint64_t)1);
+  rung.nBuckets = (span + rung.width - 1) / rung.width;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  rung.start = start;
+  rung.current = 0;
+  rung.count = n;
+
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - start) / rung.width].push_back (*i);
+    }
+  ReleaseEvents (events);
+}
+
+void
+LadderScheduler::SortIntoBottom (Bucket &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  NS_ASSERT (m_bottom.empty ());
+  m_bottom.swap (events);
+  ReleaseEvents (events);
+  std::make_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+  m_bottomMax = 0;
+  for (Bucket::const_iterator i = m_bottom.begin (); i != m_bottom.end (); ++i)
+    {
+      m_bottomMax = std::max (m_bottomMax, i->key.m_ts);
+    }
+}
+
+void
+LadderScheduler::ReleaseEvents (Bucket &events)
+{
+  // the top is refilled all the time, but the memory of every other
+  // bucket is given back, else the rungs would keep the capacity of
+  // each of their buckets at its peak
+  if (&events == &m_top)
+    {
+      events.clear ();
+    }
+  else
+    {
+      Bucket ().swap (events);
+    }
+}
+
+} // namespace ns3
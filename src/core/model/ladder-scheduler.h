@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in "Ladder Queue:
+ * An O(1) Priority Queue Structure for Large-Scale Discrete Event Simulation"
+ * by Tang, Goh and Thng (2005). Events far in the future are appended, unsorted,
+ * to the top. When the near future runs out, the top is spread over the buckets
+ * of a rung, and the next non-empty bucket is moved into the bottom, from which
+ * events are dequeued. Buckets that are too crowded to sort cheaply are spread
+ * over a finer rung instead, so that only small batches of events ever get sorted.
+ * Once there is no rung left to spread them over, crowded buckets are moved
+ * into the bottom whole, which is a binary heap rather than the sorted list of
+ * the paper so that inserting into it stays O(log n) then.
+ *
+ * Unlike the calendar queue, no resizing heuristic is needed: every rung is
+ * sized for the events it receives, which gives O(1) amortized insertion and
+ * removal for most event time distributions.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  struct Rung
+  {
+    std::vector<Bucket> buckets; // may hold more than nBuckets, kept for reuse
+    uint32_t nBuckets;
+    uint64_t start;              // timestamp at the start of the first bucket
+    uint64_t width;              // timestamps covered by each bucket
+    uint32_t current;            // first bucket not yet moved down the ladder
+    uint32_t count;              // events left in the rung
+  };
+
+  /* moves events down the ladder until the bottom holds the next events */
+  void FillBottom (void);
+  /* spreads the events, which lie in [start, start + span), over a new rung */
+  void SpawnRung (Bucket &events, uint64_t start, uint64_t span);
+  /* moves the events into the (empty) bottom */
+  void SortIntoBottom (Bucket &events);
+  /* empties the events moved elsewhere */
+  void ReleaseEvents (Bucket &events);
+  static bool RemoveFrom (Bucket &bucket, const Event &ev);
+  /* removes the event from the bottom if it is there, keeping the heap */
+  bool RemoveFromBottom (const Event &ev);
+
+  // buckets with more events than this are spread over a new rung rather than sorted
+  static const uint32_t THRESHOLD = 50;
+  static const uint32_t MAX_RUNGS = 8;
+
+  Bucket m_top;
+  uint64_t m_topStart; // events at or after this go to the top
+  uint64_t m_topMin;
+  uint64_t m_topMax;
+  std::vector<Rung> m_rungs;
+  uint32_t m_nRungs;
+  Bucket m_bottom;     // a binary heap, so the next event is at the front
+  uint64_t m_bottomMax; // no lower than the latest timestamp in the bottom
+  uint32_t m_count;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -22,13 +22,42 @@
 #include "trace-source-accessor.h"
 #include "attribute-construction-list.h"
 #include "string.h"
-#include "ns3/core-config.h"
-#ifdef HAVE_STDLIB_H
-#include <cstdlib>
-#endif
+#include "singleton.h"
+#include <vector>
 
 NS_LOG_COMPONENT_DEFINE ("ObjectBase");
 
+namespace {
+
+/**
+ * The plans used to construct each type of object without any attribute
+ * value, as CreateObject does, indexed by TypeId uid.
+ */
+class DefaultPlans
+{
+public:
+  ns3::Ptr<const ns3::AttributeConstructionPlan> Get (ns3::TypeId tid);
+private:
+  std::vector<ns3::Ptr<const ns3::AttributeConstructionPlan> > m_plans;
+};
+
+ns3::Ptr<const ns3::AttributeConstructionPlan>
+DefaultPlans::Get (ns3::TypeId tid)
+{
+  uint16_t uid = tid.GetUid ();
+  if (uid >= m_plans.size ())
+    {
+      m_plans.resize (uid + 1);
+    }
+  if (m_plans[uid] == 0 || !m_plans[uid]->IsUpToDate ())
+    {
+      m_plans[uid] = ns3::Create<ns3::AttributeConstructionPlan> (tid, ns3::AttributeConstructionList ());
+    }
+  return m_plans[uid];
+}
+
+} // anonymous namespace
+
 namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (ObjectBase);
@@ -64,80 +93,44 @@ ObjectBase::NotifyConstructionCompleted (void)
 void
 ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
-  // loop over the inheritance tree back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
   TypeId tid = GetInstanceTypeId ();
-  do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+  if (attributes.Begin () == attributes.End ())
+    {
+      ConstructSelf (*Singleton<DefaultPlans>::Get ()->Get (tid));
+    }
+  else
+    {
+      ConstructSelf (AttributeConstructionPlan (tid, attributes));
+    }
+}
+
+void
+ObjectBase::ConstructSelf (const AttributeConstructionPlan &plan)
+{
+  NS_LOG_FUNCTION (this << &plan);
+  NS_ASSERT (plan.GetTypeId () == GetInstanceTypeId ());
+  for (AttributeConstructionPlan::CIterator step = plan.Begin (); step != plan.End (); step++)
+    {
+      // try the values in turn, from the most specific to the initial value
+      for (std::vector<struct AttributeConstructionPlan::Value>::const_iterator value = step->values.begin ();
+           value != step->values.end (); value++)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+          bool ok;
+          if (value->valid)
             {
-              continue;
+              ok = step->accessor->Set (this, *value->value);
             }
-          bool found = false;
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          if (value != 0)
+          else
             {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
-                  found = true;
-                  continue;
-                }
-            }              
-          if (!found)
-            {
-              // No matching attribute value so we try to look at the env var.
-#ifdef HAVE_GETENV
-              char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-              if (envVar != 0)
-                {
-                  std::string env = std::string (envVar);
-                  std::string::size_type cur = 0;
-                  std::string::size_type next = 0;
-                  while (next != std::string::npos)
-                    {
-                      next = env.find (";", cur);
-                      std::string tmp = std::string (env, cur, next-cur);
-                      std::string::size_type equal = tmp.find ("=");
-                      if (equal != std::string::npos)
-                        {
-                          std::string name = tmp.substr (0, equal);
-                          std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                          if (name == tid.GetAttributeFullName (i))
-                            {
-                              if (DoSet (info.accessor, info.checker, StringValue (value)))
-                                {
-                                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                                info.name <<"\" from env var");
-                                  found = true;
-                                  break;
-                                }
-                            }
-                        }
-                      cur = next + 1;
-                    }
-                }
-#endif /* HAVE_GETENV */
+              ok = DoSet (step->accessor, step->checker, *value->value);
             }
-          if (!found)
+          if (ok)
             {
-              // No matching attribute value so we try to set the default value.
-              DoSet (info.accessor, info.checker, *info.initialValue);
-              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                            info.name <<"\" from initial value.");
+              break;
             }
         }
-      tid = tid.GetParent ();
-    } while (tid != ObjectBase::GetTypeId ());
+    }
   NotifyConstructionCompleted ();
 }
 
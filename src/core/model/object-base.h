@@ -41,6 +41,7 @@
 namespace ns3 {
 
 class AttributeConstructionList;
+class AttributeConstructionPlan;
 
 /**
  * \ingroup object
@@ -150,6 +151,15 @@ protected:
    * your most-derived constructor.
    */
   void ConstructSelf (const AttributeConstructionList &attributes);
+  /**
+   * \param plan the attribute values used to initialize the member
+   *        variables of this object's instance, already resolved against
+   *        its TypeId.
+   *
+   * Same as ConstructSelf (const AttributeConstructionList &), for
+   * callers which construct many objects from the same attributes.
+   */
+  void ConstructSelf (const AttributeConstructionPlan &plan);
 
 private:
   bool DoSet (Ptr<const AttributeAccessor> spec,
@@ -41,18 +41,21 @@ ObjectFactory::SetTypeId (TypeId tid)
 {
   NS_LOG_FUNCTION (this << tid.GetName ());
   m_tid = tid;
+  m_plan = 0;
 }
 void
 ObjectFactory::SetTypeId (std::string tid)
 {
   NS_LOG_FUNCTION (this << tid);
   m_tid = TypeId::LookupByName (tid);
+  m_plan = 0;
 }
 void
 ObjectFactory::SetTypeId (const char *tid)
 {
   NS_LOG_FUNCTION (this << tid);
   m_tid = TypeId::LookupByName (tid);
+  m_plan = 0;
 }
 void
 ObjectFactory::Set (std::string name, const AttributeValue &value)
@@ -76,6 +79,7 @@ ObjectFactory::Set (std::string name, const AttributeValue &value)
       return;
     }
   m_parameters.Add (name, info.checker, value.Copy ());
+  m_plan = 0;
 }
 
 TypeId 
@@ -89,11 +93,15 @@ Ptr<Object>
 ObjectFactory::Create (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_plan == 0 || !m_plan->IsUpToDate ())
+    {
+      m_plan = Ptr<const AttributeConstructionPlan> (new AttributeConstructionPlan (m_tid, m_parameters), false);
+    }
   Callback<ObjectBase *> cb = m_tid.GetConstructor ();
   ObjectBase *base = cb ();
   Object *derived = dynamic_cast<Object *> (base);
   derived->SetTypeId (m_tid);
-  derived->Construct (m_parameters);
+  derived->Construct (*m_plan);
   Ptr<Object> object = Ptr<Object> (derived, false);
   return object;
 }
@@ -177,6 +185,7 @@ std::istream & operator >> (std::istream &is, ObjectFactory &factory)
               else
                 {
                   factory.m_parameters.Add (name, info.checker, val);
+                  factory.m_plan = 0;
                 }
             }
         }
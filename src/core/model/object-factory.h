@@ -34,7 +34,10 @@ class AttributeValue;
  * \brief instantiate subclasses of ns3::Object.
  *
  * This class can also hold a set of attributes to set
- * automatically during the object construction.
+ * automatically during the object construction.  They are
+ * resolved into an AttributeConstructionPlan on the first
+ * call to Create, which later calls reuse until the TypeId
+ * or the attributes change.
  */
 class ObjectFactory
 {
@@ -86,6 +89,7 @@ private:
 
   TypeId m_tid;
   AttributeConstructionList m_parameters;
+  mutable Ptr<const AttributeConstructionPlan> m_plan;
 };
 
 std::ostream & operator << (std::ostream &os, const ObjectFactory &factory);
@@ -121,6 +121,24 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     }
   return true;
 }
+bool
+ObjectPtrContainerAccessor::GetN (const ObjectBase *object, uint32_t *n) const
+{
+  NS_LOG_FUNCTION (this << object << n);
+  return DoGetN (object, n);
+}
+Ptr<Object>
+ObjectPtrContainerAccessor::GetItem (const ObjectBase *object, uint32_t i, uint32_t *index) const
+{
+  NS_LOG_FUNCTION (this << object << i << index);
+  return DoGet (object, i, index);
+}
+bool
+ObjectPtrContainerAccessor::IsIndexedByPosition (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
 bool 
 ObjectPtrContainerAccessor::HasGetter (void) const
 {
@@ -139,6 +139,29 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * \param object the object which holds the container
+   * \param n the number of items in the container
+   * \returns false if object does not hold this container
+   */
+  bool GetN (const ObjectBase *object, uint32_t *n) const;
+  /**
+   * \param object the object which holds the container
+   * \param i the position of the requested item in the container, in [0,n[
+   * \param index the index under which the item is known in
+   *        ObjectPtrContainerValue and in Config paths
+   * \returns the requested item
+   *
+   * Unlike Get, this does not copy the whole container.
+   */
+  Ptr<Object> GetItem (const ObjectBase *object, uint32_t i, uint32_t *index) const;
+  /**
+   * \returns true if the index of every item is its position in the
+   *          container, as in object vectors, so that the item known
+   *          under index i can be found with GetItem (object, i, ...).
+   *          Object maps, indexed by key, return false.
+   */
+  virtual bool IsIndexedByPosition (void) const;
 private:
   virtual bool DoGetN (const ObjectBase *object, uint32_t *n) const = 0;
   virtual Ptr<Object> DoGet (const ObjectBase *object, uint32_t i, uint32_t *index) const = 0;
@@ -165,6 +188,9 @@ MakeObjectPtrContainerAccessor (Ptr<U> (T::*get)(INDEX) const,
       *index = i;
       return (obj->*m_get)(i);
     }
+    virtual bool IsIndexedByPosition (void) const {
+      return true;
+    }
     Ptr<U> (T::*m_get)(INDEX) const;
     INDEX (T::*m_getN)(void) const;
   } *spec = new MemberGetters ();
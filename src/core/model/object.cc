@@ -140,6 +140,12 @@ Object::Construct (const AttributeConstructionList &attributes)
   NS_LOG_FUNCTION (this << &attributes);
   ConstructSelf (attributes);
 }
+void
+Object::Construct (const AttributeConstructionPlan &plan)
+{
+  NS_LOG_FUNCTION (this << &plan);
+  ConstructSelf (plan);
+}
 
 Ptr<Object>
 Object::DoGetObject (TypeId tid) const
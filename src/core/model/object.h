@@ -281,6 +281,13 @@ private:
   * registered with the associated TypeId.
   */
   void Construct (const AttributeConstructionList &attributes);
+  /**
+   * \param plan the attribute values used to initialize the member
+   *        variables of this object's instance, resolved against its TypeId.
+   *
+   * Invoked from ns3::ObjectFactory::Create only.
+   */
+  void Construct (const AttributeConstructionPlan &plan);
 
   void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
   /**
@@ -57,4 +57,10 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+void RngSeedManager::ResetNextStreamIndex (uint64_t next)
+{
+  NS_LOG_FUNCTION (next);
+  g_nextStreamIndex = next;
+}
+
 } // namespace ns3
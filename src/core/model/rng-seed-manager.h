@@ -62,6 +62,17 @@ public:
 
   static uint64_t GetNextStreamIndex(void);
 
+  /**
+   * \brief Restart the stream numbering at the given index
+   * \param next the index that the next call to GetNextStreamIndex will return
+   *
+   * Together with SetSeed and SetRun, this allows a program that performs
+   * several independent runs in one process to give each run exactly the
+   * same random variable streams, regardless of how many variables were
+   * created by the runs that preceded it.
+   */
+  static void ResetNextStreamIndex (uint64_t next);
+
 };
 
 // for compatibility
@@ -137,6 +137,8 @@ Simulator::Destroy (void)
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
+  // the memory of the events of this simulation is no longer needed
+  EventImpl::ReleaseFreeLists ();
 }
 
 void
@@ -316,6 +318,24 @@ Simulator::GetSystemId (void)
     }
 }
 
+uint64_t
+Simulator::GetEventsAllocated (void)
+{
+  return EventImpl::GetNAllocated ();
+}
+
+uint64_t
+Simulator::GetEventsRecycled (void)
+{
+  return EventImpl::GetNRecycled ();
+}
+
+uint64_t
+Simulator::GetEventBytesLive (void)
+{
+  return EventImpl::GetBytesLive ();
+}
+
 void
 Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 {
@@ -790,6 +790,24 @@ public:
    *          MPI or other distributed simulations
    */
   static uint32_t GetSystemId (void);
+
+  /**
+   * \returns the number of events allocated so far, whether scheduled
+   *          or not
+   */
+  static uint64_t GetEventsAllocated (void);
+
+  /**
+   * \returns the number of events allocated so far which reused the
+   *          memory of an event that had already been run or cancelled
+   */
+  static uint64_t GetEventsRecycled (void);
+
+  /**
+   * \returns the number of bytes taken by the events which are still
+   *          referenced, by the simulator or by EventIds
+   */
+  static uint64_t GetEventBytesLive (void);
 private:
   Simulator ();
   ~Simulator ();
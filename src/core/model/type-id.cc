@@ -21,6 +21,7 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 #include "log.h"
+#include "sgi-hashmap.h"
 #include <vector>
 #include <sstream>
 
@@ -32,6 +33,22 @@ NS_LOG_COMPONENT_DEFINE ("TypeID");
 
 namespace {
 
+/**
+ * FNV-1a hash of the type, attribute and trace source names.
+ */
+struct NameHash
+{
+  size_t operator () (const std::string &name) const
+  {
+    uint32_t hash = 2166136261U;
+    for (std::string::const_iterator c = name.begin (); c != name.end (); c++)
+      {
+        hash = (hash ^ (uint8_t)*c) * 16777619U;
+      }
+    return hash;
+  }
+};
+
 class IidManager
 {
 public:
@@ -68,11 +85,27 @@ public:
   uint32_t GetTraceSourceN (uint16_t uid) const;
   struct ns3::TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, uint32_t i) const;
   bool MustHideFromDocumentation (uint16_t uid) const;
+  uint32_t GetGeneration (void) const;
+  bool LookupAttribute (uint16_t uid, const std::string &name,
+                        struct ns3::TypeId::AttributeInformation *info) const;
+  ns3::Ptr<const ns3::TraceSourceAccessor> LookupTraceSource (uint16_t uid, const std::string &name) const;
 
 private:
   bool HasTraceSource (uint16_t uid, std::string name);
   bool HasAttribute (uint16_t uid, std::string name);
 
+  /**
+   * Where an attribute or a trace source visible from a type was
+   * registered: the type itself or one of its parents, and its index
+   * in that type's list.
+   */
+  struct Location {
+    uint16_t uid;
+    uint32_t index;
+  };
+  typedef sgi::hash_map<std::string, struct Location, NameHash> LocationMap;
+  typedef sgi::hash_map<std::string, uint16_t, NameHash> UidMap;
+
   struct IidInformation {
     std::string name;
     uint16_t parent;
@@ -82,15 +115,27 @@ private:
     bool mustHideFromDocumentation;
     std::vector<struct ns3::TypeId::AttributeInformation> attributes;
     std::vector<struct ns3::TypeId::TraceSourceInformation> traceSources;
+    // Attributes and trace sources of this type and all its parents, by
+    // name; valid while indexGeneration matches m_generation.
+    uint32_t indexGeneration;
+    LocationMap attributeIndex;
+    LocationMap traceSourceIndex;
   };
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
 
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  struct IidManager::IidInformation *LookupIndexedInformation (uint16_t uid) const;
 
   std::vector<struct IidInformation> m_information;
+  UidMap m_uids;
+  // Bumped by every change to a parent, an attribute (or its initial
+  // value) or a trace source, which may affect the flattened indices of
+  // any type below it and the caches built from them.
+  uint32_t m_generation;
 };
 
 IidManager::IidManager ()
+  : m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -99,15 +144,10 @@ uint16_t
 IidManager::AllocateUid (std::string name)
 {
   NS_LOG_FUNCTION (this << name);
-  uint16_t j = 1;
-  for (Iterator i = m_information.begin (); i != m_information.end (); i++)
+  if (m_uids.find (name) != m_uids.end ())
     {
-      if (i->name == name)
-        {
-          NS_FATAL_ERROR ("Trying to allocate twice the same uid: " << name);
-          return 0;
-        }
-      j++;
+      NS_FATAL_ERROR ("Trying to allocate twice the same uid: " << name);
+      return 0;
     }
   struct IidInformation information;
   information.name = name;
@@ -115,9 +155,11 @@ IidManager::AllocateUid (std::string name)
   information.groupName = "";
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.indexGeneration = 0;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
+  m_uids[name] = uid;
   return uid;
 }
 
@@ -129,6 +171,47 @@ IidManager::LookupInformation (uint16_t uid) const
   return const_cast<struct IidInformation *> (&m_information[uid-1]);
 }
 
+/**
+ * Return the information of uid with its attribute and trace source
+ * indices up to date, rebuilding them from the type and its parents
+ * (the nearest registration of a name wins) if anything changed since.
+ */
+struct IidManager::IidInformation *
+IidManager::LookupIndexedInformation (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->indexGeneration == m_generation)
+    {
+      return information;
+    }
+  information->attributeIndex.clear ();
+  information->traceSourceIndex.clear ();
+  uint16_t current = uid;
+  while (true)
+    {
+      struct IidInformation *ancestor = LookupInformation (current);
+      struct Location location;
+      location.uid = current;
+      for (location.index = 0; location.index < ancestor->attributes.size (); location.index++)
+        {
+          information->attributeIndex.insert (std::make_pair (ancestor->attributes[location.index].name, location));
+        }
+      for (location.index = 0; location.index < ancestor->traceSources.size (); location.index++)
+        {
+          information->traceSourceIndex.insert (std::make_pair (ancestor->traceSources[location.index].name, location));
+        }
+      if (ancestor->parent == current)
+        {
+          // top of inheritance tree
+          break;
+        }
+      current = ancestor->parent;
+    }
+  information->indexGeneration = m_generation;
+  return information;
+}
+
 void 
 IidManager::SetParent (uint16_t uid, uint16_t parent)
 {
@@ -136,6 +219,7 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  m_generation++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -169,17 +253,12 @@ uint16_t
 IidManager::GetUid (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  uint32_t j = 1;
-  for (Iterator i = m_information.begin (); i != m_information.end (); i++)
+  UidMap::const_iterator i = m_uids.find (name);
+  if (i == m_uids.end ())
     {
-      if (i->name == name)
-        {
-          NS_ASSERT (j <= 0xffff);
-          return j;
-        }
-      j++;
+      return 0;
     }
-  return 0;
+  return i->second;
 }
 std::string 
 IidManager::GetName (uint16_t uid) const
@@ -289,6 +368,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  m_generation++;
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -299,6 +379,7 @@ IidManager::SetAttributeInitialValue(uint16_t uid,
   struct IidInformation *information = LookupInformation (uid);
   NS_ASSERT (i < information->attributes.size ());
   information->attributes[i].initialValue = initialValue;
+  m_generation++;
 }
 
 
@@ -365,6 +446,7 @@ IidManager::AddTraceSource (uint16_t uid,
   source.help = help;
   source.accessor = accessor;
   information->traceSources.push_back (source);
+  m_generation++;
 }
 uint32_t 
 IidManager::GetTraceSourceN (uint16_t uid) const
@@ -389,6 +471,41 @@ IidManager::MustHideFromDocumentation (uint16_t uid) const
   return information->mustHideFromDocumentation;
 }
 
+uint32_t
+IidManager::GetGeneration (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_generation;
+}
+
+bool
+IidManager::LookupAttribute (uint16_t uid, const std::string &name,
+                             struct ns3::TypeId::AttributeInformation *info) const
+{
+  NS_LOG_FUNCTION (this << uid << name << info);
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  LocationMap::const_iterator i = information->attributeIndex.find (name);
+  if (i == information->attributeIndex.end ())
+    {
+      return false;
+    }
+  *info = LookupInformation (i->second.uid)->attributes[i->second.index];
+  return true;
+}
+
+ns3::Ptr<const ns3::TraceSourceAccessor>
+IidManager::LookupTraceSource (uint16_t uid, const std::string &name) const
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  LocationMap::const_iterator i = information->traceSourceIndex.find (name);
+  if (i == information->traceSourceIndex.end ())
+    {
+      return 0;
+    }
+  return LookupInformation (i->second.uid)->traceSources[i->second.index].accessor;
+}
+
 } // anonymous namespace
 
 namespace ns3 {
@@ -445,26 +562,18 @@ TypeId::GetRegistered (uint32_t i)
   return TypeId (Singleton<IidManager>::Get ()->GetRegistered (i));
 }
 
+uint32_t
+TypeId::GetRegistryGeneration (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return Singleton<IidManager>::Get ()->GetGeneration ();
+}
+
 bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  return Singleton<IidManager>::Get ()->LookupAttribute (m_tid, name, info);
 }
 
 TypeId 
@@ -645,21 +754,7 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  return Singleton<IidManager>::Get ()->LookupTraceSource (m_tid, name);
 }
 
 uint16_t 
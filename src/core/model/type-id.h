@@ -94,6 +94,15 @@ public:
    * \returns the TypeId instance whose index is i.
    */
   static TypeId GetRegistered (uint32_t i);
+  /**
+   * \returns a number which changes whenever a parent, an attribute,
+   *          the initial value of an attribute or a trace source is
+   *          registered or changed on any TypeId.
+   *
+   * This allows the information derived from the TypeIds to be cached
+   * until it may be out of date.
+   */
+  static uint32_t GetRegistryGeneration (void);
 
   /**
    * \param name the name of the interface to construct.
@@ -27,6 +27,7 @@
 #include "ns3/singleton.h"
 #include "ns3/object.h"
 #include "ns3/object-vector.h"
+#include "ns3/object-map.h"
 #include "ns3/names.h"
 #include "ns3/pointer.h"
 #include "ns3/log.h"
@@ -46,6 +47,7 @@ public:
 
   void AddNodeA (Ptr<ConfigTestObject> a);
   void AddNodeB (Ptr<ConfigTestObject> b);
+  void AddNodeC (uint32_t key, Ptr<ConfigTestObject> c);
 
   void SetNodeA (Ptr<ConfigTestObject> a);
   void SetNodeB (Ptr<ConfigTestObject> b);
@@ -56,6 +58,7 @@ public:
 private:
   std::vector<Ptr<ConfigTestObject> > m_nodesA;
   std::vector<Ptr<ConfigTestObject> > m_nodesB;
+  std::map<uint32_t, Ptr<ConfigTestObject> > m_nodesC;
   Ptr<ConfigTestObject> m_nodeA;
   Ptr<ConfigTestObject> m_nodeB;
   int8_t m_a;
@@ -76,6 +79,10 @@ ConfigTestObject::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&ConfigTestObject::m_nodesB),
                    MakeObjectVectorChecker<ConfigTestObject> ())
+    .AddAttribute ("NodesC", "",
+                   ObjectMapValue (),
+                   MakeObjectMapAccessor (&ConfigTestObject::m_nodesC),
+                   MakeObjectMapChecker<ConfigTestObject> ())
     .AddAttribute ("NodeA", "",
                    PointerValue (),
                    MakePointerAccessor (&ConfigTestObject::m_nodeA),
@@ -126,6 +133,12 @@ ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
   m_nodesB.push_back (b);
 }
 
+void 
+ConfigTestObject::AddNodeC (uint32_t key, Ptr<ConfigTestObject> c)
+{
+  m_nodesC[key] = c;
+}
+
 int8_t 
 ConfigTestObject::GetA (void) const
 {
@@ -606,6 +619,128 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+// ===========================================================================
+// Test that the objects matched by a path follow the changes made to the
+// object graph, and that object maps are matched by key.
+// ===========================================================================
+class PathLookupConfigTestCase : public TestCase
+{
+public:
+  PathLookupConfigTestCase ();
+  virtual ~PathLookupConfigTestCase () {}
+
+  void Trace (int16_t oldValue, int16_t newValue) { m_count++; }
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_count;
+};
+
+PathLookupConfigTestCase::PathLookupConfigTestCase ()
+  : TestCase ("Check that repeated path lookups follow changes to the objects")
+{
+}
+
+void
+PathLookupConfigTestCase::DoRun (void)
+{
+  //
+  // Reach the objects by name, so that the root namespace objects of the
+  // other tests do not match.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("PathLookupRoot", root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  a->SetNodeB (b);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      b->AddNodeB (objects[i]);
+    }
+
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "Wrong number of matches");
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "Wrong number of matches when looked up again");
+
+  //
+  // Indices are matched in increasing order, however they are written
+  //
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/[2-3]|0|2");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/Names/PathLookupRoot/NodeA/NodeB/NodesB/0/", "Wrong first match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (1), "/Names/PathLookupRoot/NodeA/NodeB/NodesB/2/", "Wrong second match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (2), "/Names/PathLookupRoot/NodeA/NodeB/NodesB/3/", "Wrong third match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (2), objects[3], "Wrong object for index 3");
+
+  //
+  // An object added to a vector is found, although nothing told Config
+  //
+  objects.push_back (CreateObject<ConfigTestObject> ());
+  b->AddNodeB (objects[4]);
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 5, "Object added to the vector not matched");
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/[2-3]|0|2");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Object added to the vector wrongly matched");
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/4");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Object added to the vector not matched by index");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), objects[4], "Wrong object for index 4");
+
+  //
+  // Setting a Pointer attribute changes where the paths through it lead
+  //
+  Ptr<ConfigTestObject> c = CreateObject<ConfigTestObject> ();
+  c->AddNodeB (CreateObject<ConfigTestObject> ());
+  c->AddNodeB (CreateObject<ConfigTestObject> ());
+  a->SetAttribute ("NodeB", PointerValue (c));
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Pointer attribute change not seen");
+
+  //
+  // So does setting the pointer directly
+  //
+  a->SetNodeB (b);
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 5, "Direct pointer change not seen");
+
+  //
+  // Object maps are indexed by key, not by position
+  //
+  b->AddNodeC (1, CreateObject<ConfigTestObject> ());
+  b->AddNodeC (3, CreateObject<ConfigTestObject> ());
+  b->AddNodeC (7, objects[0]);
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesC/7");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Map item with a key beyond the map size not matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), objects[0], "Wrong object for key 7");
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesC/0|1");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Wrong number of map items matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/Names/PathLookupRoot/NodeA/NodeB/NodesC/1/", "Wrong map item matched");
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesC/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Wrong number of map items matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (2), "/Names/PathLookupRoot/NodeA/NodeB/NodesC/7/", "Map items not in key order");
+  matches = Config::LookupMatches ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/[3-9]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Range beyond the end of a vector not matched");
+
+  //
+  // Connect to several paths at once
+  //
+  std::vector<std::string> paths;
+  paths.push_back ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/0/Source");
+  paths.push_back ("/Names/PathLookupRoot/NodeA/NodeB/NodesB/3|4/Source");
+  paths.push_back ("/Names/PathLookupRoot/NodeA/NodeB/NodesC/7/Source");
+  Config::ConnectWithoutContext (paths, MakeCallback (&PathLookupConfigTestCase::Trace, this));
+  m_count = 0;
+  for (uint32_t i = 0; i < objects.size (); i++)
+    {
+      objects[i]->SetAttribute ("Source", IntegerValue (-2));
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_count, 4, "Wrong number of trace sources connected");
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -621,6 +756,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new RootNamespaceConfigTestCase);
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
+  AddTestCase (new PathLookupConfigTestCase);
 }
 
 static ConfigTestSuite configTestSuite;
@@ -21,6 +21,11 @@
 #include "ns3/test.h"
 #include "ns3/object.h"
 #include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/traced-value.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/assert.h"
 
 namespace {
@@ -89,10 +94,62 @@ public:
   }
 };
 
+class BaseC : public ns3::Object
+{
+public:
+  static ns3::TypeId GetTypeId (void) {
+    static ns3::TypeId tid = ns3::TypeId ("BaseC")
+      .SetParent (Object::GetTypeId ())
+      .HideFromDocumentation ()
+      .AddConstructor<BaseC> ()
+      .AddAttribute ("BaseValue", "help text",
+                     ns3::UintegerValue (1),
+                     ns3::MakeUintegerAccessor (&BaseC::m_baseValue),
+                     ns3::MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("BasePointer", "help text",
+                     ns3::StringValue ("BaseA"),
+                     ns3::MakePointerAccessor (&BaseC::m_basePointer),
+                     ns3::MakePointerChecker<BaseA> ())
+      .AddTraceSource ("BaseTrace", "help text",
+                       ns3::MakeTraceSourceAccessor (&BaseC::m_baseTrace));
+    return tid;
+  }
+  BaseC ()
+  {}
+  uint32_t m_baseValue;
+  ns3::Ptr<BaseA> m_basePointer;
+  uint32_t m_lateValue;
+  ns3::TracedValue<uint32_t> m_baseTrace;
+};
+
+class DerivedC : public BaseC
+{
+public:
+  static ns3::TypeId GetTypeId (void) {
+    static ns3::TypeId tid = ns3::TypeId ("DerivedC")
+      .SetParent (BaseC::GetTypeId ())
+      .HideFromDocumentation ()
+      .AddConstructor<DerivedC> ()
+      .AddAttribute ("DerivedValue", "help text",
+                     ns3::UintegerValue (2),
+                     ns3::MakeUintegerAccessor (&DerivedC::m_derivedValue),
+                     ns3::MakeUintegerChecker<uint32_t> ())
+      .AddTraceSource ("DerivedTrace", "help text",
+                       ns3::MakeTraceSourceAccessor (&DerivedC::m_derivedTrace));
+    return tid;
+  }
+  DerivedC ()
+  {}
+  uint32_t m_derivedValue;
+  ns3::TracedValue<uint32_t> m_derivedTrace;
+};
+
 NS_OBJECT_ENSURE_REGISTERED (BaseA);
 NS_OBJECT_ENSURE_REGISTERED (DerivedA);
 NS_OBJECT_ENSURE_REGISTERED (BaseB);
 NS_OBJECT_ENSURE_REGISTERED (DerivedB);
+NS_OBJECT_ENSURE_REGISTERED (BaseC);
+NS_OBJECT_ENSURE_REGISTERED (DerivedC);
 
 } // namespace anonymous
 
@@ -407,6 +464,143 @@ ObjectFactoryTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (a->GetObject<DerivedA> (), 0, "Unexpectedly able to work around C++ type system");
 }
 
+// ===========================================================================
+// Test case to make sure that an Object factory which creates many Objects
+// gives them the attribute values it currently holds.
+// ===========================================================================
+class ObjectFactoryPlanTestCase : public TestCase
+{
+public:
+  ObjectFactoryPlanTestCase ();
+  virtual ~ObjectFactoryPlanTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectFactoryPlanTestCase::ObjectFactoryPlanTestCase ()
+  : TestCase ("Check ObjectFactory attribute values across many Create calls")
+{
+}
+
+ObjectFactoryPlanTestCase::~ObjectFactoryPlanTestCase ()
+{
+}
+
+void
+ObjectFactoryPlanTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (DerivedC::GetTypeId ());
+  factory.Set ("BaseValue", StringValue ("5"));
+
+  //
+  // Every object gets the values from the factory, and the initial value of
+  // the other attributes.  Attributes holding an object get one each.
+  //
+  Ptr<DerivedC> a = factory.Create<DerivedC> ();
+  Ptr<DerivedC> b = factory.Create<DerivedC> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_baseValue, 5, "BaseValue not set from the factory");
+  NS_TEST_ASSERT_MSG_EQ (b->m_baseValue, 5, "BaseValue not set from the factory the second time");
+  NS_TEST_ASSERT_MSG_EQ (b->m_derivedValue, 2, "DerivedValue does not have its initial value");
+  NS_TEST_ASSERT_MSG_NE (a->m_basePointer, 0, "BasePointer not created");
+  NS_TEST_ASSERT_MSG_NE (b->m_basePointer, 0, "BasePointer not created the second time");
+  NS_TEST_ASSERT_MSG_NE (a->m_basePointer, b->m_basePointer, "Two objects share the object created for BasePointer");
+
+  //
+  // Changing the values held by the factory, or the initial values of the
+  // type, changes the objects created next.
+  //
+  factory.Set ("BaseValue", UintegerValue (6));
+  a = factory.Create<DerivedC> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_baseValue, 6, "BaseValue not updated after ObjectFactory::Set");
+
+  struct TypeId::AttributeInformation info;
+  DerivedC::GetTypeId ().LookupAttributeByName ("DerivedValue", &info);
+  uint32_t index = 0;
+  while (DerivedC::GetTypeId ().GetAttribute (index).name != "DerivedValue")
+    {
+      index++;
+    }
+  DerivedC::GetTypeId ().SetAttributeInitialValue (index, Create<UintegerValue> (9));
+  a = factory.Create<DerivedC> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_derivedValue, 9, "DerivedValue not updated after a new initial value");
+  a = CreateObject<DerivedC> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_derivedValue, 9, "DerivedValue not updated after a new initial value in CreateObject");
+  DerivedC::GetTypeId ().SetAttributeInitialValue (index, info.initialValue);
+  a = CreateObject<DerivedC> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_derivedValue, 2, "DerivedValue initial value not restored");
+}
+
+// ===========================================================================
+// Test case to make sure that types, attributes and trace sources are found
+// by name, including the ones inherited from a parent or registered late.
+// ===========================================================================
+class TypeIdLookupTestCase : public TestCase
+{
+public:
+  TypeIdLookupTestCase ();
+  virtual ~TypeIdLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TypeIdLookupTestCase::TypeIdLookupTestCase ()
+  : TestCase ("Check TypeId lookups by name")
+{
+}
+
+TypeIdLookupTestCase::~TypeIdLookupTestCase ()
+{
+}
+
+void
+TypeIdLookupTestCase::DoRun (void)
+{
+  TypeId tid;
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName ("DerivedC"), DerivedC::GetTypeId (), "Unable to look up DerivedC by name");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByNameFailSafe ("BaseC", &tid), true, "Unable to look up BaseC by name");
+  NS_TEST_ASSERT_MSG_EQ (tid, BaseC::GetTypeId (), "BaseC looked up as another type");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByNameFailSafe ("NoSuchType", &tid), false, "Found a type that was never registered");
+
+  //
+  // A type sees its own attributes and trace sources and those of its parents,
+  // but not those of its children.
+  //
+  struct TypeId::AttributeInformation info;
+  NS_TEST_ASSERT_MSG_EQ (DerivedC::GetTypeId ().LookupAttributeByName ("DerivedValue", &info), true, "DerivedValue not found");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "DerivedValue", "Wrong attribute found for DerivedValue");
+  NS_TEST_ASSERT_MSG_EQ (DerivedC::GetTypeId ().LookupAttributeByName ("BaseValue", &info), true, "BaseValue not found from DerivedC");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "BaseValue", "Wrong attribute found for BaseValue");
+  NS_TEST_ASSERT_MSG_EQ (BaseC::GetTypeId ().LookupAttributeByName ("DerivedValue", &info), false, "DerivedValue found from BaseC");
+  NS_TEST_ASSERT_MSG_EQ (DerivedC::GetTypeId ().LookupAttributeByName ("NoSuchValue", &info), false, "Found an attribute that was never registered");
+
+  NS_TEST_ASSERT_MSG_NE (DerivedC::GetTypeId ().LookupTraceSourceByName ("DerivedTrace"), 0, "DerivedTrace not found");
+  NS_TEST_ASSERT_MSG_NE (DerivedC::GetTypeId ().LookupTraceSourceByName ("BaseTrace"), 0, "BaseTrace not found from DerivedC");
+  NS_TEST_ASSERT_MSG_EQ (BaseC::GetTypeId ().LookupTraceSourceByName ("DerivedTrace"), 0, "DerivedTrace found from BaseC");
+
+  //
+  // An attribute added to a parent after its children were looked up must
+  // still be visible from them.
+  //
+  BaseC::GetTypeId ().AddAttribute ("LateValue", "help text",
+                                    UintegerValue (3),
+                                    MakeUintegerAccessor (&BaseC::m_lateValue),
+                                    MakeUintegerChecker<uint32_t> ());
+  NS_TEST_ASSERT_MSG_EQ (DerivedC::GetTypeId ().LookupAttributeByName ("LateValue", &info), true, "LateValue not found from DerivedC");
+
+  Ptr<DerivedC> c = CreateObject<DerivedC> ();
+  c->SetAttribute ("BaseValue", UintegerValue (7));
+  c->SetAttribute ("LateValue", UintegerValue (8));
+  UintegerValue value;
+  c->GetAttribute ("DerivedValue", value);
+  NS_TEST_ASSERT_MSG_EQ (value.Get (), 2, "DerivedValue does not have its initial value");
+  c->GetAttribute ("BaseValue", value);
+  NS_TEST_ASSERT_MSG_EQ (value.Get (), 7, "BaseValue was not set through DerivedC");
+  NS_TEST_ASSERT_MSG_EQ (c->m_lateValue, 8, "LateValue was not set through DerivedC");
+}
+
 // ===========================================================================
 // The Test Suite that glues the Test Cases together.
 // ===========================================================================
@@ -422,6 +616,8 @@ ObjectTestSuite::ObjectTestSuite ()
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
   AddTestCase (new ObjectFactoryTestCase);
+  AddTestCase (new ObjectFactoryPlanTestCase);
+  AddTestCase (new TypeIdLookupTestCase);
 }
 
 static ObjectTestSuite objectTestSuite;
@@ -23,6 +23,11 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include <map>
 
 using namespace ns3;
 
@@ -459,6 +464,287 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+private:
+  void Nothing (void);
+  virtual void DoRun (void);
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that run and cancelled events are recycled")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Nothing (void)
+{
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  // the simulator itself schedules events when created
+  Simulator::Now ();
+  uint64_t bytesLive = Simulator::GetEventBytesLive ();
+  uint64_t allocated = Simulator::GetEventsAllocated ();
+
+  Simulator::Schedule (Seconds (1.0), &SimulatorEventPoolTestCase::Nothing, this);
+  EventId cancelled = Simulator::Schedule (Seconds (2.0), &SimulatorEventPoolTestCase::Nothing, this);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventsAllocated (), allocated + 2, "Events not counted");
+  NS_TEST_EXPECT_MSG_GT (Simulator::GetEventBytesLive (), bytesLive, "Event memory not counted");
+
+  Simulator::Cancel (cancelled);
+  cancelled = EventId ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventBytesLive (), bytesLive, "Memory of run or cancelled events not given back");
+
+  uint64_t recycled = Simulator::GetEventsRecycled ();
+  Simulator::Schedule (Seconds (1.0), &SimulatorEventPoolTestCase::Nothing, this);
+  Simulator::Schedule (Seconds (2.0), &SimulatorEventPoolTestCase::Nothing, this);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventsRecycled (), recycled + 2, "Events not recycled");
+  Simulator::Destroy ();
+}
+
+class SimulatorCompactionTestCase : public TestCase
+{
+public:
+  SimulatorCompactionTestCase ();
+private:
+  void Run (uint32_t i);
+  virtual void DoRun (void);
+  std::vector<uint32_t> m_run;
+};
+
+SimulatorCompactionTestCase::SimulatorCompactionTestCase ()
+  : TestCase ("Check that cancelled events are compacted away")
+{
+}
+
+void
+SimulatorCompactionTestCase::Run (uint32_t i)
+{
+  m_run.push_back (i);
+}
+
+void
+SimulatorCompactionTestCase::DoRun (void)
+{
+  Ptr<DefaultSimulatorImpl> impl = CreateObject<DefaultSimulatorImpl> ();
+  impl->SetAttribute ("CompactCancelledFraction", DoubleValue (0.5));
+  impl->SetAttribute ("CompactMinEvents", UintegerValue (10));
+  Simulator::SetImplementation (impl);
+
+  std::vector<EventId> events;
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      events.push_back (Simulator::Schedule (Seconds (20 - i), &SimulatorCompactionTestCase::Run, this, i));
+    }
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Cancel (events[2 * i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNCompactions (), 0, "Compacted too early");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetMaxCancelledEvents (), 10, "Cancelled events not counted");
+  events.clear ();
+  Simulator::Cancel (Simulator::Schedule (Seconds (1.5), &SimulatorCompactionTestCase::Run, this, 20));
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNCompactions (), 1, "Not compacted");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNDeadEvents (), 11, "Cancelled events left in the event list");
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNExecutedEvents (), 10, "Wrong number of events run");
+  NS_TEST_EXPECT_MSG_EQ (m_run.size (), 10, "Wrong number of events run");
+  for (uint32_t i = 0; i < m_run.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_run[i], 19 - 2 * i, "Events run out of order");
+    }
+  Simulator::Destroy ();
+}
+
+class SchedulerStressTestCase : public TestCase
+{
+public:
+  SchedulerStressTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  uint64_t Random (uint64_t n);
+  uint64_t Delay (void);
+  void Insert (uint64_t ts);
+  bool RemoveNext (void);
+  bool Cancel (void);
+  ObjectFactory m_schedulerFactory;
+  Ptr<Scheduler> m_scheduler;
+  Ptr<Scheduler> m_reference;
+  std::map<uint32_t, uint64_t> m_pending; // timestamp of each pending event, by uid
+  uint64_t m_now;
+  uint32_t m_uid;
+  uint64_t m_seed;
+};
+
+SchedulerStressTestCase::SchedulerStressTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that " + schedulerFactory.GetTypeId ().GetName () +
+              " orders many skewed events like ns3::MapScheduler"),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+// a small generator of its own, so that the events are the same on every run
+uint64_t
+SchedulerStressTestCase::Random (uint64_t n)
+{
+  m_seed = m_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (m_seed >> 24) % n;
+}
+
+// mostly the near future, with a long tail reaching far ahead
+uint64_t
+SchedulerStressTestCase::Delay (void)
+{
+  uint64_t r = Random (100);
+  if (r < 70)
+    {
+      return Random (100);
+    }
+  else if (r < 90)
+    {
+      return Random (1000000);
+    }
+  else if (r < 98)
+    {
+      return Random (1000) << 30;
+    }
+  return (uint64_t)1 << (20 + Random (40));
+}
+
+void
+SchedulerStressTestCase::Insert (uint64_t ts)
+{
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  m_scheduler->Insert (ev);
+  m_reference->Insert (ev);
+  m_pending[ev.key.m_uid] = ts;
+}
+
+bool
+SchedulerStressTestCase::RemoveNext (void)
+{
+  Scheduler::Event expected = m_reference->RemoveNext ();
+  if (m_scheduler->PeekNext ().key.m_uid != expected.key.m_uid)
+    {
+      return false;
+    }
+  Scheduler::Event ev = m_scheduler->RemoveNext ();
+  m_now = ev.key.m_ts;
+  m_pending.erase (ev.key.m_uid);
+  return ev.key.m_uid == expected.key.m_uid && ev.key.m_ts == expected.key.m_ts;
+}
+
+bool
+SchedulerStressTestCase::Cancel (void)
+{
+  std::map<uint32_t, uint64_t>::iterator i = m_pending.lower_bound (Random (m_uid));
+  if (i == m_pending.end ())
+    {
+      return true;
+    }
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_ts = i->second;
+  ev.key.m_uid = i->first;
+  ev.key.m_context = 0;
+  m_pending.erase (i);
+  m_scheduler->Remove (ev);
+  m_reference->Remove (ev);
+  return m_scheduler->IsEmpty () == m_reference->IsEmpty ();
+}
+
+void
+SchedulerStressTestCase::DoRun (void)
+{
+  m_scheduler = m_schedulerFactory.Create<Scheduler> ();
+  m_reference = CreateObject<MapScheduler> ();
+  m_pending.clear ();
+  m_now = 0;
+  m_uid = 0;
+  m_seed = 1;
+
+  // a tight cluster of events and a few very late ones: splitting the
+  // cluster out of their span takes more rungs than a ladder has
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Insert (i);
+    }
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Insert ((uint64_t)1 << 62);
+    }
+  // and more of the near future arrives while the cluster is dequeued
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (RemoveNext (), true, "Events out of order while splitting a cluster");
+      for (uint32_t j = 0; j < 4; j++)
+        {
+          Insert (m_now + Random (10));
+        }
+    }
+
+  // the queue grows and shrinks repeatedly, with bursts of simultaneous
+  // events and cancellations mixed in
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      while (m_pending.size () < 20000)
+        {
+          uint64_t r = Random (100);
+          if (r < 70 || m_pending.empty ())
+            {
+              Insert (m_now + Delay ());
+            }
+          else if (r < 71)
+            {
+              uint64_t ts = m_now + Delay ();
+              for (uint32_t i = 0; i < 200; i++)
+                {
+                  Insert (ts);
+                }
+            }
+          else if (r < 90)
+            {
+              NS_TEST_ASSERT_MSG_EQ (RemoveNext (), true, "Events out of order while the queue grows");
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (Cancel (), true, "Event not cancelled while the queue grows");
+            }
+        }
+      while (!m_pending.empty ())
+        {
+          uint64_t r = Random (100);
+          if (r < 20)
+            {
+              Insert (m_now + Delay ());
+            }
+          else if (r < 90)
+            {
+              NS_TEST_ASSERT_MSG_EQ (RemoveNext (), true, "Events out of order while the queue shrinks");
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (Cancel (), true, "Event not cancelled while the queue shrinks");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), true, "Events left over");
+    }
+
+  m_scheduler = 0;
+  m_reference = 0;
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +761,11 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory));
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory));
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory));
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerStressTestCase (factory));
+    AddTestCase (new SimulatorEventPoolTestCase ());
+    AddTestCase (new SimulatorCompactionTestCase ());
   }
 } g_simulatorTestSuite;
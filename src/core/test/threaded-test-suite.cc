@@ -225,6 +225,69 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedEventAccountingTestCase : public TestCase
+{
+public:
+  ThreadedEventAccountingTestCase (const std::string &simulatorType);
+private:
+  static void SchedulingThread (ThreadedEventAccountingTestCase *self);
+  void Count (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  enum { N_EVENTS = 1000 };
+  std::string m_simulatorType;
+  uint32_t m_count;
+};
+
+ThreadedEventAccountingTestCase::ThreadedEventAccountingTestCase (const std::string &simulatorType)
+  : TestCase ("Check that events scheduled by other threads are accounted for with " + simulatorType),
+    m_simulatorType (simulatorType),
+    m_count (0)
+{
+}
+void
+ThreadedEventAccountingTestCase::SchedulingThread (ThreadedEventAccountingTestCase *self)
+{
+  for (uint32_t i = 0; i < N_EVENTS; ++i)
+    {
+      Simulator::ScheduleWithContext (uint32_t (-1), MicroSeconds (i),
+                                      &ThreadedEventAccountingTestCase::Count, self);
+    }
+}
+void
+ThreadedEventAccountingTestCase::Count (void)
+{
+  m_count++;
+}
+void
+ThreadedEventAccountingTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+void
+ThreadedEventAccountingTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (m_simulatorType));
+  // create the simulator, and so bind the events to this thread
+  Simulator::Now ();
+  uint64_t allocated = Simulator::GetEventsAllocated ();
+  uint64_t bytesLive = Simulator::GetEventBytesLive ();
+
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (
+      &ThreadedEventAccountingTestCase::SchedulingThread, this));
+  thread->Start ();
+  thread->Join ();
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_count, (uint32_t)N_EVENTS, "Lost events");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventsAllocated () - allocated, (uint64_t)N_EVENTS,
+                         "Events made by another thread not counted");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventBytesLive (), bytesLive,
+                         "Events made by another thread not accounted for when deleted");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -261,6 +324,7 @@ public:
                 AddTestCase (new ThreadedSimulatorEventsTestCase (factory, simulatorTypes[i], threadcounts[j]));
               }
           }
+        AddTestCase (new ThreadedEventAccountingTestCase (simulatorTypes[i]));
       }
   }
 } g_threadedSimulatorTestSuite;
@@ -227,11 +227,11 @@ CsmaChannel::TransmitEnd ()
     {
       if (it->IsActive ())
         {
-          // schedule reception events
+          // schedule reception events, which all share the packet
           Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
                                           m_delay,
                                           &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+                                          m_currentPkt, m_deviceList[m_currentSrc].devicePtr);
         }
       devId++;
     }
@@ -340,6 +340,17 @@ CsmaChannel::GetDevice (uint32_t i) const
   return GetCsmaDevice (i);
 }
 
+uint64_t
+CsmaChannel::GetNCopiesAvoided (void) const
+{
+  uint64_t ncopies = 0;
+  for (std::vector<CsmaDeviceRec>::const_iterator it = m_deviceList.begin (); it < m_deviceList.end (); it++)
+    {
+      ncopies += it->devicePtr->GetNCopiesAvoided ();
+    }
+  return ncopies;
+}
+
 CsmaDeviceRec::CsmaDeviceRec ()
 {
   active = false;
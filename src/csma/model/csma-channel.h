@@ -248,6 +248,13 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
+  /**
+   * \return Returns the number of packet copies that the devices on the
+   * channel avoided by sharing the packets sent, see
+   * CsmaNetDevice::GetNCopiesAvoided.
+   */
+  uint64_t GetNCopiesAvoided (void) const;
+
   /**
    * \return Get a CsmaNetDevice pointer to a connected network device.
    *
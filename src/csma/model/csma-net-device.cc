@@ -153,7 +153,8 @@ CsmaNetDevice::GetTypeId (void)
 }
 
 CsmaNetDevice::CsmaNetDevice ()
-  : m_linkUp (false)
+  : m_linkUp (false),
+    m_nCopiesAvoided (0)
 {
   NS_LOG_FUNCTION (this);
   m_txMachineState = READY;
@@ -650,10 +651,10 @@ CsmaNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 }
 
 void
-CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
+CsmaNetDevice::Receive (Ptr<const Packet> originalPacket, Ptr<CsmaNetDevice> senderDevice)
 {
-  NS_LOG_FUNCTION (packet << senderDevice);
-  NS_LOG_LOGIC ("UID is " << packet->GetUid ());
+  NS_LOG_FUNCTION (originalPacket << senderDevice);
+  NS_LOG_LOGIC ("UID is " << originalPacket->GetUid ());
 
   //
   // We never forward up packets that we sent.  Real devices don't do this since
@@ -661,6 +662,7 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // 
   if (senderDevice == this)
     {
+      m_nCopiesAvoided++;
       return;
     }
 
@@ -668,29 +670,32 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // Hit the trace hook.  This trace will fire on all packets received from the
   // channel except those originated by this device.
   //
-  m_phyRxEndTrace (packet);
+  m_phyRxEndTrace (originalPacket);
 
   // 
   // Only receive if the send side of net device is enabled
   //
   if (IsReceiveEnabled () == false)
     {
-      m_phyRxDropTrace (packet);
+      m_phyRxDropTrace (originalPacket);
+      m_nCopiesAvoided++;
       return;
     }
 
+  //
+  // The packet is shared with the other devices on the channel, and trace
+  // sinks expect complete packets, not packets without some of the headers,
+  // so the headers are removed from a copy.
+  //
+  Ptr<Packet> packet = originalPacket->Copy ();
+
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
     {
       NS_LOG_LOGIC ("Dropping pkt due to error model ");
       m_phyRxDropTrace (packet);
       return;
     }
-
-  //
-  // Trace sinks will expect complete packets, not packets without some of the
-  // headers.
-  //
-  Ptr<Packet> originalPacket = packet->Copy ();
+  m_nCopiesAvoided++;
 
   EthernetTrailer trailer;
   packet->RemoveTrailer (trailer);
@@ -787,6 +792,12 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
     }
 }
 
+uint64_t
+CsmaNetDevice::GetNCopiesAvoided (void) const
+{
+  return m_nCopiesAvoided;
+}
+
 Ptr<Queue>
 CsmaNetDevice::GetQueue (void) const 
 { 
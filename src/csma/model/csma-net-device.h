@@ -156,11 +156,21 @@ public:
    * used by the channel to indicate that the last bit of a packet has 
    * arrived at the device.
    *
+   * The packet is shared with the other devices on the channel, so the
+   * device copies it before removing its headers.
+   *
    * \see CsmaChannel
    * \param p a reference to the received packet
    * \param sender the CsmaNetDevice that transmitted the packet in the first place
    */
-  void Receive (Ptr<Packet> p, Ptr<CsmaNetDevice> sender);
+  void Receive (Ptr<const Packet> p, Ptr<CsmaNetDevice> sender);
+
+  /**
+   * \returns the number of packet copies the device avoided by sharing the
+   * packets received with the other devices on the channel, rather than
+   * getting its own copy from the channel and another one for the traces
+   */
+  uint64_t GetNCopiesAvoided (void) const;
 
   /**
    * Is the send side of the network device enabled?
@@ -717,6 +727,11 @@ private:
    * Ethernet.
    */
   uint32_t m_mtu;
+
+  /**
+   * The number of packet copies avoided, see GetNCopiesAvoided.
+   */
+  uint64_t m_nCopiesAvoided;
 };
 
 } // namespace ns3
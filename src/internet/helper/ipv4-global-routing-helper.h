@@ -81,6 +81,10 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * If the GlobalRoutingIncremental global value is true and links only
+   * went down since the routes were last computed, only the nodes whose
+   * shortest paths crossed those links compute all their routes again.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
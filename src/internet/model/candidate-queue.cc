@@ -42,24 +42,38 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  // the heap is only partially ordered; show the vertices in the order
+  // they would be popped
+  std::vector<uint32_t> positions;
+  for (uint32_t i = 0; i < q.m_candidates.size (); i++)
+    {
+      positions.push_back (i);
+    }
+  for (uint32_t i = 1; i < positions.size (); i++)
+    {
+      for (uint32_t j = i; j > 0 && q.IsBefore (positions[j], positions[j - 1]); j--)
+        {
+          std::swap (positions[j], positions[j - 1]);
+        }
+    }
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-  for (CIter_t iter = list.begin (); iter != list.end (); iter++)
+  for (uint32_t i = 0; i < positions.size (); i++)
     {
+      SPFVertex *v = q.m_candidates[positions[i]].vertex;
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << v->GetVertexId () << ", "
+      << v->GetDistanceFromRoot () << ", "
+      << v->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_addresses (),
+    m_order (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -87,11 +101,13 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate candidate;
+  candidate.vertex = vNew;
+  candidate.order = m_order++;
+  m_candidates.push_back (candidate);
+  vNew->m_candidatePosition = m_candidates.size () - 1;
+  m_addresses.insert (std::make_pair (vNew->GetVertexId (), vNew));
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -103,8 +119,19 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  Swap (0, m_candidates.size () - 1);
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      SiftDown (0);
+    }
+
+  std::map<Ipv4Address, SPFVertex*>::iterator i = m_addresses.find (v->GetVertexId ());
+  if (i != m_addresses.end () && i->second == v)
+    {
+      m_addresses.erase (i);
+    }
   return v;
 }
 
@@ -117,7 +144,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -138,15 +165,10 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION_NOARGS ();
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::map<Ipv4Address, SPFVertex*>::const_iterator i = m_addresses.find (addr);
+  if (i != m_addresses.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return i->second;
     }
 
   return 0;
@@ -157,11 +179,91 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i-- > 0; )
+    {
+      SiftDown (i);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  uint32_t i = v->m_candidatePosition;
+  NS_ASSERT_MSG (i < m_candidates.size () && m_candidates[i].vertex == v,
+                 "CandidateQueue::Update (): vertex not in the queue");
+  m_candidates[i].order = m_order++;
+  SiftUp (i);
+  SiftDown (v->m_candidatePosition);
+}
+
+bool
+CandidateQueue::IsBefore (uint32_t i1, uint32_t i2) const
+{
+  const Candidate &c1 = m_candidates[i1];
+  const Candidate &c2 = m_candidates[i2];
+  if (CompareSPFVertex (c1.vertex, c2.vertex))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (c2.vertex, c1.vertex))
+    {
+      return false;
+    }
+  return c1.order < c2.order;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!IsBefore (i, parent))
+        {
+          break;
+        }
+      Swap (i, parent);
+      i = parent;
+    }
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  for (;;)
+    {
+      uint32_t first = i;
+      uint32_t left = 2 * i + 1;
+      uint32_t right = left + 1;
+      if (left < m_candidates.size () && IsBefore (left, first))
+        {
+          first = left;
+        }
+      if (right < m_candidates.size () && IsBefore (right, first))
+        {
+          first = right;
+        }
+      if (first == i)
+        {
+          break;
+        }
+      Swap (i, first);
+      i = first;
+    }
+}
+
+void
+CandidateQueue::Swap (uint32_t i1, uint32_t i2)
+{
+  std::swap (m_candidates[i1], m_candidates[i2]);
+  m_candidates[i1].vertex->m_candidatePosition = i1;
+  m_candidates[i2].vertex->m_candidatePosition = i2;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -43,8 +44,12 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * requirement for an Update () operation led us to implement this
+ * enhanced priority queue: a binary heap which knows the position of each
+ * of its vertices, so that a vertex whose distance decreased can be moved
+ * up in O(log n), plus an index of the vertices by address for Find ().
+ * Vertices of equal rank come out in the order they were pushed or last
+ * updated.
  */
 class CandidateQueue
 {
@@ -162,6 +167,22 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Moves a Shortest Path First Vertex pointer in the queue after its
+ * m_distanceFromRoot decreased.
+ * @internal
+ *
+ * This is the decrease-key operation of the priority queue, which is
+ * much cheaper than a Reorder () when a single distance changes.  The
+ * vertex ranks after the other vertices of the same distance and type,
+ * where a stable sort of a sorted list would put it too, so that routes
+ * over equal-cost paths are added in the same order as with a list.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex, which must be in the queue.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -189,8 +210,30 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t;
-  CandidateList_t m_candidates;
+/**
+ * \brief return true if v1 should be popped before v2, breaking the ties
+ * of CompareSPFVertex by the order the vertices were pushed or updated
+ */
+  bool IsBefore (uint32_t i1, uint32_t i2) const;
+
+/**
+ * \brief move the vertex at the given position of the heap up or down
+ * until the heap is ordered again
+ */
+  void SiftUp (uint32_t i);
+  void SiftDown (uint32_t i);
+  void Swap (uint32_t i1, uint32_t i2);
+
+  struct Candidate
+  {
+    SPFVertex *vertex;
+    uint32_t order;  // when the vertex was pushed or last updated
+  };
+
+  typedef std::vector<Candidate> CandidateList_t;
+  CandidateList_t m_candidates;                   // the heap
+  std::map<Ipv4Address, SPFVertex*> m_addresses;  // vertices by id, for Find ()
+  uint32_t m_order;
 
   friend std::ostream& operator<< (std::ostream& os, const CandidateQueue& q);
 };
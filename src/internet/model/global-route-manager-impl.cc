@@ -24,8 +24,10 @@
 
 #include <utility>
 #include <vector>
+#include <map>
 #include <queue>
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -35,6 +37,16 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <unistd.h>
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -44,6 +56,19 @@ NS_LOG_COMPONENT_DEFINE ("GlobalRouteManager");
 
 namespace ns3 {
 
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads running the SPF calculations "
+                                           "of the routers at once, or 0 for one per processor",
+                                           UintegerValue (1),
+                                           MakeUintegerChecker<uint32_t> ());
+
+static GlobalValue g_globalRoutingIncremental ("GlobalRoutingIncremental",
+                                               "Whether recomputing the routes after links went down "
+                                               "only runs the SPF calculation again for the routers "
+                                               "whose shortest paths used them",
+                                               BooleanValue (false),
+                                               MakeBooleanChecker ());
+
 std::ostream& 
 operator<< (std::ostream& os, const SPFVertex::NodeExit_t& exit)
 {
@@ -87,7 +112,8 @@ SPFVertex::SPFVertex () :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidatePosition (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -100,7 +126,8 @@ SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidatePosition (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -413,6 +440,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
+    m_linkDataIndex (),
+    m_sorted (true),
     m_extdatabase ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -421,7 +450,7 @@ GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
 GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  LSDBMap_t::iterator i;
+  LSDBVector_t::iterator i;
   for (i= m_database.begin (); i!= m_database.end (); i++)
     {
       NS_LOG_LOGIC ("free LSA");
@@ -442,7 +471,8 @@ void
 GlobalRouteManagerLSDB::Initialize ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  LSDBMap_t::iterator i;
+  Sort ();
+  LSDBVector_t::iterator i;
   for (i= m_database.begin (); i!= m_database.end (); i++)
     {
       GlobalRoutingLSA* temp = i->second;
@@ -460,8 +490,62 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      m_database.push_back (LSDBPair_t (addr, lsa));
+      m_sorted = false;
+    }
+}
+
+static bool
+CompareLSDBPair (const std::pair<Ipv4Address, GlobalRoutingLSA*> &p1,
+                 const std::pair<Ipv4Address, GlobalRoutingLSA*> &p2)
+{
+  return p1.first < p2.first;
+}
+
+void
+GlobalRouteManagerLSDB::Sort () const
+{
+  if (m_sorted)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION_NOARGS ();
+//
+// The database used to be a map, so like map::insert we keep the first LSA
+// inserted with a given link state ID and drop the later ones.
+//
+  std::stable_sort (m_database.begin (), m_database.end (), CompareLSDBPair);
+  LSDBVector_t::iterator last = m_database.begin ();
+  for (LSDBVector_t::iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      if (last != m_database.begin () && (last - 1)->first == i->first)
+        {
+          NS_LOG_LOGIC ("Dropping duplicate LSA " << i->first);
+          delete i->second;
+          continue;
+        }
+      *last++ = *i;
+    }
+  m_database.erase (last, m_database.end ());
+//
+// GetLSAByLinkData () returns the first LSA in database order with a
+// matching transit link record, so the index is stably sorted too.
+//
+  m_linkDataIndex.clear ();
+  for (LSDBVector_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* temp = i->second;
+      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              m_linkDataIndex.push_back (LSDBPair_t (lr->GetLinkData (), temp));
+            }
+        }
     }
+  std::stable_sort (m_linkDataIndex.begin (), m_linkDataIndex.end (), CompareLSDBPair);
+  m_sorted = true;
 }
 
 GlobalRoutingLSA*
@@ -476,6 +560,33 @@ GlobalRouteManagerLSDB::GetNumExtLSAs () const
   return m_extdatabase.size ();
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  Sort ();
+  return m_database.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  Sort ();
+  return m_database.at (index).second;
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetLSAIndex (Ipv4Address addr) const
+{
+  Sort ();
+  LSDBVector_t::const_iterator i = std::lower_bound (m_database.begin (), m_database.end (),
+                                                     LSDBPair_t (addr, 0), CompareLSDBPair);
+  if (i != m_database.end () && i->first == addr)
+    {
+      return i - m_database.begin ();
+    }
+  return SPF_INFINITY;
+}
+
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 {
@@ -483,13 +594,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  uint32_t index = GetLSAIndex (addr);
+  if (index != SPF_INFINITY)
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return m_database[index].second;
     }
   return 0;
 }
@@ -499,26 +607,38 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of one of its transit link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  Sort ();
+  LSDBVector_t::const_iterator i = std::lower_bound (m_linkDataIndex.begin (), m_linkDataIndex.end (),
+                                                     LSDBPair_t (addr, 0), CompareLSDBPair);
+  if (i != m_linkDataIndex.end () && i->first == addr)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return i->second;
     }
   return 0;
 }
 
+GlobalRouteManagerLSDB*
+GlobalRouteManagerLSDB::Copy () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Sort ();
+  GlobalRouteManagerLSDB* lsdb = new GlobalRouteManagerLSDB ();
+  lsdb->m_database.reserve (m_database.size ());
+  for (LSDBVector_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsdb->m_database.push_back (LSDBPair_t (i->first, new GlobalRoutingLSA (*i->second)));
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      lsdb->m_extdatabase.push_back (new GlobalRoutingLSA (*m_extdatabase[j]));
+    }
+  lsdb->m_sorted = false;
+  lsdb->Sort ();
+  return lsdb;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -527,7 +647,9 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_routesValid (false),
+    m_spfWork (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -551,10 +673,42 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  m_routesValid = false;
+}
+
+static void
+RemoveAllRoutes (Ptr<Ipv4GlobalRouting> gr)
+{
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      gr->RemoveRoute (0);
+    }
 }
 
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  DeleteRoutes ();
+  if (m_lsdb)
+    {
+      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
+      delete m_lsdb;
+      m_lsdb = new GlobalRouteManagerLSDB ();
+    }
+}
+
+//
+// Delete the routes of all the global routers, but keep the database they
+// were computed from.
+//
+void
+GlobalRouteManagerImpl::DeleteRoutes ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   NodeList::Iterator listEnd = NodeList::End ();
@@ -567,25 +721,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
           continue;
         }
       Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
       NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
-    }
-  if (m_lsdb)
-    {
-      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
-      delete m_lsdb;
-      m_lsdb = new GlobalRouteManagerLSDB ();
+      RemoveAllRoutes (gr);
     }
+  m_routesValid = false;
 }
 
 //
@@ -601,6 +740,7 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_routesValid = false;
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -688,33 +828,679 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  SPFRoots_t roots;
+  GetSPFRoots (roots);
+  CalculateRoutes (roots);
+  m_routesValid = true;
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+//
+// Find the routers to run the SPF calculation for: the nodes of this system
+// that have a global router interface with LSAs.
+//
+void
+GlobalRouteManagerImpl::GetSPFRoots (SPFRoots_t &roots) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
       Ptr<Node> node = *i;
+
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () != MpiInterface::GetSystemId ())
+        {
+          continue;
+        }
 //
 // Look for the GlobalRouter interface that indicates that the node is
 // participating in routing.
 //
-      Ptr<GlobalRouter> rtr = 
+      Ptr<GlobalRouter> rtr =
         node->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetNumLSAs () )
+        {
+          SPFRoot root;
+          root.routerId = rtr->GetRouterId ();
+          root.routing = rtr->GetRoutingProtocol ();
+          root.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (root.ipv4,
+                         "GlobalRouteManagerImpl::GetSPFRoots (): "
+                         "GetObject for <Ipv4> interface failed");
+          roots.push_back (root);
+        }
+    }
+}
+
+//
+// The routers left to calculate, shared by the threads of CalculateRoutes ().
+//
+struct GlobalRouteManagerImpl::SPFWork
+{
+  const SPFRoots_t *roots;
+  uint32_t next;
+#ifdef HAVE_PTHREAD_H
+  SystemMutex mutex;
+#endif
+};
+
+//
+// Run the SPF calculation for each of the given routers, in as many threads
+// as the GlobalRoutingThreads global value asks for.
+//
+// Each thread has its own GlobalRouteManagerImpl with a copy of the database,
+// since the calculation marks the LSAs and keeps its state in members.  The
+// threads take the next router from a shared counter rather than a fixed
+// share each, as the stub routers take next to no time.  A router's routes
+// are only written by the thread calculating them, and nothing else in the
+// system is changed, so the threads need no other locking.  The reference
+// counts of objects are not thread-safe, so the threads must not touch any
+// object but those of their router: the routers' objects were all looked up
+// here, beforehand.
+//
+void
+GlobalRouteManagerImpl::CalculateRoutes (const SPFRoots_t &roots)
+{
+  NS_LOG_FUNCTION (roots.size ());
+
+  UintegerValue threadsValue;
+  g_globalRoutingThreads.GetValue (threadsValue);
+  uint32_t nThreads = threadsValue.Get ();
+#ifdef HAVE_PTHREAD_H
+  if (nThreads == 0)
+    {
+      long nProcessors = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = nProcessors > 0 ? nProcessors : 1;
+    }
+#else
+  nThreads = 1;
+#endif
+  nThreads = std::min<uint32_t> (nThreads, roots.size ());
+
+  if (nThreads <= 1)
+    {
+      for (SPFRoots_t::const_iterator i = roots.begin (); i != roots.end (); i++)
+        {
+          SPFCalculate (*i);
+        }
+      return;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  NS_LOG_LOGIC ("Calculating the routes of " << roots.size () << " routers in " << nThreads << " threads");
+  m_lsdb->Initialize ();
+  SPFWork work;
+  work.roots = &roots;
+  work.next = 0;
+
+  std::vector<GlobalRouteManagerImpl *> workers;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < nThreads; i++)
+    {
+      GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+      worker->DebugUseLsdb (m_lsdb->Copy ());
+      worker->m_spfWork = &work;
+      workers.push_back (worker);
+      threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::CalculateRoutesThread, worker)));
+    }
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Start ();
+    }
+
+  m_spfWork = &work;
+  CalculateRoutesThread ();
+  m_spfWork = 0;
+
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+      delete workers[i];
+    }
+#endif
+}
+
+void
+GlobalRouteManagerImpl::CalculateRoutesThread ()
+{
+  for (;;)
+    {
+      uint32_t next;
+      {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (m_spfWork->mutex);
+#endif
+        next = m_spfWork->next++;
+      }
+      if (next >= m_spfWork->roots->size ())
+        {
+          return;
+        }
+      SPFCalculate ((*m_spfWork->roots)[next]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+  if (!incremental.Get () || !m_routesValid)
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB* oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  bool updated = UpdateRoutes (oldLsdb);
+  delete oldLsdb;
+  if (!updated)
+    {
+      NS_LOG_LOGIC ("Recomputing the routes of all the routers");
+      DeleteRoutes ();
+      InitializeRoutes ();
+    }
+  m_routesValid = true;
+}
+
+static bool
+IsSameLinkRecord (GlobalRoutingLinkRecord *l1, GlobalRoutingLinkRecord *l2)
+{
+  return l1->GetLinkType () == l2->GetLinkType () &&
+         l1->GetLinkId () == l2->GetLinkId () &&
+         l1->GetLinkData () == l2->GetLinkData () &&
+         l1->GetMetric () == l2->GetMetric ();
+}
+
+static bool
+IsSameLSAHeader (GlobalRoutingLSA *lsa1, GlobalRoutingLSA *lsa2)
+{
+  return lsa1->GetLSType () == lsa2->GetLSType () &&
+         lsa1->GetLinkStateId () == lsa2->GetLinkStateId () &&
+         lsa1->GetAdvertisingRouter () == lsa2->GetAdvertisingRouter () &&
+         lsa1->GetNetworkLSANetworkMask () == lsa2->GetNetworkLSANetworkMask ();
+}
+
+//
+// The link records and attached routers of the old LSA that are not in the
+// new one, or false if the new LSA has any that the old one did not.
+//
+static bool
+GetWithdrawnLinks (GlobalRoutingLSA *oldLsa, GlobalRoutingLSA *newLsa,
+                   std::vector<GlobalRoutingLinkRecord *> &records,
+                   std::vector<Ipv4Address> &routers)
+{
+  std::vector<bool> matched (newLsa->GetNLinkRecords (), false);
+  for (uint32_t i = 0; i < oldLsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = oldLsa->GetLinkRecord (i);
+      uint32_t j = 0;
+      while (j < matched.size () && (matched[j] || !IsSameLinkRecord (l, newLsa->GetLinkRecord (j))))
+        {
+          j++;
+        }
+      if (j < matched.size ())
+        {
+          matched[j] = true;
+        }
+      else
+        {
+          records.push_back (l);
+        }
+    }
+  if (std::find (matched.begin (), matched.end (), false) != matched.end ())
+    {
+      return false;
+    }
+
+  matched.assign (newLsa->GetNAttachedRouters (), false);
+  for (uint32_t i = 0; i < oldLsa->GetNAttachedRouters (); i++)
+    {
+      Ipv4Address router = oldLsa->GetAttachedRouter (i);
+      uint32_t j = 0;
+      while (j < matched.size () && (matched[j] || router != newLsa->GetAttachedRouter (j)))
+        {
+          j++;
+        }
+      if (j < matched.size ())
+        {
+          matched[j] = true;
+        }
+      else
+        {
+          routers.push_back (router);
+        }
+    }
+  return std::find (matched.begin (), matched.end (), false) == matched.end ();
+}
+
+//
+// An edge of the graph the SPF calculation walks, between LSA numbers of
+// the database.
+//
+struct SPFEdge
+{
+  uint32_t from;
+  uint32_t to;
+  uint32_t cost;
+};
+
+//
+// For each LSA, the edges of the SPF graph that lead to it, as SPFNext ()
+// finds them: router-LSA link records to routers and networks, and network
+// LSA attached routers, at no cost.
+//
+static void
+GetReverseSPFGraph (const GlobalRouteManagerLSDB* lsdb, std::vector<std::vector<SPFEdge> > &graph)
+{
+  graph.assign (lsdb->GetNumLSAs (), std::vector<SPFEdge> ());
+  for (uint32_t v = 0; v < lsdb->GetNumLSAs (); v++)
+    {
+      GlobalRoutingLSA *lsa = lsdb->GetLSAByIndex (v);
+      SPFEdge edge;
+      edge.from = v;
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  continue;
+                }
+              edge.to = lsdb->GetLSAIndex (l->GetLinkId ());
+              edge.cost = l->GetMetric ();
+              if (edge.to != SPF_INFINITY)
+                {
+                  graph[edge.to].push_back (edge);
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+            {
+              GlobalRoutingLSA *w_lsa = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (i));
+              if (w_lsa)
+                {
+                  edge.to = lsdb->GetLSAIndex (w_lsa->GetLinkStateId ());
+                  edge.cost = 0;
+                  graph[edge.to].push_back (edge);
+                }
+            }
+        }
+    }
+}
+
+//
+// The distances from every LSA to the given one, with Dijkstra on the
+// reversed graph.
+//
+static void
+GetDistancesTo (const std::vector<std::vector<SPFEdge> > &graph, uint32_t to,
+                std::vector<uint32_t> &distances)
+{
+  typedef std::pair<uint32_t, uint32_t> Candidate;
+  distances.assign (graph.size (), SPF_INFINITY);
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > candidates;
+  distances[to] = 0;
+  candidates.push (Candidate (0, to));
+  while (!candidates.empty ())
+    {
+      Candidate c = candidates.top ();
+      candidates.pop ();
+      if (c.first != distances[c.second])
+        {
+          continue;
+        }
+      const std::vector<SPFEdge> &edges = graph[c.second];
+      for (std::vector<SPFEdge>::const_iterator e = edges.begin (); e != edges.end (); e++)
+        {
+          uint32_t distance = c.first + e->cost;
+          if (distance < distances[e->from])
+            {
+              distances[e->from] = distance;
+              candidates.push (Candidate (distance, e->from));
+            }
+        }
+    }
+}
+
+//
+// The link records of an LSA that were withdrawn, and the removed edges.
+//
+struct WithdrawnLinks
+{
+  uint32_t lsa;
+  std::vector<GlobalRoutingLinkRecord *> records;
+  std::vector<Ipv4Address> routers;
+};
+
+//
+// Bring the routes computed from the old database up to date with the
+// current one, m_lsdb, if the only differences are link records and
+// attached routers that were withdrawn.  There are then only fewer edges in
+// the SPF graph.  A router whose shortest paths did not use any of the
+// removed edges keeps the same shortest paths, with the same exits, to
+// everything still advertised, so it only has to lose its routes to the
+// destinations of the withdrawn records.  The other routers run the SPF
+// calculation again.
+//
+// Returns false, without having changed any route, if all the routes must
+// be computed again.
+//
+bool
+GlobalRouteManagerImpl::UpdateRoutes (GlobalRouteManagerLSDB* oldLsdb)
+{
+  NS_LOG_FUNCTION (oldLsdb);
+  oldLsdb->Initialize ();
+  m_lsdb->Initialize ();
+
+  if (oldLsdb->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs () ||
+      oldLsdb->GetNumLSAs () != m_lsdb->GetNumLSAs ())
+    {
+      NS_LOG_LOGIC ("LSAs were added or removed");
+      return false;
+    }
+  for (uint32_t i = 0; i < oldLsdb->GetNumExtLSAs (); i++)
+    {
+      std::vector<GlobalRoutingLinkRecord *> records;
+      std::vector<Ipv4Address> routers;
+      GlobalRoutingLSA *oldLsa = oldLsdb->GetExtLSA (i);
+      GlobalRoutingLSA *newLsa = m_lsdb->GetExtLSA (i);
+      if (!IsSameLSAHeader (oldLsa, newLsa) ||
+          !GetWithdrawnLinks (oldLsa, newLsa, records, routers) || !records.empty () || !routers.empty ())
+        {
+          NS_LOG_LOGIC ("AS external LSA " << oldLsa->GetLinkStateId () << " changed");
+          return false;
+        }
+    }
+
+//
+// Both databases have the same LSAs, so they are numbered alike.
+//
+  std::vector<WithdrawnLinks> changed;
+  std::vector<bool> isChanged (oldLsdb->GetNumLSAs (), false);
+  for (uint32_t i = 0; i < oldLsdb->GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *oldLsa = oldLsdb->GetLSAByIndex (i);
+      GlobalRoutingLSA *newLsa = m_lsdb->GetLSAByIndex (i);
+      WithdrawnLinks withdrawn;
+      withdrawn.lsa = i;
+      if (!IsSameLSAHeader (oldLsa, newLsa) ||
+          !GetWithdrawnLinks (oldLsa, newLsa, withdrawn.records, withdrawn.routers))
+        {
+          NS_LOG_LOGIC ("LSA " << oldLsa->GetLinkStateId () << " has new links");
+          return false;
+        }
+      if (!withdrawn.records.empty () || !withdrawn.routers.empty ())
+        {
+          changed.push_back (withdrawn);
+          isChanged[i] = true;
+        }
+    }
+  if (changed.empty ())
+    {
+      NS_LOG_LOGIC ("No LSA changed");
+      return true;
+    }
+
+//
+// The edges that are gone.  A withdrawn transit record also removes the edge
+// back from the network, as the network LSA finds its routers by the link
+// data of their transit records.
+//
+  std::vector<SPFEdge> removed;
+  for (std::vector<WithdrawnLinks>::const_iterator c = changed.begin (); c != changed.end (); c++)
+    {
+      SPFEdge edge;
+      for (std::vector<GlobalRoutingLinkRecord *>::const_iterator l = c->records.begin (); l != c->records.end (); l++)
+        {
+          if ((*l)->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          edge.from = c->lsa;
+          edge.to = oldLsdb->GetLSAIndex ((*l)->GetLinkId ());
+          edge.cost = (*l)->GetMetric ();
+          if (edge.to == SPF_INFINITY)
+            {
+              continue;
+            }
+          removed.push_back (edge);
+          if ((*l)->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              std::swap (edge.from, edge.to);
+              edge.cost = 0;
+              removed.push_back (edge);
+            }
+        }
+      for (std::vector<Ipv4Address>::const_iterator r = c->routers.begin (); r != c->routers.end (); r++)
+        {
+          GlobalRoutingLSA *w_lsa = oldLsdb->GetLSAByLinkData (*r);
+          if (w_lsa)
+            {
+              edge.from = c->lsa;
+              edge.to = oldLsdb->GetLSAIndex (w_lsa->GetLinkStateId ());
+              edge.cost = 0;
+              removed.push_back (edge);
+            }
+        }
+    }
+
+//
+// The distances to the ends of the removed edges and to the changed LSAs.
+// Each takes about as long as the SPF calculation of a router, so if there
+// are many of them it is quicker to compute all the routes again.
+//
+  std::map<uint32_t, std::vector<uint32_t> > distances;
+  for (std::vector<SPFEdge>::const_iterator e = removed.begin (); e != removed.end (); e++)
+    {
+      distances[e->from];
+      distances[e->to];
+    }
+  for (std::vector<WithdrawnLinks>::const_iterator c = changed.begin (); c != changed.end (); c++)
+    {
+      distances[c->lsa];
+    }
+
+  SPFRoots_t roots;
+  GetSPFRoots (roots);
+  if (distances.size () * 2 > roots.size ())
+    {
+      NS_LOG_LOGIC ("Too many changes (" << distances.size () << " LSAs) for " << roots.size () << " routers");
+      return false;
+    }
+
+  std::vector<std::vector<SPFEdge> > graph;
+  GetReverseSPFGraph (oldLsdb, graph);
+  for (std::map<uint32_t, std::vector<uint32_t> >::iterator i = distances.begin (); i != distances.end (); i++)
+    {
+      GetDistancesTo (graph, i->first, i->second);
+    }
+
+  SPFRoots_t affected;
+  for (SPFRoots_t::const_iterator root = roots.begin (); root != roots.end (); root++)
+    {
+      uint32_t r = oldLsdb->GetLSAIndex (root->routerId);
+      bool isAffected = (r == SPF_INFINITY || isChanged[r]);
+//
+// A removed edge is on the shortest paths of the root if the distance to
+// its end is the distance to its start plus its cost.  The root also takes
+// the next hops to its neighbors from their link records back to it or to
+// the networks it is on, so it is affected if any of those went.
+//
+      GlobalRoutingLSA *rlsa = isAffected ? 0 : oldLsdb->GetLSAByIndex (r);
+      for (std::vector<SPFEdge>::const_iterator e = removed.begin (); e != removed.end () && !isAffected; e++)
+        {
+          uint32_t from = distances[e->from][r];
+          if (from != SPF_INFINITY && from + e->cost == distances[e->to][r])
+            {
+              isAffected = true;
+            }
+          if (e->to == r)
+            {
+              isAffected = true;
+            }
+          for (uint32_t i = 0; i < rlsa->GetNLinkRecords () && !isAffected; i++)
+            {
+              GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
+                  oldLsdb->GetLSAIndex (l->GetLinkId ()) == e->to)
+                {
+                  isAffected = true;
+                }
+            }
+        }
+
+//
+// Routes to the destinations of the withdrawn point-to-point and stub
+// records, through the exits the root used for their router.
+//
+      std::vector<Ipv4RoutingTableEntry> routes;
+      m_spfrootIpv4 = root->ipv4;
+      for (std::vector<WithdrawnLinks>::const_iterator c = changed.begin (); c != changed.end () && !isAffected; c++)
+        {
+          const std::vector<uint32_t> &distancesToLsa = distances[c->lsa];
+          if (c->records.empty () || distancesToLsa[r] == SPF_INFINITY)
+            {
+              continue;
+            }
+          std::vector<SPFVertex::NodeExit_t> exits;
+          if (!GetRootExits (oldLsdb, r, c->lsa, distancesToLsa, exits))
+            {
+              isAffected = true;
+              break;
+            }
+          for (std::vector<GlobalRoutingLinkRecord *>::const_iterator l = c->records.begin (); l != c->records.end (); l++)
+            {
+              for (std::vector<SPFVertex::NodeExit_t>::const_iterator exit = exits.begin (); exit != exits.end (); exit++)
+                {
+                  if (exit->second < 0)
+                    {
+                      continue;
+                    }
+                  if ((*l)->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+                    {
+                      routes.push_back (Ipv4RoutingTableEntry::CreateHostRouteTo ((*l)->GetLinkData (),
+                                                                                   exit->first, exit->second));
+                    }
+                  else if ((*l)->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                    {
+                      Ipv4Mask mask ((*l)->GetLinkData ().Get ());
+                      routes.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo ((*l)->GetLinkId ().CombineMask (mask),
+                                                                                      mask, exit->first, exit->second));
+                    }
+                }
+            }
+        }
+      m_spfrootIpv4 = 0;
+
+      if (isAffected)
+        {
+          RemoveAllRoutes (root->routing);
+          affected.push_back (*root);
+        }
+      else if (!routes.empty ())
+        {
+          root->routing->RemoveRoutes (routes);
+        }
+    }
+
+  NS_LOG_INFO ("Recomputing the routes of " << affected.size () << " of " << roots.size () << " routers");
+  CalculateRoutes (affected);
+  return true;
+}
+
+//
+// The exits from the root to the given router or network, as the SPF
+// calculation finds them, given the distances from every LSA to it.  The
+// exit of a path depends only on its first hops: a point-to-point link of
+// the root, or a network of the root and the router after it.  Returns
+// false if the calculation would have found no next hop.
+//
+bool
+GlobalRouteManagerImpl::GetRootExits (const GlobalRouteManagerLSDB* lsdb, uint32_t root, uint32_t dest,
+                                      const std::vector<uint32_t> &distances,
+                                      std::vector<SPFVertex::NodeExit_t> &exits)
+{
+  GlobalRoutingLSA *rlsa = lsdb->GetLSAByIndex (root);
+  for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+        {
+          continue;
+        }
+      uint32_t w = lsdb->GetLSAIndex (l->GetLinkId ());
+      if (w == SPF_INFINITY || distances[w] == SPF_INFINITY ||
+          l->GetMetric () + distances[w] != distances[root])
+        {
+          continue;
+        }
+      GlobalRoutingLSA *w_lsa = lsdb->GetLSAByIndex (w);
+
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          GlobalRoutingLinkRecord *linkRemote = 0;
+          for (uint32_t j = 0; j < w_lsa->GetNLinkRecords () && !linkRemote; j++)
+            {
+              if (w_lsa->GetLinkRecord (j)->GetLinkId () == rlsa->GetLinkStateId ())
+                {
+                  linkRemote = w_lsa->GetLinkRecord (j);
+                }
+            }
+          if (!linkRemote)
+            {
+              return false;
+            }
+          exits.push_back (SPFVertex::NodeExit_t (linkRemote->GetLinkData (),
+                                                  FindOutgoingInterfaceId (l->GetLinkData ())));
+          continue;
+        }
 
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != MpiInterface::GetSystemId ()) 
+      int32_t outIf = FindOutgoingInterfaceId (w_lsa->GetLinkStateId (), w_lsa->GetNetworkLSANetworkMask ());
+      if (w == dest)
         {
+          exits.push_back (SPFVertex::NodeExit_t (Ipv4Address::GetZero (), outIf));
           continue;
         }
-
-//
-// if the node has a global router interface, then run the global routing
-// algorithms.
-//
-      if (rtr && rtr->GetNumLSAs () )
+      for (uint32_t j = 0; j < w_lsa->GetNAttachedRouters (); j++)
         {
-          SPFCalculate (rtr->GetRouterId ());
+          GlobalRoutingLSA *x_lsa = lsdb->GetLSAByLinkData (w_lsa->GetAttachedRouter (j));
+          if (!x_lsa)
+            {
+              continue;
+            }
+          uint32_t x = lsdb->GetLSAIndex (x_lsa->GetLinkStateId ());
+          if (x == root || distances[x] != distances[w])
+            {
+              continue;
+            }
+          GlobalRoutingLinkRecord *linkRemote = 0;
+          for (uint32_t k = 0; k < x_lsa->GetNLinkRecords () && !linkRemote; k++)
+            {
+              if (x_lsa->GetLinkRecord (k)->GetLinkId () == w_lsa->GetLinkStateId ())
+                {
+                  linkRemote = x_lsa->GetLinkRecord (k);
+                }
+            }
+          if (!linkRemote)
+            {
+              return false;
+            }
+          exits.push_back (SPFVertex::NodeExit_t (linkRemote->GetLinkData (), outIf));
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  std::sort (exits.begin (), exits.end ());
+  exits.erase (std::unique (exits.begin (), exits.end ()), exits.end ());
+  return true;
 }
 
 //
@@ -945,7 +1731,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1305,9 +2091,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+                  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
                   NS_ASSERT (gr);
                   gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1322,13 +2106,51 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
   return false;
 }
 
-// quagga ospf_spf_calculate
+//
+// Run the SPF calculation for the router with the given ID, looking its node
+// up in the node list.
+//
 void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
 
+  SPFRoot spfRoot;
+  spfRoot.routerId = root;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == root)
+        {
+          spfRoot.routing = rtr->GetRoutingProtocol ();
+          spfRoot.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (spfRoot.ipv4, 
+                         "GlobalRouteManagerImpl::SPFCalculate (): "
+                         "GetObject for <Ipv4> interface failed");
+          break;
+        }
+    }
+  SPFCalculate (spfRoot);
+}
+
+// quagga ospf_spf_calculate
+//
+// The routes are written to the routing protocol of the root, and the
+// outgoing interfaces looked up on its Ipv4.  Nothing here touches the node
+// list or other nodes, so that calculations for different roots, each with
+// its own GlobalRouteManagerImpl and copy of the database, can run in
+// parallel threads.
+//
+void
+GlobalRouteManagerImpl::SPFCalculate (const SPFRoot &root)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+
   SPFVertex *v;
+  m_spfrootRouting = root.routing;
+  m_spfrootIpv4 = root.ipv4;
 //
 // Initialize the Link State Database.
 //
@@ -1345,7 +2167,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
 //
-  v = new SPFVertex (m_lsdb->GetLSA (root));
+  v = new SPFVertex (m_lsdb->GetLSA (root.routerId));
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
@@ -1353,19 +2175,24 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
-  NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
+  NS_LOG_LOGIC ("Starting SPFCalculate for node " << root.routerId);
 
 //
 // Optimize SPF calculation, for ns-3.
 // We do not need to calculate SPF for every node in the network if this
 // node has only one interface through which another router can be 
 // reached.  Instead, short-circuit this computation and just install
-// a default route in the CheckForStubNode() method.
+// a default route in the CheckForStubNode() method.  The default route
+// needs the routing protocol of the node, which unit tests running on a
+// hand-built database don't have.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrootRouting != 0 && CheckForStubNode (root.routerId))
     {
-      NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root.routerId);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootRouting = 0;
+      m_spfrootIpv4 = 0;
       return;
     }
 
@@ -1429,12 +2256,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
+// This is the method that actually adds the routes.  It writes them to the
+// routing protocol of the node at the root of the tree -- that is the router
+// we're building the routes for -- which was looked up before the calculation
+// started.  So we are only actually adding routes to that one node at the
+// root of the SPF tree.
 //
 // We're going to pop of a pointer to every vertex in the tree except the 
 // root in order of distance from the root.  For each of the vertices, we call
@@ -1487,6 +2313,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootRouting = 0;
+  m_spfrootIpv4 = 0;
 }
 
 void
@@ -1545,105 +2373,56 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The routing protocol of the root of the SPF tree was looked up before the
+// calculation started.  This is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  if (gr == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No routing protocol for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for router " << routerId);
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.
+//
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// The vertex <v> (corresponding to the node that advertises the external
+// network) has the next hop addresses and outbound interface indices
+// precalculated for us that the root node should use to forward packets to
+// the external network.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1714,113 +2493,61 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The routing protocol of the root of the SPF tree was looked up before the
+// calculation started.  This is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  if (gr == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No routing protocol for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for router " << routerId);
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.
+//
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// The vertex <v> (corresponding to the node that has the stub network) has
+// the next hop addresses and outbound interface indices precalculated for
+// us that the root node should use to forward packets to the stub network.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is a wrapper around GetInterfaceForPrefix() on the Ipv4 of the node
+// at the root of the SPF tree.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
@@ -1829,70 +2556,30 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// The Ipv4 of the node at the root of the SPF tree was looked up before the
+// calculation started, since walking the list of nodes for every address
+// made the calculation quadratic in the number of nodes.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootIpv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node");
+      return -1;
+    }
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = m_spfrootIpv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1920,69 +2607,32 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol was
+// looked up before the calculation started.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  if (gr == 0)
+    {
+      NS_LOG_LOGIC ("No routing protocol for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for router " << routerId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -1991,18 +2641,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2016,44 +2666,31 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2065,104 +2702,56 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol was
+// looked up before the calculation started.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  if (gr == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No routing protocol for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for router " << routerId);
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.
+//
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-      if (rtr == 0)
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
         }
-    } 
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -30,6 +30,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -548,6 +549,7 @@ private:
   ListOfSPFVertex_t m_parents;
   ListOfSPFVertex_t m_children;
   bool m_vertexProcessed; 
+  uint32_t m_candidatePosition; // in the heap of the CandidateQueue holding the vertex
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -564,6 +566,7 @@ private:
   //friend std::ostream& operator<< (std::ostream& os, const ListOfIf_t& ifs);
   //friend std::ostream& operator<< (std::ostream& os, const ListOfAddr_t& addrs);
   friend std::ostream& operator<< (std::ostream& os, const SPFVertex::ListOfSPFVertex_t& vs);
+  friend class CandidateQueue;
 };
 
 /**
@@ -665,12 +668,56 @@ public:
   GlobalRoutingLSA* GetExtLSA (uint32_t index) const;
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Get the number of router and network LSAs in the database.
+ * @internal
+ *
+ * The LSAs are numbered from 0 in the order of their link state IDs.
+ * These numbers are only valid until the next Insert ().
+ */
+  uint32_t GetNumLSAs () const;
+/**
+ * @brief Get the router or network LSA of the given number.
+ * @internal
+ *
+ * @see GetNumLSAs
+ */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+/**
+ * @brief Get the number of the LSA with the given link state ID, or
+ * SPF_INFINITY if there is none.
+ * @internal
+ *
+ * @see GetNumLSAs
+ */
+  uint32_t GetLSAIndex (Ipv4Address addr) const;
+
+/**
+ * @brief Make a deep copy of the database, with copies of all its LSAs.
+ * @internal
+ *
+ * The SPF calculation marks the LSAs it explores, so calculations running
+ * at the same time each need their own copy.  The caller owns the copy.
+ */
+  GlobalRouteManagerLSDB* Copy () const;
 
 private:
-  typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t;
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t;
+  typedef std::vector<LSDBPair_t> LSDBVector_t;
+
+/**
+ * @brief Sort the database by link state ID, and index the transit link
+ * records by link data, if anything was inserted since the last time.
+ * @internal
+ *
+ * Lookups sort the database as needed, so it must have been sorted (e.g.,
+ * by Initialize ()) before it is shared between threads.
+ */
+  void Sort () const;
 
-  LSDBMap_t m_database;
+  mutable LSDBVector_t m_database;       // by link state ID once sorted
+  mutable LSDBVector_t m_linkDataIndex;  // by link data of the transit link records
+  mutable bool m_sorted;
   std::vector<GlobalRoutingLSA*> m_extdatabase;
 
 /**
@@ -727,6 +774,19 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after the topology changed.
+ * @internal
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes ().  If the GlobalRoutingIncremental global value is
+ * true and links or interfaces only went down since the routes were last
+ * computed, only the routers whose shortest paths used them run the SPF
+ * calculation again; the others just lose the routes to the destinations
+ * that are no longer advertised.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @internal
@@ -754,10 +814,38 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * A router to run the SPF calculation for, and the objects its routes
+   * are written to.
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId;
+    Ptr<Ipv4GlobalRouting> routing;
+    Ptr<Ipv4> ipv4;
+  };
+  typedef std::vector<SPFRoot> SPFRoots_t;
+
+  struct SPFWork;
+
   SPFVertex* m_spfroot;
+  Ptr<Ipv4GlobalRouting> m_spfrootRouting;
+  Ptr<Ipv4> m_spfrootIpv4;
   GlobalRouteManagerLSDB* m_lsdb;
+  bool m_routesValid;  // the routing tables were computed from m_lsdb
+  SPFWork* m_spfWork;  // the routers left to calculate, shared by the threads
+
+  void DeleteRoutes ();
+  void GetSPFRoots (SPFRoots_t &roots) const;
+  void CalculateRoutes (const SPFRoots_t &roots);
+  void CalculateRoutesThread ();
+  bool UpdateRoutes (GlobalRouteManagerLSDB* oldLsdb);
+  bool GetRootExits (const GlobalRouteManagerLSDB* lsdb, uint32_t root, uint32_t dest,
+                     const std::vector<uint32_t> &distances,
+                     std::vector<SPFVertex::NodeExit_t> &exits);
   bool CheckForStubNode (Ipv4Address root);
   void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (const SPFRoot &root);
   void SPFProcessStubs (SPFVertex* v);
   void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
   void SPFNext (SPFVertex*, CandidateQueue&);
@@ -67,6 +67,15 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Delete the routes and compute them again from the current topology,
+ * as DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes () do, but only for the routers affected by the links
+ * that went down if the GlobalRoutingIncremental global value is true.
+ * @internal
+ */
+  static void RecomputeRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
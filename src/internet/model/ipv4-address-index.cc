@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ipv4-address-index.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4AddressIndex");
+
+namespace ns3 {
+
+class Ipv4AddressIndexImpl
+{
+public:
+  void Add (const Ipv4Address address, uint32_t nodeId);
+  void Remove (const Ipv4Address address, uint32_t nodeId);
+  Ptr<Node> GetNode (const Ipv4Address address) const;
+  bool IsIndexed (const Ipv4Address address) const;
+
+private:
+  /*
+   * An address may be configured on several nodes (the loopback address is
+   * on all of them) and several times on the same node, so every address
+   * maps to a sorted list of node ids, with one entry per configuration.
+   */
+  typedef sgi::hash_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash> Index;
+
+  Index m_index;
+};
+
+void
+Ipv4AddressIndexImpl::Add (const Ipv4Address address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (this << address << nodeId);
+  std::vector<uint32_t> &nodes = m_index[address];
+  nodes.insert (std::upper_bound (nodes.begin (), nodes.end (), nodeId), nodeId);
+}
+
+void
+Ipv4AddressIndexImpl::Remove (const Ipv4Address address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (this << address << nodeId);
+  Index::iterator i = m_index.find (address);
+  if (i == m_index.end ())
+    {
+      return;
+    }
+  std::vector<uint32_t>::iterator node = std::lower_bound (i->second.begin (), i->second.end (), nodeId);
+  if (node != i->second.end () && *node == nodeId)
+    {
+      i->second.erase (node);
+    }
+  if (i->second.empty ())
+    {
+      m_index.erase (i);
+    }
+}
+
+Ptr<Node>
+Ipv4AddressIndexImpl::GetNode (const Ipv4Address address) const
+{
+  NS_LOG_FUNCTION (this << address);
+  Index::const_iterator i = m_index.find (address);
+  if (i == m_index.end ())
+    {
+      return 0;
+    }
+  uint32_t nodeId = i->second.front ();
+  if (nodeId >= NodeList::GetNNodes ())
+    {
+      return 0;
+    }
+  return NodeList::GetNode (nodeId);
+}
+
+bool
+Ipv4AddressIndexImpl::IsIndexed (const Ipv4Address address) const
+{
+  NS_LOG_FUNCTION (this << address);
+  return m_index.find (address) != m_index.end ();
+}
+
+/*
+ * Not a Singleton: the nodes are usually disposed of by the NodeList finalizer
+ * at process exit, which removes their addresses from the index, so the index
+ * must not be destroyed by a static finalizer before that.  It is never deleted.
+ */
+static Ipv4AddressIndexImpl *
+GetImpl (void)
+{
+  static Ipv4AddressIndexImpl *impl = new Ipv4AddressIndexImpl ();
+  return impl;
+}
+
+void
+Ipv4AddressIndex::Add (const Ipv4Address address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetImpl ()->Add (address, nodeId);
+}
+
+void
+Ipv4AddressIndex::Remove (const Ipv4Address address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetImpl ()->Remove (address, nodeId);
+}
+
+Ptr<Node>
+Ipv4AddressIndex::GetNode (const Ipv4Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetNode (address);
+}
+
+bool
+Ipv4AddressIndex::IsIndexed (const Ipv4Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->IsIndexed (address);
+}
+
+} // namespace ns3
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ADDRESS_INDEX_H
+#define IPV4_ADDRESS_INDEX_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Global index from the IPv4 addresses configured on the nodes
+ * of the simulation to the nodes themselves.
+ *
+ * Ipv4L3Protocol keeps the index up to date as addresses are added to
+ * and removed from its interfaces, so that finding the node owning an
+ * address (e.g. the destination of a route computed by a global routing
+ * protocol) is a hash lookup rather than a walk over every node.
+ *
+ * Like the NodeList, the index outlives Simulator::Destroy.
+ */
+class Ipv4AddressIndex {
+public:
+  /**
+   * \param address an address configured on one of the node's interfaces
+   * \param nodeId the id of the node (in the NodeList)
+   */
+  static void Add (const Ipv4Address address, uint32_t nodeId);
+  /**
+   * \param address an address that was removed from one of the node's interfaces
+   * \param nodeId the id of the node (in the NodeList)
+   *
+   * The node keeps its entry if the address is still configured on
+   * another of its interfaces.
+   */
+  static void Remove (const Ipv4Address address, uint32_t nodeId);
+
+  /**
+   * \param address the address to look up
+   * \returns the node with the lowest id that has the address configured
+   * on one of its interfaces, or 0 if there is none.  This is the node
+   * a walk over the NodeList would find first.
+   */
+  static Ptr<Node> GetNode (const Ipv4Address address);
+  /**
+   * \param address the address to look up
+   * \returns true if some node has the address configured
+   */
+  static bool IsIndexed (const Ipv4Address address);
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ADDRESS_INDEX_H */
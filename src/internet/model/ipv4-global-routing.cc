@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -51,13 +52,21 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("TrieLookup",
+                   "Set to true to look routes up in longest-prefix-match tries instead of walking the route lists; "
+                   "unlike the lists, the tries prefer the longest of overlapping network prefixes",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::SetTrieLookup,
+                                        &Ipv4GlobalRouting::GetTrieLookup),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_trieLookup (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -78,6 +87,10 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  if (m_trieLookup)
+    {
+      m_hostTrie.Insert (route);
+    }
 }
 
 void 
@@ -88,6 +101,10 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  if (m_trieLookup)
+    {
+      m_hostTrie.Insert (route);
+    }
 }
 
 void 
@@ -103,6 +120,10 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  if (m_trieLookup)
+    {
+      m_networkTrie.Insert (route);
+    }
 }
 
 void 
@@ -116,6 +137,10 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  if (m_trieLookup)
+    {
+      m_networkTrie.Insert (route);
+    }
 }
 
 void 
@@ -131,6 +156,10 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  if (m_trieLookup)
+    {
+      m_ASexternalTrie.Insert (route);
+    }
 }
 
 
@@ -144,71 +173,88 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  if (m_trieLookup)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      LookupTrie (m_hostTrie, dest, oif, allRoutes);
+      if (allRoutes.size () == 0)
         {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          LookupTrie (m_networkTrie, dest, oif, allRoutes);
+        }
+      if (allRoutes.size () == 0)
+        {
+          LookupTrie (m_ASexternalTrie, dest, oif, allRoutes);
+          // as below, a single external route is used
+          allRoutes.resize (std::min<size_t> (allRoutes.size (), 1));
         }
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  else
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+      for (HostRoutesCI i = m_hostRoutes.begin (); 
+           i != m_hostRoutes.end (); 
+           i++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          NS_ASSERT ((*i)->IsHost ());
+          if ((*i)->GetDest ().IsEqual (dest)) 
             {
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              allRoutes.push_back (*i);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
             }
         }
-    }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
-    {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      if (allRoutes.size () == 0) // if no host route is found
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+          for (NetworkRoutesI j = m_networkRoutes.begin (); 
+               j != m_networkRoutes.end (); 
+               j++) 
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              Ipv4Mask mask = (*j)->GetDestNetworkMask ();
+              Ipv4Address entry = (*j)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry)) 
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != 0)
                     {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
+                      if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
                     }
+                  allRoutes.push_back (*j);
+                  NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+                }
+            }
+        }
+      if (allRoutes.size () == 0)  // consider external if no host/network found
+        {
+          for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
+               k != m_ASexternalRoutes.end ();
+               k++)
+            {
+              Ipv4Mask mask = (*k)->GetDestNetworkMask ();
+              Ipv4Address entry = (*k)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry))
+                {
+                  NS_LOG_LOGIC ("Found external route" << *k);
+                  if (oif != 0)
+                    {
+                      if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
+                    }
+                  allRoutes.push_back (*k);
+                  break;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
         }
     }
@@ -243,6 +289,59 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::LookupTrie (const Ipv4RoutingTrie &trie, Ipv4Address dest, Ptr<NetDevice> oif,
+                               std::vector<Ipv4RoutingTableEntry *> &routes) const
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  const Ipv4RoutingTrie::Routes *matches[Ipv4RoutingTrie::MAX_MATCHES];
+  uint32_t nmatches = trie.Lookup (dest, matches);
+  for (uint32_t i = 0; i < nmatches && routes.empty (); i++)
+    {
+      for (Ipv4RoutingTrie::Routes::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (j->first->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          routes.push_back (j->first);
+        }
+    }
+  NS_LOG_LOGIC ("Found " << routes.size () << " routes");
+}
+
+void
+Ipv4GlobalRouting::SetTrieLookup (bool trieLookup)
+{
+  NS_LOG_FUNCTION (this << trieLookup);
+  m_trieLookup = trieLookup;
+  m_hostTrie.Clear ();
+  m_networkTrie.Clear ();
+  m_ASexternalTrie.Clear ();
+  if (m_trieLookup)
+    {
+      for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+        {
+          m_hostTrie.Insert (*i);
+        }
+      for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+        {
+          m_networkTrie.Insert (*j);
+        }
+      for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); k != m_ASexternalRoutes.end (); k++)
+        {
+          m_ASexternalTrie.Insert (*k);
+        }
+    }
+}
+
+bool
+Ipv4GlobalRouting::GetTrieLookup (void) const
+{
+  return m_trieLookup;
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -317,6 +416,10 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              if (m_trieLookup)
+                {
+                  m_hostTrie.Remove (*i);
+                }
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -334,6 +437,10 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          if (m_trieLookup)
+            {
+              m_networkTrie.Remove (*j);
+            }
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -350,6 +457,10 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          if (m_trieLookup)
+            {
+              m_ASexternalTrie.Remove (*k);
+            }
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -360,6 +471,57 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+static std::pair<uint64_t, uint64_t>
+GetRouteKey (const Ipv4RoutingTableEntry &route)
+{
+  return std::make_pair ((uint64_t)route.GetDest ().Get () << 32 | route.GetDestNetworkMask ().Get (),
+                         (uint64_t)route.GetGateway ().Get () << 32 | route.GetInterface ());
+}
+
+uint32_t
+Ipv4GlobalRouting::RemoveRoutes (const std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << routes.size ());
+  RouteCounts counts;
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      counts[GetRouteKey (*i)]++;
+    }
+  uint32_t removed = RemoveRoutes (m_hostRoutes, m_hostTrie, counts);
+  removed += RemoveRoutes (m_networkRoutes, m_networkTrie, counts);
+  removed += RemoveRoutes (m_ASexternalRoutes, m_ASexternalTrie, counts);
+  NS_LOG_LOGIC ("Removed " << removed << " of " << routes.size () << " routes");
+  return removed;
+}
+
+uint32_t
+Ipv4GlobalRouting::RemoveRoutes (std::list<Ipv4RoutingTableEntry *> &list, Ipv4RoutingTrie &trie,
+                                 RouteCounts &counts)
+{
+  uint32_t removed = 0;
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = list.begin (); i != list.end () && !counts.empty (); )
+    {
+      RouteCounts::iterator count = counts.find (GetRouteKey (**i));
+      if (count == counts.end ())
+        {
+          i++;
+          continue;
+        }
+      if (--count->second == 0)
+        {
+          counts.erase (count);
+        }
+      if (m_trieLookup)
+        {
+          trie.Remove (*i);
+        }
+      delete *i;
+      i = list.erase (i);
+      removed++;
+    }
+  return removed;
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -372,6 +534,9 @@ void
 Ipv4GlobalRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_hostTrie.Clear ();
+  m_networkTrie.Clear ();
+  m_ASexternalTrie.Clear ();
   for (HostRoutesI i = m_hostRoutes.begin (); 
        i != m_hostRoutes.end (); 
        i = m_hostRoutes.erase (i)) 
@@ -556,9 +721,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -568,9 +731,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -580,9 +741,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -592,9 +751,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -21,12 +21,15 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-trie.h"
 #include "ns3/random-variable-stream.h"
 
 namespace ns3 {
@@ -211,6 +214,21 @@ public:
  */
   void RemoveRoute (uint32_t i);
 
+/**
+ * \brief Remove a set of routes from the global unicast routing table.
+ *
+ * A route is removed if it has the same destination, mask, gateway and
+ * interface as one of the given routes; each given route removes at most one
+ * route from the table.  This walks the table once, rather than once per
+ * route as RemoveRoute () does.
+ *
+ * \param routes The routes to remove.
+ * \return The number of routes removed.
+ *
+ * \see Ipv4GlobalRouting::RemoveRoute
+ */
+  uint32_t RemoveRoutes (const std::vector<Ipv4RoutingTableEntry> &routes);
+
  /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -243,11 +261,29 @@ private:
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  /// Fill routes with the routes of the longest matching prefix in trie that has routes on oif
+  void LookupTrie (const Ipv4RoutingTrie &trie, Ipv4Address dest, Ptr<NetDevice> oif,
+                   std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
+  typedef std::map<std::pair<uint64_t, uint64_t>, uint32_t> RouteCounts;
+  /// Remove the routes of list counted in counts, decrementing their counts
+  uint32_t RemoveRoutes (std::list<Ipv4RoutingTableEntry *> &list, Ipv4RoutingTrie &trie,
+                         RouteCounts &counts);
+
+  /// (Re)build the tries from the route lists, or empty them
+  void SetTrieLookup (bool trieLookup);
+  bool GetTrieLookup (void) const;
 
   HostRoutes m_hostRoutes;
   NetworkRoutes m_networkRoutes;
   ASExternalRoutes m_ASexternalRoutes; // External routes imported
 
+  /// Set to true if routes are looked up in the tries rather than the route lists
+  bool m_trieLookup;
+  Ipv4RoutingTrie m_hostTrie;
+  Ipv4RoutingTrie m_networkTrie;
+  Ipv4RoutingTrie m_ASexternalTrie;
+
   Ptr<Ipv4> m_ipv4;
 };
 
@@ -39,6 +39,7 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "ipv4-address-index.h"
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4L3Protocol");
 
@@ -202,6 +203,13 @@ Ipv4L3Protocol::DoDispose (void)
 
   for (Ipv4InterfaceList::iterator i = m_interfaces.begin (); i != m_interfaces.end (); ++i)
     {
+      if (m_node != 0)
+        {
+          for (uint32_t j = 0; j < (*i)->GetNAddresses (); j++)
+            {
+              Ipv4AddressIndex::Remove ((*i)->GetAddress (j).GetLocal (), m_node->GetId ());
+            }
+        }
       *i = 0;
     }
   m_interfaces.clear ();
@@ -252,6 +260,7 @@ Ipv4L3Protocol::SetupLoopback (void)
   interface->SetNode (m_node);
   Ipv4InterfaceAddress ifaceAddr = Ipv4InterfaceAddress (Ipv4Address::GetLoopback (), Ipv4Mask::GetLoopback ());
   interface->AddAddress (ifaceAddr);
+  Ipv4AddressIndex::Add (ifaceAddr.GetLocal (), m_node->GetId ());
   uint32_t index = AddIpv4Interface (interface);
   Ptr<Node> node = GetObject<Node> ();
   node->RegisterProtocolHandler (MakeCallback (&Ipv4L3Protocol::Receive, this), 
@@ -924,6 +933,10 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  if (retVal && m_node != 0)
+    {
+      Ipv4AddressIndex::Add (address.GetLocal (), m_node->GetId ());
+    }
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -953,6 +966,10 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      if (m_node != 0)
+        {
+          Ipv4AddressIndex::Remove (address.GetLocal (), m_node->GetId ());
+        }
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-routing-trie.h"
+#include "ipv4-routing-table-entry.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RoutingTrie");
+
+namespace ns3 {
+
+Ipv4RoutingTrie::Ipv4RoutingTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+uint32_t
+Ipv4RoutingTrie::GetMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+uint32_t
+Ipv4RoutingTrie::GetBit (uint32_t address, uint32_t position)
+{
+  NS_ASSERT (position < 32);
+  return (address >> (31 - position)) & 1;
+}
+
+uint32_t
+Ipv4RoutingTrie::AddNode (uint32_t prefix, uint32_t length)
+{
+  Node node;
+  node.prefix = prefix & GetMask (length);
+  node.length = length;
+  node.child[0] = node.child[1] = NO_NODE;
+  m_nodes.push_back (node);
+  return m_nodes.size () - 1;
+}
+
+void
+Ipv4RoutingTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  m_nRoutes = 0;
+  AddNode (0, 0);
+}
+
+void
+Ipv4RoutingTrie::Insert (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint32_t length = route->GetDestNetworkMask ().GetPrefixLength ();
+  uint32_t prefix = route->GetDestNetwork ().Get () & GetMask (length);
+  m_nRoutes++;
+
+  // the prefix of each node visited is a prefix of the new one
+  uint32_t current = 0;
+  while (m_nodes[current].length < length)
+    {
+      uint32_t bit = GetBit (prefix, m_nodes[current].length);
+      uint32_t next = m_nodes[current].child[bit];
+      if (next == NO_NODE)
+        {
+          uint32_t leaf = AddNode (prefix, length);
+          m_nodes[current].child[bit] = leaf;
+          current = leaf;
+          break;
+        }
+
+      // length of the prefix shared with the child
+      uint32_t childLength = m_nodes[next].length;
+      uint32_t limit = std::min (length, childLength);
+      uint32_t common = m_nodes[current].length + 1;
+      while (common < limit && GetBit (prefix, common) == GetBit (m_nodes[next].prefix, common))
+        {
+          common++;
+        }
+
+      if (common == childLength)
+        {
+          current = next;
+          continue;
+        }
+
+      // the new prefix branches off (or ends) within the edge to the child
+      uint32_t split = AddNode (prefix, common);
+      m_nodes[split].child[GetBit (m_nodes[next].prefix, common)] = next;
+      m_nodes[current].child[bit] = split;
+      if (common < length)
+        {
+          uint32_t leaf = AddNode (prefix, length);
+          m_nodes[split].child[GetBit (prefix, common)] = leaf;
+          current = leaf;
+        }
+      else
+        {
+          current = split;
+        }
+      break;
+    }
+
+  NS_ASSERT (m_nodes[current].length == length && m_nodes[current].prefix == prefix);
+  m_nodes[current].routes.push_back (Route (route, metric));
+}
+
+uint32_t
+Ipv4RoutingTrie::FindNode (uint32_t prefix, uint32_t length) const
+{
+  uint32_t current = 0;
+  while (current != NO_NODE)
+    {
+      const Node &node = m_nodes[current];
+      if (node.length > length || ((prefix ^ node.prefix) & GetMask (node.length)) != 0)
+        {
+          return NO_NODE;
+        }
+      if (node.length == length)
+        {
+          return current;
+        }
+      current = node.child[GetBit (prefix, node.length)];
+    }
+  return NO_NODE;
+}
+
+void
+Ipv4RoutingTrie::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint32_t length = route->GetDestNetworkMask ().GetPrefixLength ();
+  uint32_t prefix = route->GetDestNetwork ().Get () & GetMask (length);
+
+  // the node itself is kept, as routes to the same prefix often come back
+  uint32_t index = FindNode (prefix, length);
+  NS_ASSERT_MSG (index != NO_NODE, "Route not in the trie");
+  Routes &routes = m_nodes[index].routes;
+  for (Routes::iterator i = routes.begin (); i != routes.end (); ++i)
+    {
+      if (i->first == route)
+        {
+          routes.erase (i);
+          m_nRoutes--;
+          break;
+        }
+    }
+  if (m_nRoutes == 0)
+    {
+      Clear ();
+    }
+}
+
+uint32_t
+Ipv4RoutingTrie::Lookup (Ipv4Address dest, const Routes *matches[MAX_MATCHES]) const
+{
+  uint32_t address = dest.Get ();
+  uint32_t nmatches = 0;
+  uint32_t current = 0;
+  while (current != NO_NODE)
+    {
+      const Node &node = m_nodes[current];
+      if (((address ^ node.prefix) & GetMask (node.length)) != 0)
+        {
+          break;
+        }
+      if (!node.routes.empty ())
+        {
+          matches[nmatches++] = &node.routes;
+        }
+      if (node.length == 32)
+        {
+          break;
+        }
+      current = node.child[GetBit (address, node.length)];
+    }
+
+  // longest first
+  for (uint32_t i = 0; i < nmatches / 2; i++)
+    {
+      std::swap (matches[i], matches[nmatches - 1 - i]);
+    }
+  return nmatches;
+}
+
+uint32_t
+Ipv4RoutingTrie::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+} // namespace ns3
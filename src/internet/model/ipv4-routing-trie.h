@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_ROUTING_TRIE_H
+#define IPV4_ROUTING_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup internet
+ *
+ * \brief A path-compressed binary trie of the destination prefixes of
+ * Ipv4RoutingTableEntry objects, for longest-prefix-match lookups.
+ *
+ * A lookup visits at most one node per prefix length, whatever the
+ * number of routes.  The trie does not own the entries: the routing
+ * protocol keeps them in its own route lists and inserts or removes
+ * them here as they are added to or removed from those lists.  Routes
+ * with the same prefix are kept in the order they were inserted.
+ */
+class Ipv4RoutingTrie
+{
+public:
+  /**
+   * A route and its metric
+   */
+  typedef std::pair<Ipv4RoutingTableEntry *, uint32_t> Route;
+  typedef std::vector<Route> Routes;
+
+  /**
+   * The longest prefix length, plus one for the empty prefix
+   */
+  static const uint32_t MAX_MATCHES = 33;
+
+  Ipv4RoutingTrie ();
+
+  /**
+   * \param route the route to add under the prefix of its destination network
+   * \param metric the metric of the route
+   */
+  void Insert (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+  /**
+   * \param route a route added with Insert
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+  void Clear (void);
+
+  /**
+   * \param dest the destination to look up
+   * \param matches (returned) the routes of every prefix which
+   *        matches dest, from the longest prefix to the shortest
+   * \returns the number of prefixes in matches
+   */
+  uint32_t Lookup (Ipv4Address dest, const Routes *matches[MAX_MATCHES]) const;
+
+  /**
+   * \returns the number of routes in the trie
+   */
+  uint32_t GetNRoutes (void) const;
+
+private:
+  static const uint32_t NO_NODE = 0xffffffff;
+
+  struct Node
+  {
+    uint32_t prefix;   // masked to length bits
+    uint32_t length;
+    uint32_t child[2]; // indexed by the bit after the prefix
+    Routes routes;
+  };
+
+  static uint32_t GetMask (uint32_t length);
+  static uint32_t GetBit (uint32_t address, uint32_t position);
+  uint32_t AddNode (uint32_t prefix, uint32_t length);
+  /* the node of the given prefix, or NO_NODE */
+  uint32_t FindNode (uint32_t prefix, uint32_t length) const;
+
+  std::vector<Node> m_nodes; // the root, of the empty prefix, comes first
+  uint32_t m_nRoutes;
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTING_TRIE_H */
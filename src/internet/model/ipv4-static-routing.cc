@@ -31,6 +31,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/boolean.h"
 #include "ipv4-static-routing.h"
 #include "ipv4-routing-table-entry.h"
 
@@ -48,12 +49,20 @@ Ipv4StaticRouting::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Ipv4StaticRouting")
     .SetParent<Ipv4RoutingProtocol> ()
     .AddConstructor<Ipv4StaticRouting> ()
+    .AddAttribute ("TrieLookup",
+                   "Set to true to look routes up in a longest-prefix-match trie instead of "
+                   "walking the whole routing table; the routes chosen are the same",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4StaticRouting::SetTrieLookup,
+                                        &Ipv4StaticRouting::GetTrieLookup),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_trieLookup (false),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -72,6 +81,10 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  if (m_trieLookup)
+    {
+      m_trie.Insert (route, metric);
+    }
 }
 
 void 
@@ -86,6 +99,10 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  if (m_trieLookup)
+    {
+      m_trie.Insert (route, metric);
+    }
 }
 
 void 
@@ -143,6 +160,10 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  if (m_trieLookup)
+    {
+      m_trie.Insert (route, 0);
+    }
 }
 
 uint32_t 
@@ -238,6 +259,44 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
+  if (m_trieLookup)
+    {
+      // Same choice as below: the longest prefix with a route on the
+      // requested interface, then the lowest metric, then the last added
+      const Ipv4RoutingTrie::Routes *matches[Ipv4RoutingTrie::MAX_MATCHES];
+      uint32_t nmatches = m_trie.Lookup (dest, matches);
+      for (uint32_t i = 0; i < nmatches; i++)
+        {
+          Ipv4RoutingTableEntry *route = 0;
+          uint32_t shortest_metric = 0xffffffff;
+          for (Ipv4RoutingTrie::Routes::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+            {
+              if (oif != 0 && oif != m_ipv4->GetNetDevice (j->first->GetInterface ()))
+                {
+                  continue;
+                }
+              if (j->second <= shortest_metric)
+                {
+                  route = j->first;
+                  shortest_metric = j->second;
+                }
+            }
+          if (route != 0)
+            {
+              NS_LOG_LOGIC ("Found network route " << route << ", metric " << shortest_metric);
+              uint32_t interfaceIdx = route->GetInterface ();
+              rtentry = Create<Ipv4Route> ();
+              rtentry->SetDestination (route->GetDest ());
+              rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetDest ()));
+              rtentry->SetGateway (route->GetGateway ());
+              rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+              return rtentry;
+            }
+        }
+      NS_LOG_LOGIC ("No matching route to " << dest << " found");
+      return 0;
+    }
+
 
   for (NetworkRoutesI i = m_networkRoutes.begin (); 
        i != m_networkRoutes.end (); 
@@ -442,6 +501,10 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          if (m_trieLookup)
+            {
+              m_trie.Remove (j->first);
+            }
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -584,6 +647,7 @@ Ipv4StaticRouting::~Ipv4StaticRouting ()
 void
 Ipv4StaticRouting::DoDispose (void)
 {
+  m_trie.Clear ();
   for (NetworkRoutesI j = m_networkRoutes.begin (); 
        j != m_networkRoutes.end (); 
        j = m_networkRoutes.erase (j)) 
@@ -682,6 +746,27 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
     }
 }
 
+void
+Ipv4StaticRouting::SetTrieLookup (bool trieLookup)
+{
+  NS_LOG_FUNCTION (this << trieLookup);
+  m_trieLookup = trieLookup;
+  m_trie.Clear ();
+  if (m_trieLookup)
+    {
+      for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+        {
+          m_trie.Insert (j->first, j->second);
+        }
+    }
+}
+
+bool
+Ipv4StaticRouting::GetTrieLookup (void) const
+{
+  return m_trieLookup;
+}
+
 void 
 Ipv4StaticRouting::SetIpv4 (Ptr<Ipv4> ipv4)
 {
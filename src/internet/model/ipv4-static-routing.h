@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-trie.h"
 
 namespace ns3 {
 
@@ -389,9 +390,17 @@ private:
 
   Ipv4Address SourceAddressSelection (uint32_t interface, Ipv4Address dest);
 
+  /* (re)builds the trie from the route list, or empties it */
+  void SetTrieLookup (bool trieLookup);
+  bool GetTrieLookup (void) const;
+
   NetworkRoutes m_networkRoutes;
   MulticastRoutes m_multicastRoutes;
 
+  /* If true, m_networkRoutes are also kept in m_trie for lookups */
+  bool m_trieLookup;
+  Ipv4RoutingTrie m_trie;
+
   Ptr<Ipv4> m_ipv4;
 };
 
@@ -26,7 +26,25 @@
 #include "ns3/global-route-manager-impl.h"
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/node-container.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/random-variable-stream.h"
 #include <cstdlib> // for rand()
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -214,6 +232,323 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("Check the candidate queue order after pushes and lower costs")
+{
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  std::vector<SPFVertex *> vertices;
+
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      SPFVertex *v = new SPFVertex;
+      v->SetVertexType (i % 3 ? SPFVertex::VertexRouter : SPFVertex::VertexNetwork);
+      v->SetVertexId (Ipv4Address (i + 1));
+      v->SetDistanceFromRoot (100 + std::rand () % 100);
+      candidate.Push (v);
+      vertices.push_back (v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Size (), 200, "Wrong queue size");
+
+  // Lower the cost of every other vertex, as SPFNext does
+  for (uint32_t i = 0; i < vertices.size (); i += 2)
+    {
+      vertices[i]->SetDistanceFromRoot (std::rand () % 150);
+      candidate.Update (vertices[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Find (Ipv4Address (7)), vertices[6], "Vertex not found by its ID");
+
+  SPFVertex *last = 0;
+  for (uint32_t i = 0; i < vertices.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (candidate.Top (), candidate.Find (candidate.Top ()->GetVertexId ()), "Top is not indexed");
+      SPFVertex *v = candidate.Pop ();
+      if (last)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((last->GetDistanceFromRoot () <= v->GetDistanceFromRoot ()), true, "Popped out of order");
+          if (last->GetDistanceFromRoot () == v->GetDistanceFromRoot ())
+            {
+              NS_TEST_ASSERT_MSG_EQ ((last->GetVertexType () == SPFVertex::VertexNetwork ||
+                                      v->GetVertexType () == SPFVertex::VertexRouter), true,
+                                     "Router popped before a network at the same distance");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), 0, "Popped vertex still found");
+      last = v;
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Empty (), true, "Queue not empty");
+
+  for (uint32_t i = 0; i < vertices.size (); ++i)
+    {
+      delete vertices[i];
+    }
+}
+
+class GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  GlobalRoutingRecomputeTestCase ();
+  virtual void DoRun (void);
+private:
+  std::vector<std::string> GetRoutes (NodeContainer nodes);
+};
+
+GlobalRoutingRecomputeTestCase::GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Check that incremental and threaded recomputations find the routes of a full one")
+{
+}
+
+/* the sorted routes of each node */
+std::vector<std::string>
+GlobalRoutingRecomputeTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::vector<std::string> tables;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); ++j)
+        {
+          std::ostringstream oss;
+          oss << *routing->GetRoute (j);
+          routes.push_back (oss.str ());
+        }
+      std::sort (routes.begin (), routes.end ());
+      std::ostringstream table;
+      for (uint32_t j = 0; j < routes.size (); ++j)
+        {
+          table << routes[j] << "\n";
+        }
+      tables.push_back (table.str ());
+    }
+  return tables;
+}
+
+void
+GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  // A ring of 30 routers with a chord from every third one, each link a
+  // channel of its own, and a host on every fifth router
+  const uint32_t nRouters = 30;
+  NodeContainer nodes;
+  nodes.Create (nRouters + nRouters / 5);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ptr<UniformRandomVariable> metric = CreateObject<UniformRandomVariable> ();
+  metric->SetStream (1);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.0");
+  std::vector<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t i = 0; i < nRouters; ++i)
+    {
+      links.push_back (std::make_pair (i, (i + 1) % nRouters));
+      if (i % 3 == 0)
+        {
+          links.push_back (std::make_pair (i, (i + 7) % nRouters));
+        }
+      if (i % 5 == 0)
+        {
+          links.push_back (std::make_pair (i, nRouters + i / 5));
+        }
+    }
+  for (uint32_t i = 0; i < links.size (); ++i)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices;
+      uint32_t ends[2] = { links[i].first, links[i].second };
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetChannel (channel);
+          nodes.Get (ends[j])->AddDevice (device);
+          devices.Add (device);
+        }
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      // Shortest paths must be unique: the SPF calculation does not handle
+      // equal-cost paths through a network that is not next to the root
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          interfaces.Get (j).first->SetMetric (interfaces.Get (j).second, metric->GetInteger (1, 1000));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // Take ring links down one end at a time.  Without the end that is not the
+  // designated router, the network LSA and a router LSA just lose a link;
+  // without the other, the network turns into a stub one.
+  for (uint32_t round = 0; round < 4; ++round)
+    {
+      std::pair<uint32_t, uint32_t> link (6 * round + 4, 6 * round + 5);
+      Ptr<Node> node = nodes.Get (round % 2 ? link.first : link.second);
+      Ptr<Node> peer = nodes.Get (round % 2 ? link.second : link.first);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<Channel> channel = node->GetDevice (j)->GetChannel ();
+          if (channel && (channel->GetDevice (0)->GetNode () == peer || channel->GetDevice (1)->GetNode () == peer))
+            {
+              ipv4->SetDown (ipv4->GetInterfaceForDevice (node->GetDevice (j)));
+            }
+        }
+
+      Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (true));
+      Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (round % 2 ? 4 : 1));
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::vector<std::string> incremental = GetRoutes (nodes);
+
+      Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (false));
+      Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::vector<std::string> full = GetRoutes (nodes);
+
+      for (uint32_t i = 0; i < nodes.GetN (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (incremental[i], full[i], "Different routes on node " << i << " in round " << round);
+        }
+    }
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (3));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> threaded = GetRoutes (nodes);
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> single = GetRoutes (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (threaded[i], single[i], "Different routes on node " << i << " with threads");
+    }
+
+  Simulator::Destroy ();
+}
+
+namespace {
+
+/* a SimpleNetDevice the global routers take for a point-to-point link */
+class PointToPointSimpleNetDevice : public SimpleNetDevice
+{
+public:
+  virtual bool IsPointToPoint (void) const { return true; }
+  virtual bool IsBroadcast (void) const { return false; }
+};
+
+} // anonymous namespace
+
+class GlobalRoutingEqualCostTestCase : public TestCase
+{
+public:
+  GlobalRoutingEqualCostTestCase ();
+  virtual void DoRun (void);
+};
+
+GlobalRoutingEqualCostTestCase::GlobalRoutingEqualCostTestCase ()
+  : TestCase ("Check the order of the routes computed over equal-cost paths")
+{
+}
+
+void
+GlobalRoutingEqualCostTestCase::DoRun (void)
+{
+  // A 3x3 grid of routers, with each link to the right and then each link
+  // down from every router, row by row.  Its few metrics make many paths of
+  // equal cost, and lower the cost of vertices to that of others already in
+  // the candidate queue, so the routes are added in an order which depends
+  // on how the queue breaks ties.
+  //
+  //   a - b - c
+  //   |   |   |
+  //   d - e - f
+  //   |   |   |
+  //   g - h - i
+  //
+  const uint32_t side = 3;
+  const uint16_t metrics[] = { 2, 2, 1, 2, 3, 2, 2, 1, 1, 2, 3, 2 };
+  // The routers in the order their host routes first appear in the table of
+  // each one, as found by the SPF calculation which sorted its candidate list
+  const char *expected[] = { "bdcegfhi", "caefhdig", "bfaehidg",
+                             "aegfhbic", "fhbdicga", "eihcbdga",
+                             "dhaeifbc", "eifgbdca", "fhecgbda" };
+
+  NodeContainer nodes;
+  nodes.Create (side * side);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  uint32_t link = 0;
+  for (uint32_t i = 0; i < side * side; ++i)
+    {
+      uint32_t peers[2] = { i % side + 1 < side ? i + 1 : i, i + side < side * side ? i + side : i };
+      for (uint32_t k = 0; k < 2; ++k)
+        {
+          if (peers[k] == i)
+            {
+              continue;
+            }
+          Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+          NetDeviceContainer devices;
+          uint32_t ends[2] = { i, peers[k] };
+          for (uint32_t j = 0; j < 2; ++j)
+            {
+              Ptr<SimpleNetDevice> device = CreateObject<PointToPointSimpleNetDevice> ();
+              device->SetAddress (Mac48Address::Allocate ());
+              device->SetChannel (channel);
+              nodes.Get (ends[j])->AddDevice (device);
+              devices.Add (device);
+            }
+          Ipv4InterfaceContainer interfaces = address.Assign (devices);
+          address.NewNetwork ();
+          for (uint32_t j = 0; j < 2; ++j)
+            {
+              interfaces.Get (j).first->SetMetric (interfaces.Get (j).second, metrics[link]);
+            }
+          link++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (link, sizeof (metrics) / sizeof (metrics[0]), "Wrong number of links");
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::string routers;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); ++j)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+          if (!route->IsHost ())
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < nodes.GetN (); ++k)
+            {
+              char router = 'a' + k;
+              if (nodes.Get (k)->GetObject<Ipv4> ()->GetInterfaceForAddress (route->GetDest ()) >= 0
+                  && routers.find (router) == std::string::npos)
+                {
+                  routers += router;
+                }
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (routers, expected[i], "Different order of the routes on router " << (char)('a' + i));
+    }
+
+  Simulator::Destroy ();
+}
+
 static class GlobalRouteManagerImplTestSuite : public TestSuite
 {
 public:
@@ -221,5 +556,8 @@ public:
     : TestSuite ("global-route-manager-impl", UNIT)
   {
     AddTestCase (new GlobalRouteManagerImplTestCase ());
+    AddTestCase (new CandidateQueueTestCase ());
+    AddTestCase (new GlobalRoutingRecomputeTestCase ());
+    AddTestCase (new GlobalRoutingEqualCostTestCase ());
   }
 } g_globalRoutingManagerImplTestSuite;
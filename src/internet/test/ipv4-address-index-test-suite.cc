@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-address-index.h"
+
+using namespace ns3;
+
+static Ptr<Ipv4L3Protocol>
+AddIpv4Stack (Ptr<Node> node)
+{
+  Ptr<ArpL3Protocol> arp = CreateObject<ArpL3Protocol> ();
+  node->AggregateObject (arp);
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  Ptr<Ipv4ListRouting> ipv4Routing = CreateObject<Ipv4ListRouting> ();
+  ipv4->SetRoutingProtocol (ipv4Routing);
+  ipv4Routing->AddRoutingProtocol (CreateObject<Ipv4StaticRouting> (), 0);
+  node->AggregateObject (ipv4);
+  return ipv4;
+}
+
+static uint32_t
+AddInterface (Ptr<Node> node, Ptr<Ipv4L3Protocol> ipv4, Ipv4Address address)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  uint32_t interface = ipv4->AddInterface (device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (address, Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (interface);
+  return interface;
+}
+
+class Ipv4AddressIndexTestCase : public TestCase
+{
+public:
+  Ipv4AddressIndexTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4AddressIndexTestCase::Ipv4AddressIndexTestCase ()
+  : TestCase ("Check that the address index follows addresses added to and removed from nodes")
+{
+}
+
+void
+Ipv4AddressIndexTestCase::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<Ipv4L3Protocol> ipv4a = AddIpv4Stack (a);
+  Ptr<Ipv4L3Protocol> ipv4b = AddIpv4Stack (b);
+
+  uint32_t ifa = AddInterface (a, ipv4a, Ipv4Address ("192.168.77.1"));
+  uint32_t ifb = AddInterface (b, ipv4b, Ipv4Address ("192.168.77.2"));
+
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.77.1")), a, "Address of a not indexed");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.77.2")), b, "Address of b not indexed");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::IsIndexed (Ipv4Address ("192.168.77.3")), false, "Unknown address indexed");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.77.3")), 0, "Unknown address found");
+
+  // The loopback address is on every node; like a walk over the NodeList, the lowest id wins
+  Ptr<Node> loopbackNode = Ipv4AddressIndex::GetNode (Ipv4Address::GetLoopback ());
+  NS_TEST_ASSERT_MSG_NE (loopbackNode, 0, "Loopback address not indexed");
+  NS_TEST_EXPECT_MSG_EQ ((loopbackNode->GetId () <= a->GetId ()), true, "Loopback should map to the lowest node id");
+
+  // A second address on the same interface, then removing the first one
+  ipv4b->AddAddress (ifb, Ipv4InterfaceAddress (Ipv4Address ("192.168.78.2"), Ipv4Mask ("255.255.255.0")));
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.78.2")), b, "Second address of b not indexed");
+  ipv4b->RemoveAddress (ifb, 0);
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::IsIndexed (Ipv4Address ("192.168.77.2")), false, "Removed address still indexed");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.78.2")), b, "Remaining address of b lost");
+
+  // The same address on two nodes maps to the one with the lowest id until it is removed there
+  uint32_t ifb2 = AddInterface (b, ipv4b, Ipv4Address ("192.168.77.1"));
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.77.1")), a, "Duplicate address should map to a");
+  ipv4a->RemoveAddress (ifa, 0);
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::GetNode (Ipv4Address ("192.168.77.1")), b, "Duplicate address should now map to b");
+  ipv4b->RemoveAddress (ifb2, 0);
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::IsIndexed (Ipv4Address ("192.168.77.1")), false, "Removed address still indexed");
+
+  // Disposing of the stack removes its addresses
+  a->Dispose ();
+  b->Dispose ();
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressIndex::IsIndexed (Ipv4Address ("192.168.78.2")), false, "Disposed node's address still indexed");
+
+  Simulator::Destroy ();
+}
+
+static class Ipv4AddressIndexTestSuite : public TestSuite
+{
+public:
+  Ipv4AddressIndexTestSuite ()
+    : TestSuite ("ipv4-address-index", UNIT)
+  {
+    AddTestCase (new Ipv4AddressIndexTestCase ());
+  }
+} g_ipv4AddressIndexTestSuite;
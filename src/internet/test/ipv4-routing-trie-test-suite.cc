@@ -0,0 +1,414 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <algorithm>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-routing-trie.h"
+
+using namespace ns3;
+
+/* a random prefix length, biased towards the lengths found in real tables */
+static uint32_t
+RandomPrefixLength (Ptr<UniformRandomVariable> u)
+{
+  static const uint32_t lengths[] = { 0, 8, 16, 16, 20, 24, 24, 24, 30, 32 };
+  return lengths[u->GetInteger (0, sizeof (lengths) / sizeof (lengths[0]) - 1)];
+}
+
+static Ipv4Mask
+MakeMask (uint32_t length)
+{
+  return Ipv4Mask (length ? ~0u << (32 - length) : 0);
+}
+
+class Ipv4RoutingTrieLookupTestCase : public TestCase
+{
+public:
+  Ipv4RoutingTrieLookupTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4RoutingTrieLookupTestCase::Ipv4RoutingTrieLookupTestCase ()
+  : TestCase ("Check the prefixes the trie matches against a walk over all the routes")
+{
+}
+
+void
+Ipv4RoutingTrieLookupTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> u = CreateObject<UniformRandomVariable> ();
+  u->SetStream (1);
+
+  // Prefixes share a few leading bytes so that they nest and overlap
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  Ipv4RoutingTrie trie;
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint32_t address = (u->GetInteger (10, 11) << 24) | (u->GetInteger (0, 3) << 16) | u->GetInteger (0, 0xffff);
+      Ipv4Mask mask = MakeMask (RandomPrefixLength (u));
+      Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+      *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address (address).CombineMask (mask), mask, i);
+      routes.push_back (route);
+      trie.Insert (route, i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (trie.GetNRoutes (), routes.size (), "Wrong number of routes");
+
+  // Remove every third route
+  for (uint32_t i = 0; i < routes.size (); i += 3)
+    {
+      trie.Remove (routes[i]);
+    }
+
+  for (uint32_t n = 0; n < 2000; n++)
+    {
+      Ipv4Address dest ((u->GetInteger (10, 11) << 24) | (u->GetInteger (0, 3) << 16) | u->GetInteger (0, 0xffff));
+
+      const Ipv4RoutingTrie::Routes *matches[Ipv4RoutingTrie::MAX_MATCHES];
+      uint32_t nmatches = trie.Lookup (dest, matches);
+
+      // the routes of each matched prefix, longest first, in insertion order
+      std::vector<Ipv4RoutingTableEntry *> found;
+      for (uint32_t m = 0; m < nmatches; m++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (matches[m]->empty (), false, "Matched a prefix without routes");
+          for (Ipv4RoutingTrie::Routes::const_iterator r = matches[m]->begin (); r != matches[m]->end (); r++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (r->second, r->first->GetInterface (), "Wrong metric for route");
+              found.push_back (r->first);
+            }
+        }
+
+      std::vector<Ipv4RoutingTableEntry *> expected;
+      for (uint32_t length = 33; length-- > 0; )
+        {
+          for (uint32_t i = 0; i < routes.size (); i++)
+            {
+              Ipv4Mask mask = routes[i]->GetDestNetworkMask ();
+              if (i % 3 != 0 && mask.GetPrefixLength () == length && mask.IsMatch (dest, routes[i]->GetDestNetwork ()))
+                {
+                  expected.push_back (routes[i]);
+                }
+            }
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Wrong number of matching routes for " << dest);
+      for (uint32_t i = 0; i < found.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (found[i], expected[i], "Wrong route for " << dest);
+        }
+    }
+
+  trie.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (trie.GetNRoutes (), 0, "Routes left after Clear");
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      delete routes[i];
+    }
+}
+
+class Ipv4StaticRoutingTrieTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingTrieTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4StaticRoutingTrieTestCase::Ipv4StaticRoutingTrieTestCase ()
+  : TestCase ("Check that static routing finds the same routes with and without the trie")
+{
+}
+
+void
+Ipv4StaticRoutingTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> u = CreateObject<UniformRandomVariable> ();
+  u->SetStream (2);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (CreateObject<ArpL3Protocol> ());
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  Ptr<Ipv4StaticRouting> routing = CreateObject<Ipv4StaticRouting> ();
+  ipv4->SetRoutingProtocol (routing);
+  node->AggregateObject (ipv4);
+
+  std::vector<Ptr<NetDevice> > devices;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t interface = ipv4->AddInterface (device);
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address ((192u << 24) | (168u << 16) | (i << 8) | 1),
+                                                         Ipv4Mask ("255.255.255.0")));
+      ipv4->SetUp (interface);
+      devices.push_back (device);
+    }
+
+  // Routes added before the trie is enabled are copied into it, the others as they come
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      if (i == 200)
+        {
+          routing->SetAttribute ("TrieLookup", BooleanValue (true));
+        }
+      uint32_t interface = u->GetInteger (1, devices.size ());
+      uint32_t address = (10u << 24) | (u->GetInteger (0, 3) << 16) | u->GetInteger (0, 0xffff);
+      Ipv4Mask mask = MakeMask (RandomPrefixLength (u));
+      Ipv4Address gateway ((192u << 24) | (168u << 16) | ((interface - 1) << 8) | u->GetInteger (2, 254));
+      routing->AddNetworkRouteTo (Ipv4Address (address).CombineMask (mask), mask, gateway, interface, u->GetInteger (0, 3));
+    }
+  routing->RemoveRoute (10);
+  routing->RemoveRoute (100);
+
+  for (uint32_t n = 0; n < 1000; n++)
+    {
+      Ipv4Header header;
+      header.SetDestination (Ipv4Address ((10u << 24) | (u->GetInteger (0, 3) << 16) | u->GetInteger (0, 0xffff)));
+      Ptr<NetDevice> oif = n % 4 == 0 ? devices[u->GetInteger (0, devices.size () - 1)] : Ptr<NetDevice> (0);
+      Socket::SocketErrno err;
+
+      routing->SetAttribute ("TrieLookup", BooleanValue (false));
+      Ptr<Ipv4Route> linear = routing->RouteOutput (0, header, oif, err);
+      routing->SetAttribute ("TrieLookup", BooleanValue (true));
+      Ptr<Ipv4Route> trie = routing->RouteOutput (0, header, oif, err);
+
+      NS_TEST_ASSERT_MSG_EQ ((trie == 0), (linear == 0), "Route found by only one lookup for " << header.GetDestination ());
+      if (linear != 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (trie->GetGateway (), linear->GetGateway (), "Different gateway for " << header.GetDestination ());
+          NS_TEST_EXPECT_MSG_EQ (trie->GetOutputDevice (), linear->GetOutputDevice (), "Different device for " << header.GetDestination ());
+        }
+    }
+
+  node->Dispose ();
+  Simulator::Destroy ();
+}
+
+class Ipv4GlobalRoutingTrieTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingTrieTestCase ();
+private:
+  struct Route
+  {
+    Ipv4Address network;
+    Ipv4Mask mask;
+    Ipv4Address gateway;
+    uint32_t interface;
+  };
+  /* the first route of routes which matches dest on oif, or -1 */
+  int32_t FindFirst (const std::vector<Route> &routes, Ipv4Address dest, uint32_t oif) const;
+  /* the first of the routes with the longest prefix which matches dest on oif, or -1 */
+  int32_t FindLongest (const std::vector<Route> &routes, Ipv4Address dest, uint32_t oif,
+                       uint32_t *nprefixes) const;
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingTrieTestCase::Ipv4GlobalRoutingTrieTestCase ()
+  : TestCase ("Check that global routing finds the same routes with and without the trie")
+{
+}
+
+int32_t
+Ipv4GlobalRoutingTrieTestCase::FindFirst (const std::vector<Route> &routes, Ipv4Address dest, uint32_t oif) const
+{
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      if (routes[i].mask.IsMatch (dest, routes[i].network) && (oif == 0 || oif == routes[i].interface))
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+int32_t
+Ipv4GlobalRoutingTrieTestCase::FindLongest (const std::vector<Route> &routes, Ipv4Address dest, uint32_t oif,
+                                            uint32_t *nprefixes) const
+{
+  int32_t longest = -1;
+  std::vector<bool> lengths (33, false);
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      if (routes[i].mask.IsMatch (dest, routes[i].network) && (oif == 0 || oif == routes[i].interface))
+        {
+          lengths[routes[i].mask.GetPrefixLength ()] = true;
+          if (longest < 0 || routes[i].mask.GetPrefixLength () > routes[longest].mask.GetPrefixLength ())
+            {
+              longest = i;
+            }
+        }
+    }
+  *nprefixes = std::count (lengths.begin (), lengths.end (), true);
+  return longest;
+}
+
+void
+Ipv4GlobalRoutingTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> u = CreateObject<UniformRandomVariable> ();
+  u->SetStream (3);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (CreateObject<ArpL3Protocol> ());
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  ipv4->SetRoutingProtocol (routing);
+  node->AggregateObject (ipv4);
+
+  std::vector<Ptr<NetDevice> > devices;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t interface = ipv4->AddInterface (device);
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address ((192u << 24) | (168u << 16) | (i << 8) | 1),
+                                                         Ipv4Mask ("255.255.255.0")));
+      ipv4->SetUp (interface);
+      devices.push_back (device);
+    }
+
+  // Host routes, /24 network routes which may repeat but do not nest,
+  // and external routes of any length which nest and overlap
+  std::vector<Route> hosts;
+  std::vector<Route> networks;
+  std::vector<Route> externals;
+  for (uint32_t i = 0; i < 600; i++)
+    {
+      if (i == 300)
+        {
+          routing->SetAttribute ("TrieLookup", BooleanValue (true));
+        }
+      Route route;
+      route.interface = u->GetInteger (1, devices.size ());
+      route.gateway = Ipv4Address ((192u << 24) | (168u << 16) | ((route.interface - 1) << 8) | u->GetInteger (2, 254));
+      uint32_t address = (10u << 24) | (u->GetInteger (0, 3) << 16) | u->GetInteger (0, 0xffff);
+      switch (i % 3)
+        {
+        case 0:
+          route.mask = Ipv4Mask::GetOnes ();
+          route.network = Ipv4Address (address);
+          routing->AddHostRouteTo (route.network, route.gateway, route.interface);
+          hosts.push_back (route);
+          break;
+        case 1:
+          route.mask = MakeMask (24);
+          route.network = Ipv4Address (address).CombineMask (route.mask);
+          routing->AddNetworkRouteTo (route.network, route.mask, route.gateway, route.interface);
+          networks.push_back (route);
+          break;
+        default:
+          route.mask = MakeMask (u->GetInteger (0, 3) ? u->GetInteger (8, 26) : 0);
+          route.network = Ipv4Address (address).CombineMask (route.mask);
+          routing->AddASExternalRouteTo (route.network, route.mask, route.gateway, route.interface);
+          externals.push_back (route);
+          break;
+        }
+    }
+
+  uint32_t nested = 0;
+  for (uint32_t n = 0; n < 2000; n++)
+    {
+      Ipv4Header header;
+      Ipv4Address dest;
+      if (n % 8 == 0)
+        {
+          dest = hosts[u->GetInteger (0, hosts.size () - 1)].network;
+        }
+      else
+        {
+          dest = Ipv4Address ((10u << 24) | (u->GetInteger (0, 3) << 16) | u->GetInteger (0, 0xffff));
+        }
+      header.SetDestination (dest);
+      uint32_t oifIndex = n % 4 == 0 ? u->GetInteger (1, devices.size ()) : 0;
+      Ptr<NetDevice> oif = oifIndex ? devices[oifIndex - 1] : Ptr<NetDevice> (0);
+      Socket::SocketErrno err;
+
+      // Host routes win over network routes, which win over external routes
+      const Route *expected = 0;
+      uint32_t nprefixes = 0;
+      int32_t i = FindFirst (hosts, dest, oifIndex);
+      if (i >= 0)
+        {
+          expected = &hosts[i];
+        }
+      else if ((i = FindFirst (networks, dest, oifIndex)) >= 0)
+        {
+          expected = &networks[i];
+        }
+      else if ((i = FindLongest (externals, dest, oifIndex, &nprefixes)) >= 0)
+        {
+          expected = &externals[i];
+        }
+
+      routing->SetAttribute ("TrieLookup", BooleanValue (false));
+      Ptr<Ipv4Route> linear = routing->RouteOutput (0, header, oif, err);
+      routing->SetAttribute ("TrieLookup", BooleanValue (true));
+      Ptr<Ipv4Route> trie = routing->RouteOutput (0, header, oif, err);
+
+      NS_TEST_ASSERT_MSG_EQ ((trie == 0), (expected == 0), "Wrong route found by the trie for " << dest);
+      NS_TEST_ASSERT_MSG_EQ ((linear == 0), (expected == 0), "Wrong route found by the linear lookup for " << dest);
+      if (expected == 0)
+        {
+          continue;
+        }
+      // The trie takes the longest external prefix
+      NS_TEST_EXPECT_MSG_EQ (trie->GetGateway (), expected->gateway, "Wrong gateway for " << dest);
+      NS_TEST_EXPECT_MSG_EQ (trie->GetOutputDevice (), devices[expected->interface - 1], "Wrong device for " << dest);
+      // whereas the linear lookup takes the first external route, so
+      // the two agree unless several external prefixes match
+      if (nprefixes > 1)
+        {
+          const Route &first = externals[FindFirst (externals, dest, oifIndex)];
+          NS_TEST_EXPECT_MSG_EQ (linear->GetGateway (), first.gateway, "Wrong linear gateway for " << dest);
+          nested++;
+          continue;
+        }
+      NS_TEST_EXPECT_MSG_EQ (trie->GetGateway (), linear->GetGateway (), "Different gateway for " << dest);
+      NS_TEST_EXPECT_MSG_EQ (trie->GetOutputDevice (), linear->GetOutputDevice (), "Different device for " << dest);
+    }
+  NS_TEST_EXPECT_MSG_GT (nested, 0, "No lookup matched nested external prefixes");
+
+  node->Dispose ();
+  Simulator::Destroy ();
+}
+
+static class Ipv4RoutingTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RoutingTrieTestSuite ()
+    : TestSuite ("ipv4-routing-trie", UNIT)
+  {
+    AddTestCase (new Ipv4RoutingTrieLookupTestCase ());
+    AddTestCase (new Ipv4StaticRoutingTrieTestCase ());
+    AddTestCase (new Ipv4GlobalRoutingTrieTestCase ());
+  }
+} g_ipv4RoutingTrieTestSuite;
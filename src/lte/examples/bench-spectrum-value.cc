@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Times the SpectrumValue arithmetic that one LTE receiver does every
+// TTI on a 100 RB spectrum model: it adds up the power spectral
+// densities of the eNBs it hears, works out the SINR of its own signal
+// against them and accumulates it over the TTI, like LteInterference and
+// the LteSinrChunkProcessor classes do.  This is done once with the usual
+// operators, which create a temporary SpectrumValue for every operation,
+// and once with the in-place kernels (AddAll, AssignSinr, AddProduct).
+// Both compute the same values, so their checksums must be equal.
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/lte-spectrum-value-helper.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace ns3;
+
+static double
+RunOperators (const SpectrumValue& signal, const std::vector<Ptr<const SpectrumValue> >& rx,
+              const SpectrumValue& noise, uint32_t ntti)
+{
+  double checksum = 0;
+  SpectrumValue all (noise.GetSpectrumModel ());
+  SpectrumValue sumSinr (noise.GetSpectrumModel ());
+  for (uint32_t t = 0; t < ntti; t++)
+    {
+      all = 0.0;
+      for (uint32_t k = 0; k < rx.size (); k++)
+        {
+          all += *rx[k];
+        }
+      SpectrumValue sinr = signal / (all - signal + noise);
+      sumSinr = 0.0;
+      sumSinr += sinr * 0.0005;
+      sumSinr += sinr * 0.0005;
+      checksum += Sum (sumSinr / 0.001);
+    }
+  return checksum;
+}
+
+static double
+RunKernels (const SpectrumValue& signal, const std::vector<Ptr<const SpectrumValue> >& rx,
+            const SpectrumValue& noise, uint32_t ntti)
+{
+  double checksum = 0;
+  SpectrumValue all (noise.GetSpectrumModel ());
+  SpectrumValue sinr (noise.GetSpectrumModel ());
+  SpectrumValue sumSinr (noise.GetSpectrumModel ());
+  for (uint32_t t = 0; t < ntti; t++)
+    {
+      all = 0.0;
+      all.AddAll (rx);
+      sinr.AssignSinr (signal, all, noise);
+      sumSinr = 0.0;
+      sumSinr.AddProduct (sinr, 0.0005);
+      sumSinr.AddProduct (sinr, 0.0005);
+      sumSinr /= 0.001;
+      checksum += Sum (sumSinr);
+    }
+  return checksum;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nenbs = 10;
+  uint32_t ntti = 200000;
+  uint16_t earfcn = 100;
+  uint8_t bandwidth = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("enbs", "Number of eNBs heard by the receiver, including its own", nenbs);
+  cmd.AddValue ("ttis", "Number of TTIs to evaluate", ntti);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<int> activeRbs;
+  for (int i = 0; i < bandwidth; i++)
+    {
+      activeRbs.push_back (i);
+    }
+
+  // every eNB transmits on all the RBs, and is received with a random path loss
+  std::vector<Ptr<const SpectrumValue> > rx;
+  for (uint32_t k = 0; k < nenbs; k++)
+    {
+      Ptr<SpectrumValue> psd = LteSpectrumValueHelper::CreateTxPowerSpectralDensity (earfcn, bandwidth, 30.0, activeRbs);
+      (*psd) *= std::pow (10.0, -random->GetValue (80.0, 140.0) / 10.0);
+      rx.push_back (psd);
+    }
+  Ptr<SpectrumValue> noise = LteSpectrumValueHelper::CreateNoisePowerSpectralDensity (earfcn, bandwidth, 9.0);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  double operatorsChecksum = RunOperators (*rx[0], rx, *noise, ntti);
+  int64_t operatorsMs = clock.End ();
+
+  clock.Start ();
+  double kernelsChecksum = RunKernels (*rx[0], rx, *noise, ntti);
+  int64_t kernelsMs = clock.End ();
+
+  std::cout << (uint32_t)bandwidth << " RBs, " << nenbs << " eNBs, " << ntti << " TTIs" << std::endl;
+  std::cout << "operators: " << operatorsMs << " ms, "
+            << operatorsMs * 1000000.0 / ntti << " ns/TTI, checksum "
+            << std::setprecision (17) << operatorsChecksum << std::setprecision (6) << std::endl;
+  std::cout << "kernels:   " << kernelsMs << " ms, "
+            << kernelsMs * 1000000.0 / ntti << " ns/TTI, checksum "
+            << std::setprecision (17) << kernelsChecksum << std::setprecision (6) << std::endl;
+
+  return 0;
+}
@@ -76,7 +76,7 @@ LteCtrlSinrChunkProcessor::EvaluateSinrChunk (const SpectrumValue& sinr, Time du
     {
       m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
     }
-  (*m_sumSinr) += sinr * duration.GetSeconds ();
+  m_sumSinr->AddProduct (sinr, duration.GetSeconds ());
   m_totDuration += duration;
 }
  
@@ -144,7 +144,7 @@ LteDataSinrChunkProcessor::EvaluateSinrChunk (const SpectrumValue& sinr, Time du
   {
     m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
   }
-  (*m_sumSinr) += sinr * duration.GetSeconds ();
+  m_sumSinr->AddProduct (sinr, duration.GetSeconds ());
   m_totDuration += duration;
 }
 
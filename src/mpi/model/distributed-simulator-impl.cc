@@ -105,6 +105,7 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
   m_events = 0;
+  EventImpl::BindToCurrentThread ();
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl ()
@@ -271,6 +272,7 @@ void
 DistributedSimulatorImpl::Run (void)
 {
 #ifdef NS3_MPI
+  EventImpl::BindToCurrentThread ();
   CalculateLookAhead ();
   m_stop = false;
   while (!m_events->IsEmpty () && !m_stop)
@@ -65,4 +65,24 @@
  * current node extracts the appropriate neighbor-index from the 
  * nix-vector and transmits the packet through the corresponding 
  * net-device.  This continues until the packet reaches the destination.
+ *
+ * The breadth-first search does not walk the channels of the nodes.  
+ * All the nodes share a compressed-sparse-row snapshot of the 
+ * node/channel graph, built on the first route computation and rebuilt 
+ * after addresses are added or removed.  Interfaces going up or down 
+ * only update the entries of their own device.  The link state of the 
+ * devices is not part of the snapshot: the search asks each device it 
+ * leaves a node through, since not all devices report link changes.  
+ * With the CacheAllDestinations attribute set, a cache miss runs the 
+ * search to completion and caches the nix-vectors to every reachable 
+ * node.
+ *
+ * By default each node caches the nix-vectors it built, and any 
+ * interface going up or down flushes the caches of all the nodes.  With 
+ * the SharedCache attribute set, the nix-vectors are instead kept in a 
+ * single cache keyed by source and destination node, which also records 
+ * the links (node and device) each path goes out through.  An interface 
+ * going down then only evicts the paths through its device, along with 
+ * the Ipv4Routes cached for them at the nodes along the way; an interface 
+ * coming up still flushes everything, as it may shorten any path.
  * */
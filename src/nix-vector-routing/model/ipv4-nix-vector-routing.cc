@@ -26,6 +26,7 @@
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/boolean.h"
+#include "ns3/ipv4-address-index.h"
 
 #include "ipv4-nix-vector-routing.h"
 
@@ -35,6 +36,8 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
+const uint32_t Ipv4NixVectorRouting::NO_PARENT;
+
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
 {
@@ -42,16 +45,31 @@ Ipv4NixVectorRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .AddConstructor<Ipv4NixVectorRouting> ()
     .AddAttribute ("FollowDownEdges", 
-                   "If true, the BFS will follow down links and interfaces",
+                   "If true, the BFS will follow down links and interfaces, and no cache is "
+                   "flushed or evicted when they go down or when addresses change",
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4NixVectorRouting::m_followDownEdges),
                    MakeBooleanChecker ())
+    .AddAttribute ("CacheAllDestinations",
+                   "If true, a route lookup that misses the cache runs the BFS to completion "
+                   "and caches the nix-vectors to every node reachable from this one",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4NixVectorRouting::m_cacheAllDestinations),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SharedCache",
+                   "If true, nix-vectors are kept in a single cache shared by all the nodes, "
+                   "keyed by source and destination node, and an interface going down only "
+                   "evicts the cached paths that went out through it.  With FollowDownEdges "
+                   "nothing is evicted, as down interfaces stay in the paths",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4NixVectorRouting::m_sharedCache),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0), m_followDownEdges(false)
+  : m_totalNeighbors (0), m_followDownEdges(false), m_cacheAllDestinations (false), m_sharedCache (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -78,6 +96,8 @@ Ipv4NixVectorRouting::DoDispose ()
 
   m_node = 0;
   m_ipv4 = 0;
+  InvalidateGraph ();
+  ClearSharedCache ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -102,6 +122,8 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache ()
       return;
     }
 
+  ClearSharedCache ();
+
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -160,9 +182,18 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     {
       // otherwise proceed as normal 
       // and build the nix vector
-      std::vector< Ptr<Node> > parentVector;
+      std::vector<uint32_t> parentVector;
+
+      // without a specific output interface, the same search
+      // can give us the routes to every other node at once
+      bool allDestinations = m_cacheAllDestinations && !oif && source == m_node;
+
+      BFS (NodeList::GetNNodes (), source, allDestinations ? 0 : destNode, parentVector, oif);
 
-      BFS (NodeList::GetNNodes (), source, destNode, parentVector, oif);
+      if (allDestinations)
+        {
+          CacheAllNixVectors (parentVector, source->GetId ());
+        }
 
       if (BuildNixVector (parentVector, source->GetId (), destNode->GetId (), nixVector))
         {
@@ -236,7 +267,8 @@ Ipv4NixVectorRouting::BuildNixVectorLocal (Ptr<NixVector> nixVector)
 }
 
 bool
-Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector)
+Ipv4NixVectorRouting::BuildNixVector (const std::vector<uint32_t> & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector,
+                                      std::vector<uint64_t> *links)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -245,67 +277,94 @@ Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVec
       return true;
     }
 
-  if (parentVector.at (dest) == 0)
+  if (parentVector.at (dest) == NO_PARENT)
     {
       return false;
     }
 
-  Ptr<Node> parentNode = parentVector.at (dest);
+  const Graph &graph = GetGraph ();
 
-  uint32_t numberOfDevices = parentNode->GetNDevices ();
-  uint32_t destId = 0;
-  uint32_t totalNeighbors = 0;
+  // walk back the path from the destination, adding
+  // the index of each hop as seen from its parent
+  while (dest != source)
+    {
+      uint32_t parent = parentVector.at (dest);
+      uint32_t destId = 0;
+      uint32_t destEntry = graph.offsets[parent];
+      uint32_t totalNeighbors = 0;
+
+      // the neighbor index counts the entries of all the
+      // non-bridge devices of the parent node
+      for (uint32_t entry = graph.offsets[parent]; entry < graph.offsets[parent + 1]; entry++)
+        {
+          if (graph.flags[entry] & Graph::ENTRY_BRIDGE)
+            {
+              continue;
+            }
+          if (graph.neighbors[entry] == dest)
+            {
+              destId = totalNeighbors;
+              destEntry = entry;
+            }
+          totalNeighbors++;
+        }
 
-  // scan through the net devices on the parent node
-  // and then look at the nodes adjacent to them
-  for (uint32_t i = 0; i < numberOfDevices; i++)
+      NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parent);
+      nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
+
+      if (links)
+        {
+          links->push_back (LinkKey (parent, graph.devices[destEntry]));
+        }
+
+      dest = parent;
+    }
+
+  return true;
+}
+
+void
+Ipv4NixVectorRouting::CacheAllNixVectors (const std::vector<uint32_t> & parentVector, uint32_t source)
+{
+  NS_LOG_FUNCTION (source);
+
+  Ipv4Address loopback = Ipv4Address::GetLoopback ();
+
+  // nodes are visited in id order so that an address configured on
+  // several nodes goes to the lowest id, as with GetNodeByIp
+  for (uint32_t dest = 0; dest < parentVector.size (); dest++)
     {
-      // Get a net device from the node
-      // as well as the channel, and figure
-      // out the adjacent net devices
-      Ptr<NetDevice> localNetDevice = parentNode->GetDevice (i);
-      if (localNetDevice->IsBridge ())
+      if (dest == source || parentVector[dest] == NO_PARENT)
         {
           continue;
         }
-      Ptr<Channel> channel = localNetDevice->GetChannel ();
-      if (channel == 0)
+
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (dest)->GetObject<Ipv4> ();
+      if (!ipv4)
         {
           continue;
         }
 
-      // this function takes in the local net dev, and channnel, and
-      // writes to the netDeviceContainer the adjacent net devs
-      NetDeviceContainer netDeviceContainer;
-      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
-      // Finally we can get the adjacent nodes
-      // and scan through them.  If we find the 
-      // node that matches "dest" then we can add 
-      // the index  to the nix vector.
-      // the index corresponds to the neighbor index
-      uint32_t offset = 0;
-      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+      Ptr<NixVector> nixVector;
+      for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
         {
-          Ptr<Node> remoteNode = (*iter)->GetNode ();
-
-          if (remoteNode->GetId () == dest)
+          for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
             {
-              destId = totalNeighbors + offset;
+              Ipv4Address address = ipv4->GetAddress (i, j).GetLocal ();
+              if (address == loopback || m_nixCache.find (address) != m_nixCache.end ())
+                {
+                  continue;
+                }
+              if (!nixVector)
+                {
+                  nixVector = Create<NixVector> ();
+                  BuildNixVector (parentVector, source, dest, nixVector);
+                }
+              m_nixCache.insert (NixMap_t::value_type (address, nixVector));
             }
-          offset += 1;
         }
-
-      totalNeighbors += netDeviceContainer.GetN ();
     }
-  NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
-                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
-  nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
-
-  // recurse through parent vector, grabbing the path 
-  // and building the nix vector
-  BuildNixVector (parentVector, source, (parentVector.at (dest))->GetId (), nixVector);
-  return true;
 }
 
 void
@@ -353,19 +412,7 @@ Ipv4NixVectorRouting::GetNodeByIp (Ipv4Address dest)
 { 
   NS_LOG_FUNCTION_NOARGS ();
 
-  NodeContainer allNodes = NodeContainer::GetGlobal ();
-  Ptr<Node> destNode;
-
-  for (NodeContainer::Iterator i = allNodes.Begin (); i != allNodes.End (); ++i)
-    {
-      Ptr<Node> node = *i;
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetInterfaceForAddress (dest) != -1)
-        {
-          destNode = node;
-          break;
-        }
-    }
+  Ptr<Node> destNode = Ipv4AddressIndex::GetNode (dest);
 
   if (!destNode)
     {
@@ -502,19 +549,32 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
   Ptr<NixVector> nixVectorForPacket;
 
   NS_LOG_DEBUG ("Dest IP from header: " << header.GetDestination ());
-  // check if cache
-  nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
-
-  // not in cache
-  if (!nixVectorInCache)
+  if (oif)
     {
-      NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
-      // Build the nix-vector, given this node and the
-      // dest IP address
+      // routes through a specific output interface may differ
+      // from the usual path, so they are built every time
       nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
+    }
+  else if (m_sharedCache)
+    {
+      nixVectorInCache = GetSharedNixVector (header.GetDestination ());
+    }
+  else
+    {
+      // check if cache
+      nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
+
+      // not in cache
+      if (!nixVectorInCache)
+        {
+          NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
+          // Build the nix-vector, given this node and the
+          // dest IP address
+          nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
 
-      // cache it
-      m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+          // cache it
+          m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+        }
     }
 
   // path exists
@@ -714,176 +774,472 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
           *os << std::endl;
         }
     }
+
+  if (m_sharedCache && m_node)
+    {
+      const SharedCache &cache = GetSharedCache ();
+      uint32_t source = m_node->GetId ();
+      *os << "SharedNixCache:" << std::endl;
+      SharedCache::PathMap_t::const_iterator it = cache.paths.lower_bound (PathKey (source, 0));
+      if (it != cache.paths.end () && it->first < PathKey (source + 1, 0))
+        {
+          *os << "DestinationNode NixVector" << std::endl;
+        }
+      for (; it != cache.paths.end () && it->first < PathKey (source + 1, 0); it++)
+        {
+          std::ostringstream dest;
+          dest << (uint32_t)(it->first & 0xffffffff);
+          *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
+          *os << *(it->second.nixVector) << std::endl;
+        }
+    }
 }
 
 // virtual functions from Ipv4RoutingProtocol 
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
+  UpdateGraphEntries (i);
   FlushGlobalNixRoutingCache ();
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
+  UpdateGraphEntries (i);
+  if (m_sharedCache)
+    {
+      // taking a link away can only break the paths that used it
+      if (!m_followDownEdges && m_node && m_ipv4)
+        {
+          uint32_t evicted = EvictSharedPaths (m_node->GetId (), m_ipv4->GetNetDevice (i)->GetIfIndex ());
+          NS_LOG_LOGIC ("Evicted " << evicted << " shared paths through interface " << i << " of node " << m_node->GetId ());
+        }
+      return;
+    }
   FlushGlobalNixRoutingCache ();
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  // a new address usually comes with a new device or link
+  InvalidateGraph ();
   FlushGlobalNixRoutingCache ();
 }
 void
 Ipv4NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  InvalidateGraph ();
   FlushGlobalNixRoutingCache ();
 }
 
-bool
-Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source, 
-                           Ptr<Node> dest, std::vector< Ptr<Node> > & parentVector,
-                           Ptr<NetDevice> oif)
+Ipv4NixVectorRouting::Graph::Graph ()
+  : valid (false)
+{
+}
+
+// The graph and the shared cache are used when the nodes are disposed of,
+// which may happen in the NodeList finalizer at process exit, so they are
+// never deleted rather than left to an earlier static finalizer.
+Ipv4NixVectorRouting::Graph &
+Ipv4NixVectorRouting::GetGraph (void)
+{
+  static Graph *graph = new Graph ();
+  return *graph;
+}
+
+void
+Ipv4NixVectorRouting::InvalidateGraph (void)
+{
+  GetGraph ().valid = false;
+}
+
+const Ipv4NixVectorRouting::Graph &
+Ipv4NixVectorRouting::GetValidGraph (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  NS_LOG_LOGIC ("Going from Node " << source->GetId () << " to Node " << dest->GetId ());
-  std::queue< Ptr<Node> > greyNodeList;  // discovered nodes with unexplored children
+  Graph &graph = GetGraph ();
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
 
-  // reset the parent vector
-  parentVector.clear ();
-  parentVector.reserve (sizeof (Ptr<Node>)*numberOfNodes);
-  parentVector.insert (parentVector.begin (), sizeof (Ptr<Node>)*numberOfNodes, 0); // initialize to 0
+  if (graph.valid && graph.offsets.size () == numberOfNodes + 1)
+    {
+      return graph;
+    }
 
-  // Add the source node to the queue, set its parent to itself 
-  greyNodeList.push (source);
-  parentVector.at (source->GetId ()) = source;
+  NS_LOG_LOGIC ("Building graph of " << numberOfNodes << " nodes");
 
-  // BFS loop
-  while (greyNodeList.size () != 0)
+  graph.offsets.clear ();
+  graph.neighbors.clear ();
+  graph.devices.clear ();
+  graph.flags.clear ();
+  graph.offsets.reserve (numberOfNodes + 1);
+
+  for (uint32_t id = 0; id < numberOfNodes; id++)
     {
-      Ptr<Node> currNode = greyNodeList.front ();
-      Ptr<Ipv4> ipv4 = currNode->GetObject<Ipv4> ();
- 
-      if (currNode == dest) 
-        {
-          NS_LOG_LOGIC ("Made it to Node " << currNode->GetId ());
-          return true;
-        }
+      graph.offsets.push_back (graph.neighbors.size ());
 
-      // if this is the first iteration of the loop and a 
-      // specific output interface was given, make sure 
-      // we go this way
-      if (currNode == source && oif)
+      Ptr<Node> node = NodeList::GetNode (id);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
         {
-          // make sure that we can go this way
-          if (ipv4)
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
             {
-              uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (oif);
-              if (!m_followDownEdges && !ipv4->IsUp (interfaceIndex))
-                {
-                  NS_LOG_LOGIC ("Ipv4Interface is down");
-                  return false;
-                }
+              continue;
             }
-          if (!m_followDownEdges && !oif->IsLinkUp ())
+
+          uint8_t flags = 0;
+          if (localNetDevice->IsBridge ())
             {
-              NS_LOG_LOGIC ("Link is down.");
-              return false;
+              flags |= Graph::ENTRY_BRIDGE;
             }
-          Ptr<Channel> channel = oif->GetChannel ();
-          if (channel == 0)
-            { 
-              return false;
+          int32_t interfaceIndex = ipv4 ? ipv4->GetInterfaceForDevice (localNetDevice) : -1;
+          if (interfaceIndex < 0 || ipv4->IsUp (interfaceIndex))
+            {
+              flags |= Graph::ENTRY_UP;
             }
 
-          // this function takes in the local net dev, and channnel, and
-          // writes to the netDeviceContainer the adjacent net devs
           NetDeviceContainer netDeviceContainer;
-          GetAdjacentNetDevices (oif, channel, netDeviceContainer);
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
 
-          // Finally we can get the adjacent nodes
-          // and scan through them.  We push them
-          // to the greyNode queue, if they aren't 
-          // already there.
           for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
             {
-              Ptr<Node> remoteNode = (*iter)->GetNode ();
-
-              // check to see if this node has been pushed before
-              // by checking to see if it has a parent
-              // if it doesn't (null or 0), then set its parent and 
-              // push to the queue
-              if (parentVector.at (remoteNode->GetId ()) == 0)
-                {
-                  parentVector.at (remoteNode->GetId ()) = currNode;
-                  greyNodeList.push (remoteNode);
-                }
+              graph.neighbors.push_back ((*iter)->GetNode ()->GetId ());
+              graph.devices.push_back (i);
+              graph.flags.push_back (flags);
             }
         }
+    }
+
+  graph.offsets.push_back (graph.neighbors.size ());
+  graph.valid = true;
+
+  return graph;
+}
+
+void
+Ipv4NixVectorRouting::UpdateGraphEntries (uint32_t interface)
+{
+  NS_LOG_FUNCTION (interface);
+
+  Graph &graph = GetGraph ();
+  if (!graph.valid || !m_node || !m_ipv4)
+    {
+      // will be built with the current state when next needed
+      return;
+    }
+
+  uint32_t id = m_node->GetId ();
+  if (id + 1 >= graph.offsets.size ())
+    {
+      InvalidateGraph ();
+      return;
+    }
+
+  Ptr<NetDevice> device = m_ipv4->GetNetDevice (interface);
+  bool up = m_ipv4->IsUp (interface);
+
+  for (uint32_t entry = graph.offsets[id]; entry < graph.offsets[id + 1]; entry++)
+    {
+      if (graph.devices[entry] != device->GetIfIndex ())
+        {
+          continue;
+        }
+      if (up)
+        {
+          graph.flags[entry] |= Graph::ENTRY_UP;
+        }
       else
         {
-          // Iterate over the current node's adjacent vertices
-          // and push them into the queue
-          for (uint32_t i = 0; i < (currNode->GetNDevices ()); i++)
+          graph.flags[entry] &= ~Graph::ENTRY_UP;
+        }
+    }
+}
+
+Ipv4NixVectorRouting::SharedCache &
+Ipv4NixVectorRouting::GetSharedCache (void)
+{
+  static SharedCache *cache = new SharedCache ();
+  return *cache;
+}
+
+uint64_t
+Ipv4NixVectorRouting::PathKey (uint32_t source, uint32_t dest)
+{
+  return (static_cast<uint64_t> (source) << 32) | dest;
+}
+
+uint64_t
+Ipv4NixVectorRouting::LinkKey (uint32_t node, uint32_t device)
+{
+  return (static_cast<uint64_t> (node) << 32) | device;
+}
+
+Ptr<NixVector>
+Ipv4NixVectorRouting::GetSharedNixVector (Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (dest);
+
+  Ptr<Node> destNode = GetNodeByIp (dest);
+  if (destNode == 0)
+    {
+      NS_LOG_ERROR ("No routing path exists");
+      return 0;
+    }
+
+  uint32_t source = m_node->GetId ();
+  SharedCache &cache = GetSharedCache ();
+  SharedCache::PathMap_t::iterator iter = cache.paths.find (PathKey (source, destNode->GetId ()));
+  if (iter != cache.paths.end ())
+    {
+      NS_LOG_LOGIC ("Found Nix-vector in shared cache.");
+      return iter->second.nixVector;
+    }
+
+  NS_LOG_LOGIC ("Nix-vector not in shared cache, build: ");
+
+  if (destNode == m_node)
+    {
+      Ptr<NixVector> nixVector = Create<NixVector> ();
+      BuildNixVectorLocal (nixVector);
+      SharedCache::Path &path = cache.paths[PathKey (source, source)];
+      path.nixVector = nixVector;
+      return nixVector;
+    }
+
+  std::vector<uint32_t> parentVector;
+  BFS (NodeList::GetNNodes (), m_node, m_cacheAllDestinations ? 0 : destNode, parentVector, 0);
+
+  if (m_cacheAllDestinations)
+    {
+      for (uint32_t id = 0; id < parentVector.size (); id++)
+        {
+          if (id != source && id != destNode->GetId () && parentVector[id] != NO_PARENT
+              && cache.paths.find (PathKey (source, id)) == cache.paths.end ())
             {
-              // Get a net device from the node
-              // as well as the channel, and figure
-              // out the adjacent net device
-              Ptr<NetDevice> localNetDevice = currNode->GetDevice (i);
+              InsertSharedPath (parentVector, source, id);
+            }
+        }
+    }
+
+  return InsertSharedPath (parentVector, source, destNode->GetId ());
+}
+
+Ptr<NixVector>
+Ipv4NixVectorRouting::InsertSharedPath (const std::vector<uint32_t> & parentVector, uint32_t source, uint32_t dest)
+{
+  NS_LOG_FUNCTION (source << dest);
+
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  std::vector<uint64_t> links;
+  if (!BuildNixVector (parentVector, source, dest, nixVector, &links))
+    {
+      // unreachable destinations are not cached, as with m_nixCache
+      NS_LOG_ERROR ("No routing path exists");
+      return 0;
+    }
+
+  SharedCache &cache = GetSharedCache ();
+  uint64_t key = PathKey (source, dest);
+  SharedCache::Path &path = cache.paths[key];
+  path.nixVector = nixVector;
+  path.links.swap (links);
+
+  for (std::vector<uint64_t>::const_iterator link = path.links.begin (); link != path.links.end (); link++)
+    {
+      cache.pathsByLink[*link].insert (key);
+    }
+
+  return nixVector;
+}
+
+uint32_t
+Ipv4NixVectorRouting::EvictSharedPaths (uint32_t node, uint32_t device)
+{
+  NS_LOG_FUNCTION (node << device);
+
+  SharedCache &cache = GetSharedCache ();
+  SharedCache::LinkMap_t::iterator byLink = cache.pathsByLink.find (LinkKey (node, device));
+  if (byLink == cache.pathsByLink.end ())
+    {
+      return 0;
+    }
+
+  std::set<uint64_t> evicted;
+  evicted.swap (byLink->second);
+  cache.pathsByLink.erase (byLink);
 
-              // make sure that we can go this way
-              if (ipv4)
+  for (std::set<uint64_t>::const_iterator key = evicted.begin (); key != evicted.end (); key++)
+    {
+      SharedCache::PathMap_t::iterator path = cache.paths.find (*key);
+      if (path == cache.paths.end ())
+        {
+          continue;
+        }
+
+      // the Ipv4Routes cached along the path for the
+      // destination's addresses may not be valid anymore
+      Ptr<Ipv4> destIpv4 = NodeList::GetNode (*key & 0xffffffff)->GetObject<Ipv4> ();
+
+      for (std::vector<uint64_t>::const_iterator link = path->second.links.begin (); link != path->second.links.end (); link++)
+        {
+          SharedCache::LinkMap_t::iterator other = cache.pathsByLink.find (*link);
+          if (other != cache.pathsByLink.end ())
+            {
+              other->second.erase (*key);
+              if (other->second.empty ())
                 {
-                  uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (currNode->GetDevice (i));
-                  if (!m_followDownEdges && !ipv4->IsUp (interfaceIndex))
-                    {
-                      NS_LOG_LOGIC ("Ipv4Interface is down");
-                      continue;
-                    }
+                  cache.pathsByLink.erase (other);
                 }
-              if (!m_followDownEdges && !localNetDevice->IsLinkUp ())
+            }
+
+          Ptr<Ipv4NixVectorRouting> rp = NodeList::GetNode (*link >> 32)->GetObject<Ipv4NixVectorRouting> ();
+          if (!rp || !destIpv4)
+            {
+              continue;
+            }
+          for (uint32_t i = 0; i < destIpv4->GetNInterfaces (); i++)
+            {
+              for (uint32_t j = 0; j < destIpv4->GetNAddresses (i); j++)
                 {
-                  NS_LOG_LOGIC ("Link is down.");
-                  continue;
-                }
-              Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
-                { 
-                  continue;
+                  rp->m_ipv4RouteCache.erase (destIpv4->GetAddress (i, j).GetLocal ());
                 }
+            }
+        }
 
-              // this function takes in the local net dev, and channnel, and
-              // writes to the netDeviceContainer the adjacent net devs
-              NetDeviceContainer netDeviceContainer;
-              GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+      cache.paths.erase (path);
+    }
 
-              // Finally we can get the adjacent nodes
-              // and scan through them.  We push them
-              // to the greyNode queue, if they aren't 
-              // already there.
-              for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
-                {
-                  Ptr<Node> remoteNode = (*iter)->GetNode ();
+  return evicted.size ();
+}
+
+void
+Ipv4NixVectorRouting::ClearSharedCache (void)
+{
+  SharedCache &cache = GetSharedCache ();
+  cache.paths.clear ();
+  cache.pathsByLink.clear ();
+}
+
+bool
+Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source, 
+                           Ptr<Node> dest, std::vector<uint32_t> & parentVector,
+                           Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  const Graph &graph = GetValidGraph ();
+  NS_ASSERT (graph.offsets.size () == numberOfNodes + 1);
+
+  uint32_t sourceId = source->GetId ();
+  uint32_t destId = dest ? dest->GetId () : NO_PARENT;
+
+  NS_LOG_LOGIC ("Going from Node " << sourceId << " to Node " << (dest ? destId : sourceId));
+
+  // reset the parent vector
+  parentVector.assign (numberOfNodes, NO_PARENT);
+
+  // discovered nodes with unexplored children are
+  // those between the head and the end of the queue
+  std::vector<uint32_t> greyNodeList;
+  greyNodeList.reserve (numberOfNodes);
+  uint32_t head = 0;
+
+  // Add the source node to the queue, set its parent to itself 
+  greyNodeList.push_back (sourceId);
+  parentVector[sourceId] = sourceId;
+
+  // if a specific output interface was given,
+  // the first hop must go this way
+  if (oif)
+    {
+      uint32_t oifIndex = oif->GetIfIndex ();
+      bool found = false;
+
+      for (uint32_t entry = graph.offsets[sourceId]; entry < graph.offsets[sourceId + 1]; entry++)
+        {
+          if (graph.devices[entry] != oifIndex)
+            {
+              continue;
+            }
+          found = true;
+          if (!m_followDownEdges && (!(graph.flags[entry] & Graph::ENTRY_UP) || !oif->IsLinkUp ()))
+            {
+              NS_LOG_LOGIC ("Ipv4Interface or link is down");
+              return false;
+            }
+
+          uint32_t remoteNode = graph.neighbors[entry];
+          if (parentVector[remoteNode] == NO_PARENT)
+            {
+              parentVector[remoteNode] = sourceId;
+              greyNodeList.push_back (remoteNode);
+            }
+        }
+
+      if (!found)
+        {
+          return false;
+        }
+
+      head++;
+    }
+
+  // BFS loop
+  while (head < greyNodeList.size ())
+    {
+      uint32_t currNode = greyNodeList[head++];
 
-                  // check to see if this node has been pushed before
-                  // by checking to see if it has a parent
-                  // if it doesn't (null or 0), then set its parent and 
-                  // push to the queue
-                  if (parentVector.at (remoteNode->GetId ()) == 0)
+      if (currNode == destId) 
+        {
+          NS_LOG_LOGIC ("Made it to Node " << currNode);
+          return true;
+        }
+
+      // Iterate over the current node's adjacent vertices
+      // and push them into the queue, if they haven't
+      // been pushed before (i.e. they don't have a parent)
+      Ptr<Node> node;
+      uint32_t linkDevice = 0xffffffff; // none checked yet
+      bool linkUp = false;
+      for (uint32_t entry = graph.offsets[currNode]; entry < graph.offsets[currNode + 1]; entry++)
+        {
+          if (!m_followDownEdges)
+            {
+              if (!(graph.flags[entry] & Graph::ENTRY_UP))
+                {
+                  continue;
+                }
+              // devices do not all tell when their link changes, so it is
+              // checked now, once for the entries of each device
+              if (graph.devices[entry] != linkDevice)
+                {
+                  if (node == 0)
                     {
-                      parentVector.at (remoteNode->GetId ()) = currNode;
-                      greyNodeList.push (remoteNode);
+                      node = NodeList::GetNode (currNode);
                     }
+                  linkDevice = graph.devices[entry];
+                  linkUp = node->GetDevice (linkDevice)->IsLinkUp ();
+                }
+              if (!linkUp)
+                {
+                  continue;
                 }
             }
-        }
 
-      // Pop off the head grey node.  We have all its children.
-      // It is now black.
-      greyNodeList.pop ();
+          uint32_t remoteNode = graph.neighbors[entry];
+          if (parentVector[remoteNode] == NO_PARENT)
+            {
+              parentVector[remoteNode] = currNode;
+              greyNodeList.push_back (remoteNode);
+            }
+        }
     }
 
-  // Didn't find the dest...
-  return false;
+  // Didn't find the dest (or visited every node)...
+  return dest == 0;
 }
 
 } // namespace ns3
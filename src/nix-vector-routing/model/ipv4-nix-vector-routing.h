@@ -22,6 +22,8 @@
 #define IPV4_NIX_VECTOR_ROUTING_H
 
 #include <map>
+#include <set>
+#include <vector>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -68,7 +70,7 @@ public:
   /**
    * @brief Called when run-time link topology change occurs
    * which iterates through the node list and flushes any
-   * nix vector caches
+   * nix vector caches, including the shared one
    *
    */
   void FlushGlobalNixRoutingCache (void);
@@ -102,12 +104,15 @@ private:
    * essentially getting the neighbors on that channel */
   void GetAdjacentNetDevices (Ptr<NetDevice>, Ptr<Channel>, NetDeviceContainer &);
 
-  /* iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address */
+  /* finds the node corresponding to the given Ipv4Address
+   * in the global Ipv4AddressIndex */
   Ptr<Node> GetNodeByIp (Ipv4Address);
 
-  /* Recurses the parent vector, created by BFS and actually builds the nixvector */
-  bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
+  /* Walks the parent vector, created by BFS, back from dest to source
+   * and actually builds the nixvector.  If links is not null, the
+   * LinkKey of the device taken at each hop is appended to it */
+  bool BuildNixVector (const std::vector<uint32_t> & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector,
+                       std::vector<uint64_t> *links = 0);
 
   /* special variation of BuildNixVector for when a node is sending to itself */
   bool BuildNixVectorLocal (Ptr<NixVector> nixVector);
@@ -124,20 +129,103 @@ private:
    * derived from this */
   uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp);
 
-  /* Breadth first search algorithm
+  /* Breadth first search algorithm over the shared graph
    * Param1: total number of nodes
    * Param2: Source Node
-   * Param3: Dest Node
-   * Param4: (returned) Parent vector for retracing routes
+   * Param3: Dest Node, or 0 to visit every node reachable from the source
+   * Param4: (returned) Parent vector of node ids for retracing routes,
+   *         NO_PARENT for the nodes that were not reached
    * Param5: specific output interface to use from source node, if not null
    * Returns: false if dest not found, true o.w.
    */
   bool BFS (uint32_t numberOfNodes,
             Ptr<Node> source,
             Ptr<Node> dest,
-            std::vector< Ptr<Node> > & parentVector,
+            std::vector<uint32_t> & parentVector,
             Ptr<NetDevice> oif);
 
+  /* builds nix-vectors from a complete BFS of the source to every
+   * other node, and caches them for all the addresses of those nodes */
+  void CacheAllNixVectors (const std::vector<uint32_t> & parentVector, uint32_t source);
+
+  static const uint32_t NO_PARENT = 0xffffffff;
+
+  /* Compressed-sparse-row snapshot of the node/channel graph that the
+   * BFS runs on, shared by all the nodes.  The entries of a node are its
+   * (device, adjacent node) pairs, in the order of its devices and then
+   * of the devices adjacent to them, so the position of an entry among
+   * the node's non-bridge entries is the neighbor index used in nix-vectors. */
+  struct Graph
+  {
+    enum EntryFlags
+    {
+      ENTRY_UP = 1,     // interface of the device was up when last notified; its link is checked by the BFS
+      ENTRY_BRIDGE = 2  // device is a bridge (not counted in neighbor indices)
+    };
+
+    Graph ();
+
+    bool valid;
+    std::vector<uint32_t> offsets;   // first entry of each node, by node id, plus one past the last entry
+    std::vector<uint32_t> neighbors; // id of the adjacent node of each entry
+    std::vector<uint32_t> devices;   // index of the local net device of each entry
+    std::vector<uint8_t> flags;      // EntryFlags of each entry
+  };
+
+  /* the shared graph, which may need to be (re)built */
+  static Graph & GetGraph (void);
+
+  /* marks the shared graph for rebuilding before the next BFS */
+  static void InvalidateGraph (void);
+
+  /* returns the shared graph, (re)building it first if needed */
+  const Graph & GetValidGraph (void);
+
+  /* refreshes the up flag of the graph entries of the device
+   * behind the given interface of this node; the link state of the
+   * devices is not kept, as it can change without notice */
+  void UpdateGraphEntries (uint32_t interface);
+
+  /* Cache of nix-vectors shared by the nodes using SharedCache, keyed
+   * by (source node, destination node), with a reverse index from the
+   * links (node, device) to the cached paths going out through them */
+  struct SharedCache
+  {
+    struct Path
+    {
+      Ptr<NixVector> nixVector;
+      std::vector<uint64_t> links; // LinkKey of each hop, from the destination back
+    };
+    typedef std::map<uint64_t, Path> PathMap_t;
+    typedef std::map<uint64_t, std::set<uint64_t> > LinkMap_t;
+
+    PathMap_t paths;
+    LinkMap_t pathsByLink;
+  };
+
+  static SharedCache & GetSharedCache (void);
+
+  /* the keys of the shared cache: a (source, destination) node pair
+   * for paths and a (node, device index) pair for links */
+  static uint64_t PathKey (uint32_t source, uint32_t dest);
+  static uint64_t LinkKey (uint32_t node, uint32_t device);
+
+  /* checks the shared cache for the nix-vector from this node to
+   * the node having the dest IP, building and caching it if missing */
+  Ptr<NixVector> GetSharedNixVector (Ipv4Address dest);
+
+  /* builds the nix-vector from source to dest out of a BFS parent
+   * vector and adds it to the shared cache */
+  Ptr<NixVector> InsertSharedPath (const std::vector<uint32_t> & parentVector, uint32_t source, uint32_t dest);
+
+  /* removes from the shared cache all the paths that leave the given
+   * node through the given device, along with the Ipv4Routes cached
+   * for them along the way; returns the number of paths removed */
+  static uint32_t EvictSharedPaths (uint32_t node, uint32_t device);
+
+  /* empties the shared cache */
+  static void ClearSharedCache (void);
+
   void DoDispose (void);
 
   /* From Ipv4RoutingProtocol */
@@ -168,6 +256,14 @@ private:
 
   /* If true, BFS will follow down links and down interfaces */
   bool m_followDownEdges;
+
+  /* If true, a BFS for a missing destination goes on to
+   * fill the nix-vector cache with all reachable nodes */
+  bool m_cacheAllDestinations;
+
+  /* If true, nix-vectors are kept in the shared cache
+   * instead of m_nixCache */
+  bool m_sharedCache;
 };
 } // namespace ns3
 
@@ -0,0 +1,723 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/nix-vector.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-address-index.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+using namespace ns3;
+
+/* A device whose link can be taken down without telling the stack, as a
+ * failed cable would be */
+class NixLinkNetDevice : public SimpleNetDevice
+{
+public:
+  NixLinkNetDevice () : m_linkUp (true) {}
+  void SetLinkUp (bool linkUp) { m_linkUp = linkUp; }
+  virtual bool IsLinkUp (void) const { return m_linkUp; }
+private:
+  bool m_linkUp;
+};
+
+/* Nodes running only nix-vector routing, joined by point-to-point links
+ * made of a SimpleChannel with two devices.  Nodes are named by their
+ * index in m_nodes, and paths are written as the list of those indices. */
+class NixVectorRoutingTestCase : public TestCase
+{
+public:
+  NixVectorRoutingTestCase (std::string name);
+protected:
+  void CreateNodes (uint32_t n, Ipv4Address network);
+  /* Adds a link between nodes a and b and returns the device on a */
+  Ptr<NixLinkNetDevice> AddLink (uint32_t a, uint32_t b);
+  /* The address of the first interface that is not the loopback */
+  Ipv4Address GetAddress (uint32_t node);
+  Ptr<Ipv4NixVectorRouting> GetRouting (uint32_t node);
+  void SetRoutingAttribute (std::string name, const AttributeValue &value);
+  /* Routes a packet from source to dest the way the nodes forward it and
+   * returns the nodes it goes through, or an empty string if the source
+   * has no route.  The nix-vector given to the packet at the source is
+   * printed to nixVector. */
+  std::string FollowRoute (uint32_t source, Ipv4Address dest, Ptr<NetDevice> oif = 0, std::string *nixVector = 0);
+  /* The nix-vector of a path, given as {neighbor index, number of
+   * neighbors} for each node from the source on */
+  static std::string MakeNixVector (const uint32_t hops[][2], uint32_t n);
+  /* Reads the printed routing table of a node: the destinations of the
+   * paths it has in the shared cache, and those of its cached Ipv4Routes */
+  void ReadCaches (uint32_t node, std::set<uint32_t> &sharedPaths, std::set<Ipv4Address> &routes);
+  void DestroyNodes (void);
+
+  NodeContainer m_nodes;
+private:
+  void Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header);
+  uint32_t GetIndex (Ptr<Node> node) const;
+
+  Ipv4AddressHelper m_address;
+  Ptr<Ipv4Route> m_forwarded;
+};
+
+NixVectorRoutingTestCase::NixVectorRoutingTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+NixVectorRoutingTestCase::CreateNodes (uint32_t n, Ipv4Address network)
+{
+  m_nodes.Create (n);
+  Ipv4NixVectorHelper nixRouting;
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (nixRouting);
+  stack.Install (m_nodes);
+  m_address.SetBase (network, Ipv4Mask ("255.255.255.0"));
+}
+
+Ptr<NixLinkNetDevice>
+NixVectorRoutingTestCase::AddLink (uint32_t a, uint32_t b)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  uint32_t ends[2] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<NixLinkNetDevice> device = CreateObject<NixLinkNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      m_nodes.Get (ends[i])->AddDevice (device);
+      devices.Add (device);
+    }
+  m_address.Assign (devices);
+  m_address.NewNetwork ();
+  return DynamicCast<NixLinkNetDevice> (devices.Get (0));
+}
+
+Ipv4Address
+NixVectorRoutingTestCase::GetAddress (uint32_t node)
+{
+  return m_nodes.Get (node)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+}
+
+Ptr<Ipv4NixVectorRouting>
+NixVectorRoutingTestCase::GetRouting (uint32_t node)
+{
+  return m_nodes.Get (node)->GetObject<Ipv4NixVectorRouting> ();
+}
+
+void
+NixVectorRoutingTestCase::SetRoutingAttribute (std::string name, const AttributeValue &value)
+{
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      GetRouting (i)->SetAttribute (name, value);
+    }
+}
+
+uint32_t
+NixVectorRoutingTestCase::GetIndex (Ptr<Node> node) const
+{
+  return node->GetId () - m_nodes.Get (0)->GetId ();
+}
+
+void
+NixVectorRoutingTestCase::Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  m_forwarded = route;
+}
+
+std::string
+NixVectorRoutingTestCase::FollowRoute (uint32_t source, Ipv4Address dest, Ptr<NetDevice> oif, std::string *nixVector)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  Ipv4Header header;
+  header.SetDestination (dest);
+  Socket::SocketErrno sockerr;
+  Ptr<Node> node = m_nodes.Get (source);
+  Ptr<Ipv4Route> route = node->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (packet, header, oif, sockerr);
+  if (route == 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sockerr, Socket::ERROR_NOROUTETOHOST, "No route but no error either");
+      return "";
+    }
+  if (packet->GetNixVector () == 0)
+    {
+      NS_TEST_EXPECT_MSG_NE (packet->GetNixVector (), 0, "No nix-vector given to the packet");
+      return "";
+    }
+  if (nixVector != 0)
+    {
+      std::ostringstream oss;
+      oss << *packet->GetNixVector ();
+      *nixVector = oss.str ();
+    }
+
+  std::ostringstream path;
+  path << source;
+  Ptr<Node> destNode = Ipv4AddressIndex::GetNode (dest);
+  for (uint32_t hops = 0; route != 0 && hops < m_nodes.GetN (); hops++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice ()->GetNode (), node, "Route out of another node");
+      node = Ipv4AddressIndex::GetNode (route->GetGateway ());
+      if (node == 0)
+        {
+          NS_TEST_EXPECT_MSG_NE (node, 0, "Gateway " << route->GetGateway () << " is not a node address");
+          break;
+        }
+      path << " " << GetIndex (node);
+      if (node == destNode)
+        {
+          NS_TEST_EXPECT_MSG_EQ (packet->GetNixVector ()->GetRemainingBits (), 0, "Nix-vector not used up at the destination");
+          break;
+        }
+      m_forwarded = 0;
+      node->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteInput (packet, header, route->GetOutputDevice (),
+                                                                 MakeCallback (&NixVectorRoutingTestCase::Forward, this),
+                                                                 MakeNullCallback<void, Ptr<Ipv4MulticastRoute>, Ptr<const Packet>, const Ipv4Header &> (),
+                                                                 MakeNullCallback<void, Ptr<const Packet>, const Ipv4Header &, uint32_t> (),
+                                                                 MakeNullCallback<void, Ptr<const Packet>, const Ipv4Header &, Socket::SocketErrno> ());
+      NS_TEST_EXPECT_MSG_NE (m_forwarded, 0, "Packet dropped at node " << GetIndex (node));
+      route = m_forwarded;
+    }
+  return path.str ();
+}
+
+std::string
+NixVectorRoutingTestCase::MakeNixVector (const uint32_t hops[][2], uint32_t n)
+{
+  NixVector nixVector;
+  for (uint32_t i = n; i > 0; i--)
+    {
+      nixVector.AddNeighborIndex (hops[i - 1][0], nixVector.BitCount (hops[i - 1][1]));
+    }
+  std::ostringstream oss;
+  oss << nixVector;
+  return oss.str ();
+}
+
+void
+NixVectorRoutingTestCase::ReadCaches (uint32_t node, std::set<uint32_t> &sharedPaths, std::set<Ipv4Address> &routes)
+{
+  sharedPaths.clear ();
+  routes.clear ();
+  std::ostringstream oss;
+  m_nodes.Get (node)->GetObject<Ipv4> ()->GetRoutingProtocol ()->PrintRoutingTable (Create<OutputStreamWrapper> (&oss));
+
+  std::istringstream table (oss.str ());
+  std::string line;
+  std::string section;
+  while (std::getline (table, line))
+    {
+      std::istringstream fields (line);
+      std::string first;
+      fields >> first;
+      if (first.empty () || first.compare (0, 11, "Destination") == 0)
+        {
+          continue;
+        }
+      if (first[first.size () - 1] == ':')
+        {
+          section = first;
+        }
+      else if (section == "Ipv4RouteCache:")
+        {
+          routes.insert (Ipv4Address (first.c_str ()));
+        }
+      else if (section == "SharedNixCache:")
+        {
+          uint32_t id;
+          std::istringstream (first) >> id;
+          sharedPaths.insert (id - m_nodes.Get (0)->GetId ());
+        }
+    }
+}
+
+void
+NixVectorRoutingTestCase::DestroyNodes (void)
+{
+  // Nodes stay in the NodeList; disposing of them takes their devices out
+  // of the graph and their addresses out of the address index
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      m_nodes.Get (i)->Dispose ();
+    }
+  m_nodes = NodeContainer ();
+  Simulator::Destroy ();
+}
+
+/* Nix-vectors and next hops on small topologies */
+class NixVectorPathTestCase : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorPathTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorPathTestCase::NixVectorPathTestCase ()
+  : NixVectorRoutingTestCase ("Check the nix-vectors and next hops against the expected paths")
+{
+}
+
+void
+NixVectorPathTestCase::DoRun (void)
+{
+  //   0 --- 1
+  //   |     |
+  //   2 --- 3 --- 4
+  CreateNodes (5, Ipv4Address ("10.201.1.0"));
+  Ptr<NetDevice> d01 = AddLink (0, 1);
+  Ptr<NetDevice> d02 = AddLink (0, 2);
+  AddLink (1, 3);
+  AddLink (2, 3);
+  AddLink (3, 4);
+
+  // Device 0 is the loopback, so on node 3 the device to 4 is neighbor 2
+  // of 3.  Ties are broken by the lowest device index.
+  std::string nixVector;
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (4), 0, &nixVector), "0 1 3 4", "Wrong path");
+  static const uint32_t hops04[][2] = { { 0, 2 }, { 1, 2 }, { 2, 3 } };
+  NS_TEST_EXPECT_MSG_EQ (nixVector, MakeNixVector (hops04, 3), "Wrong nix-vector");
+
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (4, GetAddress (0), 0, &nixVector), "4 3 1 0", "Wrong path");
+  static const uint32_t hops40[][2] = { { 0, 1 }, { 0, 3 }, { 0, 2 } };
+  NS_TEST_EXPECT_MSG_EQ (nixVector, MakeNixVector (hops40, 3), "Wrong nix-vector");
+
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (2, GetAddress (1), 0, &nixVector), "2 0 1", "Wrong path");
+  static const uint32_t hops21[][2] = { { 0, 2 }, { 0, 2 } };
+  NS_TEST_EXPECT_MSG_EQ (nixVector, MakeNixVector (hops21, 2), "Wrong nix-vector");
+
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, GetAddress (2), 0, &nixVector), "1 0 2", "Wrong path");
+  static const uint32_t hops12[][2] = { { 0, 2 }, { 1, 2 } };
+  NS_TEST_EXPECT_MSG_EQ (nixVector, MakeNixVector (hops12, 2), "Wrong nix-vector");
+
+  // Any address of the destination node leads to the same path
+  Ipv4Address a30 = m_nodes.Get (3)->GetObject<Ipv4> ()->GetAddress (3, 0).GetLocal ();
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, a30, 0, &nixVector), "0 1 3", "Wrong path");
+  static const uint32_t hops03[][2] = { { 0, 2 }, { 1, 2 } };
+  NS_TEST_EXPECT_MSG_EQ (nixVector, MakeNixVector (hops03, 2), "Wrong nix-vector");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 1 3", "Wrong path");
+
+  // The next hop and output device handed to the source
+  Ptr<Packet> packet = Create<Packet> ();
+  Ipv4Header header;
+  header.SetDestination (GetAddress (4));
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = m_nodes.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (packet, header, 0, sockerr);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route from 0 to 4");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), d01, "Wrong output device");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), GetAddress (1), "Wrong gateway");
+  NS_TEST_EXPECT_MSG_EQ (route->GetSource (), GetAddress (0), "Wrong source address");
+
+  // An output device forces the first hop
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (4), d02, &nixVector), "0 2 3 4", "Wrong path through the output device");
+  static const uint32_t hops024[][2] = { { 1, 2 }, { 1, 2 }, { 2, 3 } };
+  NS_TEST_EXPECT_MSG_EQ (nixVector, MakeNixVector (hops024, 3), "Wrong nix-vector");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (4)), "0 1 3 4", "Path through the output device cached");
+
+  DestroyNodes ();
+}
+
+/* Links and interfaces going down after the graph was built */
+class NixVectorLinkDownTestCase : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorLinkDownTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorLinkDownTestCase::NixVectorLinkDownTestCase ()
+  : NixVectorRoutingTestCase ("Check that down links are avoided unless FollowDownEdges is set")
+{
+}
+
+void
+NixVectorLinkDownTestCase::DoRun (void)
+{
+  //   0 --- 1
+  //   |     |
+  //   2 --- 3
+  CreateNodes (4, Ipv4Address ("10.202.1.0"));
+  AddLink (0, 1);
+  AddLink (0, 2);
+  Ptr<NixLinkNetDevice> d13 = AddLink (1, 3);
+  AddLink (2, 3);
+
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 1 3", "Wrong path");
+
+  // An interface taken down through the stack flushes the caches
+  Ptr<Ipv4> ipv4 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  int32_t i13 = ipv4->GetInterfaceForDevice (d13);
+  ipv4->SetDown (i13);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 2 3", "Down interface not avoided");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, GetAddress (3)), "1 0 2 3", "Down interface not avoided");
+  ipv4->SetUp (i13);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 1 3", "Interface back up not used");
+
+  // A link that fails under the stack only shows after a flush
+  d13->SetLinkUp (false);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 1 3", "Cached path lost without a flush");
+  GetRouting (0)->FlushGlobalNixRoutingCache ();
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 2 3", "Down link not avoided");
+
+  // With FollowDownEdges the down link and interface are taken again.  No
+  // cache is flushed in that mode, so flush before turning it on.
+  ipv4->SetDown (i13);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 2 3", "Down link not avoided");
+  GetRouting (0)->FlushGlobalNixRoutingCache ();
+  SetRoutingAttribute ("FollowDownEdges", BooleanValue (true));
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (3)), "0 1 3", "Down link not followed");
+
+  DestroyNodes ();
+}
+
+/* Addresses added and removed after the graph was built */
+class NixVectorAddressChangeTestCase : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorAddressChangeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorAddressChangeTestCase::NixVectorAddressChangeTestCase ()
+  : NixVectorRoutingTestCase ("Check that address changes rebuild the graph")
+{
+}
+
+void
+NixVectorAddressChangeTestCase::DoRun (void)
+{
+  CreateNodes (3, Ipv4Address ("10.203.1.0"));
+  AddLink (0, 1);
+  AddLink (1, 2);
+  Ipv4Address a12 = GetAddress (2);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, a12), "0 1 2", "Wrong path");
+
+  // A new link between existing nodes leaves the node count unchanged;
+  // only the addresses assigned to it tell the graph to rebuild
+  AddLink (0, 2);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, a12), "0 2", "New link not in the graph");
+  Ipv4Address a02 = m_nodes.Get (2)->GetObject<Ipv4> ()->GetAddress (2, 0).GetLocal ();
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, a02), "1 2", "Wrong path");
+
+  // A second address on a node, then removed: it can no longer be routed
+  // to, from a cold or a warm cache.  (The gateway of a hop is the first
+  // address of the interface on the far end, so a removed first address
+  // is not something nix-vector routing can route around.)
+  Ptr<Ipv4> ipv4 = m_nodes.Get (2)->GetObject<Ipv4> ();
+  Ipv4Address secondary ("10.203.9.2");
+  ipv4->AddAddress (1, Ipv4InterfaceAddress (secondary, Ipv4Mask ("255.255.255.0")));
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, secondary), "0 2", "Added address not routed to");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, secondary), "1 2", "Added address not routed to");
+  ipv4->RemoveAddress (1, 1);
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, secondary), "", "Route to a removed address");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, secondary), "", "Route to a removed address");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, a02), "1 2", "Other address of the node lost");
+
+  DestroyNodes ();
+}
+
+/* Caching the nix-vectors to every destination after a single BFS */
+class NixVectorCacheAllTestCase : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorCacheAllTestCase ();
+private:
+  virtual void DoRun (void);
+  void FollowAllRoutes (std::vector<std::string> &paths, std::vector<std::string> &nixVectors);
+};
+
+NixVectorCacheAllTestCase::NixVectorCacheAllTestCase ()
+  : NixVectorRoutingTestCase ("Check that CacheAllDestinations gives the same routes")
+{
+}
+
+void
+NixVectorCacheAllTestCase::FollowAllRoutes (std::vector<std::string> &paths, std::vector<std::string> &nixVectors)
+{
+  paths.clear ();
+  nixVectors.clear ();
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          Ptr<Ipv4> ipv4 = m_nodes.Get (j)->GetObject<Ipv4> ();
+          for (uint32_t k = 1; k < ipv4->GetNInterfaces (); k++)
+            {
+              std::string nixVector;
+              paths.push_back (FollowRoute (i, ipv4->GetAddress (k, 0).GetLocal (), 0, &nixVector));
+              nixVectors.push_back (nixVector);
+            }
+        }
+    }
+}
+
+void
+NixVectorCacheAllTestCase::DoRun (void)
+{
+  // A 3x3 grid with a tail, and a node on its own
+  //
+  //   0 - 1 - 2
+  //   |   |   |
+  //   3 - 4 - 5 - 9 - 10
+  //   |   |   |
+  //   6 - 7 - 8       11
+  CreateNodes (12, Ipv4Address ("10.204.1.0"));
+  for (uint32_t row = 0; row < 3; row++)
+    {
+      for (uint32_t col = 0; col < 3; col++)
+        {
+          if (col < 2)
+            {
+              AddLink (3 * row + col, 3 * row + col + 1);
+            }
+          if (row < 2)
+            {
+              AddLink (3 * row + col, 3 * row + col + 3);
+            }
+        }
+    }
+  AddLink (5, 9);
+  AddLink (9, 10);
+  Ptr<NixLinkNetDevice> d1112 = AddLink (11, 0);
+  d1112->SetLinkUp (false);
+  DynamicCast<NixLinkNetDevice> (d1112->GetChannel ()->GetDevice (1))->SetLinkUp (false);
+
+  std::vector<std::string> paths;
+  std::vector<std::string> nixVectors;
+  FollowAllRoutes (paths, nixVectors);
+  NS_TEST_EXPECT_MSG_EQ (paths[0], "0 1", "Wrong path");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (10)), "0 1 2 5 9 10", "Wrong path");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (11)), "", "Route over a down link");
+
+  SetRoutingAttribute ("CacheAllDestinations", BooleanValue (true));
+  GetRouting (0)->FlushGlobalNixRoutingCache ();
+  std::vector<std::string> cachedPaths;
+  std::vector<std::string> cachedNixVectors;
+  FollowAllRoutes (cachedPaths, cachedNixVectors);
+  NS_TEST_ASSERT_MSG_EQ (cachedPaths.size (), paths.size (), "Different number of routes");
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (cachedPaths[i], paths[i], "Different path " << i);
+      NS_TEST_EXPECT_MSG_EQ (cachedNixVectors[i], nixVectors[i], "Different nix-vector " << i);
+    }
+
+  DestroyNodes ();
+}
+
+/* The cache shared by all the nodes, and its eviction of the paths
+ * through an interface going down */
+class NixVectorSharedCacheTestCase : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorSharedCacheTestCase ();
+private:
+  virtual void DoRun (void);
+  /* Routes from every node to every other one and returns the paths, by
+   * source and destination */
+  std::vector<std::vector<std::string> > FollowAllRoutes (void);
+  /* Checks that each node has exactly the shared paths and the
+   * Ipv4Routes to the destinations given */
+  void CheckCaches (const std::vector<std::set<uint32_t> > &sharedPaths,
+                    const std::vector<std::set<uint32_t> > &routes, std::string when);
+};
+
+NixVectorSharedCacheTestCase::NixVectorSharedCacheTestCase ()
+  : NixVectorRoutingTestCase ("Check that an interface going down evicts the shared paths through it")
+{
+}
+
+std::vector<std::vector<std::string> >
+NixVectorSharedCacheTestCase::FollowAllRoutes (void)
+{
+  std::vector<std::vector<std::string> > paths (m_nodes.GetN (), std::vector<std::string> (m_nodes.GetN ()));
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+        {
+          if (i != j)
+            {
+              paths[i][j] = FollowRoute (i, GetAddress (j));
+            }
+        }
+    }
+  return paths;
+}
+
+void
+NixVectorSharedCacheTestCase::CheckCaches (const std::vector<std::set<uint32_t> > &sharedPaths,
+                                           const std::vector<std::set<uint32_t> > &routes, std::string when)
+{
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      std::set<uint32_t> nodeSharedPaths;
+      std::set<Ipv4Address> nodeRoutes;
+      ReadCaches (i, nodeSharedPaths, nodeRoutes);
+      NS_TEST_EXPECT_MSG_EQ ((nodeSharedPaths == sharedPaths[i]), true, "Wrong shared paths from node " << i << " " << when);
+      std::set<uint32_t> routeDests;
+      for (std::set<Ipv4Address>::const_iterator it = nodeRoutes.begin (); it != nodeRoutes.end (); it++)
+        {
+          routeDests.insert (Ipv4AddressIndex::GetNode (*it)->GetId () - m_nodes.Get (0)->GetId ());
+        }
+      NS_TEST_EXPECT_MSG_EQ ((routeDests == routes[i]), true, "Wrong Ipv4Routes at node " << i << " " << when);
+    }
+}
+
+void
+NixVectorSharedCacheTestCase::DoRun (void)
+{
+  //   0 --- 1
+  //   |     |
+  //   2 --- 3 --- 4
+  CreateNodes (5, Ipv4Address ("10.205.1.0"));
+  AddLink (0, 1);
+  AddLink (0, 2);
+  Ptr<NetDevice> d13 = AddLink (1, 3);
+  AddLink (2, 3);
+  AddLink (3, 4);
+  SetRoutingAttribute ("SharedCache", BooleanValue (true));
+  Ptr<Ipv4> ipv4 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  int32_t i13 = ipv4->GetInterfaceForDevice (d13);
+
+  std::vector<std::set<uint32_t> > all (m_nodes.GetN ());
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+        {
+          if (i != j)
+            {
+              all[i].insert (j);
+            }
+        }
+    }
+  std::vector<std::set<uint32_t> > none (m_nodes.GetN ());
+
+  // Each node on a path has an Ipv4Route to its destination: the source
+  // from RouteOutput, the others from RouteInput
+  std::vector<std::vector<std::string> > paths = FollowAllRoutes ();
+  CheckCaches (all, all, "after routing");
+
+  // The paths that go out of 1 to 3 are evicted.  So are the Ipv4Routes
+  // to their destinations at the nodes along them, even when other paths
+  // go through those nodes to the same destinations.
+  std::vector<std::set<uint32_t> > kept (m_nodes.GetN ());
+  std::vector<std::set<uint32_t> > keptRoutes = all;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          std::istringstream path (paths[i][j]);
+          std::vector<uint32_t> hops;
+          uint32_t hop;
+          while (path >> hop)
+            {
+              hops.push_back (hop);
+            }
+          bool through13 = false;
+          for (uint32_t k = 0; k + 1 < hops.size (); k++)
+            {
+              through13 = through13 || (hops[k] == 1 && hops[k + 1] == 3);
+            }
+          if (!through13)
+            {
+              kept[i].insert (j);
+              continue;
+            }
+          for (uint32_t k = 0; k + 1 < hops.size (); k++)
+            {
+              keptRoutes[hops[k]].erase (j);
+            }
+        }
+    }
+  // 0 to 3 and 4 and 1 to 3 and 4 go through 1 -> 3; 3 to 1 comes in
+  // through the other end of the link and stays
+  NS_TEST_EXPECT_MSG_EQ (paths[0][4], "0 1 3 4", "Wrong path");
+  NS_TEST_EXPECT_MSG_EQ (paths[3][1], "3 1", "Wrong path");
+  NS_TEST_EXPECT_MSG_EQ (kept[0].size () + kept[1].size (), 4, "Wrong paths through 1 -> 3");
+
+  NS_TEST_EXPECT_MSG_EQ (keptRoutes[3].count (4), 0, "Ipv4Route at 3 to 4 should go with 0 to 4");
+
+  ipv4->SetDown (i13);
+  CheckCaches (kept, keptRoutes, "after the interface went down");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (4)), "0 2 3 4", "Evicted path still used");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (1, GetAddress (3)), "1 0 2 3", "Evicted path still used");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (3, GetAddress (1)), "3 1", "Kept path not used");
+
+  // Up, and address changes: everything goes
+  ipv4->SetUp (i13);
+  CheckCaches (none, none, "after the interface came up");
+  paths = FollowAllRoutes ();
+  NS_TEST_EXPECT_MSG_EQ (paths[0][4], "0 1 3 4", "Interface back up not used");
+  CheckCaches (all, all, "after routing again");
+  Ptr<Ipv4> ipv4Node4 = m_nodes.Get (4)->GetObject<Ipv4> ();
+  ipv4Node4->AddAddress (1, Ipv4InterfaceAddress (Ipv4Address ("10.205.9.4"), Ipv4Mask ("255.255.255.0")));
+  CheckCaches (none, none, "after an address was added");
+  FollowAllRoutes ();
+  CheckCaches (all, all, "after routing again");
+  ipv4Node4->RemoveAddress (1, 1);
+  CheckCaches (none, none, "after an address was removed");
+
+  // With FollowDownEdges the down interface stays in the paths, so
+  // nothing is evicted
+  FollowAllRoutes ();
+  SetRoutingAttribute ("FollowDownEdges", BooleanValue (true));
+  ipv4->SetDown (i13);
+  CheckCaches (all, all, "after the interface went down with FollowDownEdges");
+  NS_TEST_EXPECT_MSG_EQ (FollowRoute (0, GetAddress (4)), "0 1 3 4", "Down interface not followed");
+
+  DestroyNodes ();
+}
+
+static class Ipv4NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorRoutingTestSuite ()
+    : TestSuite ("ipv4-nix-vector-routing", UNIT)
+  {
+    AddTestCase (new NixVectorPathTestCase ());
+    AddTestCase (new NixVectorLinkDownTestCase ());
+    AddTestCase (new NixVectorAddressChangeTestCase ());
+    AddTestCase (new NixVectorCacheAllTestCase ());
+    AddTestCase (new NixVectorSharedCacheTestCase ());
+  }
+} g_ipv4NixVectorRoutingTestSuite;
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Times the ways scripts wire traces through Config paths on a ring of
+// point-to-point links: one Config::Connect per node, with the node
+// index in the path; a few wildcard paths to the trace sources of every
+// device; and a list of per-node paths connected at once.  Every device
+// then sends one packet, and the checksum counts the trace sink calls,
+// so that two versions can be checked to connect the same sources.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+static uint64_t g_calls = 0;
+
+static void
+SinkWithContext (std::string context, Ptr<const Packet> packet)
+{
+  g_calls++;
+}
+
+static void
+Sink (Ptr<const Packet> packet)
+{
+  g_calls++;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nnodes = 10000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes in the ring", nnodes);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (nnodes);
+  PointToPointHelper pointToPoint;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nnodes; i++)
+    {
+      devices.Add (pointToPoint.Install (nodes.Get (i), nodes.Get ((i + 1) % nnodes)));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < nnodes; i++)
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << i << "/DeviceList/0/$ns3::PointToPointNetDevice/MacTx";
+      Config::Connect (oss.str (), MakeCallback (&SinkWithContext));
+    }
+  int64_t perNodeMs = clock.End ();
+
+  clock.Start ();
+  const char *sources[] = { "MacTx", "MacTxDrop", "PhyTxBegin", "PhyTxEnd" };
+  for (uint32_t i = 0; i < sizeof (sources) / sizeof (sources[0]); i++)
+    {
+      Config::Connect (std::string ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/") + sources[i],
+                       MakeCallback (&SinkWithContext));
+    }
+  int64_t wildcardMs = clock.End ();
+
+  clock.Start ();
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < nnodes; i++)
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << i << "/DeviceList/1/$ns3::PointToPointNetDevice/MacTx";
+      paths.push_back (oss.str ());
+    }
+  Config::ConnectWithoutContext (paths, MakeCallback (&Sink));
+  int64_t bulkMs = clock.End ();
+
+  for (NetDeviceContainer::Iterator device = devices.Begin (); device != devices.End (); device++)
+    {
+      (*device)->Send (Create<Packet> (100), (*device)->GetBroadcast (), 0x0800);
+    }
+
+  std::cout << nnodes << " nodes, " << devices.GetN () << " devices" << std::endl;
+  std::cout << "per-node connect: " << perNodeMs << " ms" << std::endl;
+  std::cout << "wildcard connect: " << wildcardMs << " ms" << std::endl;
+  std::cout << "bulk connect:     " << bulkMs << " ms" << std::endl;
+  std::cout << "checksum " << g_calls << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Times PointToPointHelper::Install over a ring of links, which creates
+// two devices, two queues and a channel per link through the helper's
+// object factories, with the data rate, delay and queue size given as
+// strings.  The checksum adds up the attributes of the devices, channels
+// and queues created, so that two versions can be checked to configure
+// them the same way.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t nlinks = 100000;
+
+  CommandLine cmd;
+  cmd.AddValue ("links", "Number of links to install", nlinks);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (nlinks);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  pointToPoint.SetQueue ("ns3::DropTailQueue", "MaxPackets", StringValue ("50"));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nlinks; i++)
+    {
+      devices.Add (pointToPoint.Install (nodes.Get (i), nodes.Get ((i + 1) % nlinks)));
+    }
+  int64_t installMs = clock.End ();
+
+  uint64_t checksum = 0;
+  for (NetDeviceContainer::Iterator device = devices.Begin (); device != devices.End (); device++)
+    {
+      DataRateValue rate;
+      (*device)->GetAttribute ("DataRate", rate);
+      TimeValue delay;
+      (*device)->GetChannel ()->GetAttribute ("Delay", delay);
+      PointerValue queue;
+      (*device)->GetAttribute ("TxQueue", queue);
+      UintegerValue maxPackets;
+      queue.Get<Queue> ()->GetAttribute ("MaxPackets", maxPackets);
+      checksum += rate.Get ().GetBitRate () / 1000000 + delay.Get ().GetMicroSeconds () + maxPackets.Get ();
+    }
+
+  std::cout << nlinks << " links" << std::endl;
+  std::cout << "install: " << installMs << " ms, "
+            << installMs * 1000000.0 / nlinks << " ns/link, checksum " << checksum << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -352,6 +352,20 @@ PointToPointNetDevice::GetQueue (void) const
   return m_queue;
 }
 
+bool
+PointToPointNetDevice::ResetTransmitter (void)
+{
+  NS_LOG_FUNCTION (this);
+  bool busy = m_txMachineState != READY || m_currentPkt != 0 || (m_queue != 0 && !m_queue->IsEmpty ());
+  if (m_queue != 0)
+    {
+      m_queue->DequeueAll ();
+    }
+  m_currentPkt = 0;
+  m_txMachineState = READY;
+  return busy;
+}
+
 void
 PointToPointNetDevice::NotifyLinkUp (void)
 {
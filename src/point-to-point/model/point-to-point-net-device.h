@@ -120,6 +120,18 @@ public:
    */
   Ptr<Queue> GetQueue (void) const;
 
+  /**
+   * Drop the packets waiting in the queue and the one being transmitted,
+   * and make the transmitter ready for new packets.
+   *
+   * Simulator::Destroy cancels the event that would have completed a
+   * transmission in progress, which leaves the transmitter busy for good
+   * if the device is used again in a new simulation run.
+   *
+   * @returns true if there was anything to drop.
+   */
+  bool ResetTransmitter (void);
+
   /**
    * Attach a receive ErrorModel to the PointToPointNetDevice.
    *
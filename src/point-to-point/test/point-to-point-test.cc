@@ -56,6 +56,81 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+class PointToPointResetTest : public TestCase
+{
+public:
+  PointToPointResetTest ();
+
+  virtual void DoRun (void);
+
+private:
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_received;
+};
+
+PointToPointResetTest::PointToPointResetTest ()
+  : TestCase ("Reuse a device stopped in the middle of a transmission in a new run")
+{
+}
+
+void
+PointToPointResetTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointResetTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+PointToPointResetTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devA->SetDataRate (DataRate ("8kbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointResetTest::Receive, this));
+
+  // Each packet takes about a second to send, so the run stops with the
+  // first one on the wire and the others queued
+  m_received = 0;
+  Simulator::Schedule (Seconds (1.0), &PointToPointResetTest::SendPackets, this, devA, 5);
+  Simulator::Stop (Seconds (1.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 0, "No packet should have made it in the first run");
+
+  NS_TEST_EXPECT_MSG_EQ (devA->ResetTransmitter (), true, "The transmitter should have been busy");
+  NS_TEST_EXPECT_MSG_EQ (devA->GetQueue ()->IsEmpty (), true, "Queued packets left behind");
+  NS_TEST_EXPECT_MSG_EQ (devA->ResetTransmitter (), false, "Nothing left to reset");
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointResetTest::SendPackets, this, devA, 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 1, "Only the packet of the second run should arrive");
+}
+//-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
 public:
@@ -66,6 +141,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest);
+  AddTestCase (new PointToPointResetTest);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite;
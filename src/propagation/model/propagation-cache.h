@@ -21,6 +21,8 @@
 #define PROPAGATION_CACHE_H_
 
 #include "ns3/mobility-model.h"
+#include "ns3/callback.h"
+#include "ns3/sgi-hashmap.h"
 #include <map>
 
 namespace ns3
@@ -85,6 +87,136 @@ private:
 private:
   PathCache m_pathCache;
 };
+/**
+ * \ingroup propagation
+ * \brief Caches one result of a propagation model for each path from a
+ * sender to a receiver.
+ *
+ * A result stays valid until one of the two MobilityModels reports a course
+ * change: each MobilityModel seen gets an epoch, bumped from its CourseChange
+ * trace, and a cached result is only used while both epochs are those it was
+ * computed at.  A mobility model does not report a course change while it
+ * keeps moving the same way, so no result is cached for a path with an end
+ * whose velocity is not zero.
+ */
+template<class T>
+class PropagationResultCache
+{
+public:
+  PropagationResultCache ()
+    : m_last (0)
+  {
+  }
+  ~PropagationResultCache ()
+  {
+    Clear ();
+  }
+  /**
+   * \param a the sender
+   * \param b the receiver
+   * \param result set to the cached result of the path if there is a valid
+   * one; otherwise, to where the caller should store the result it
+   * computes, or to 0 if the result of the path cannot be cached.
+   * \returns true if result is set to a valid cached result.
+   */
+  bool Lookup (MobilityModel *a, MobilityModel *b, T **result)
+  {
+    if (!IsStill (a) || !IsStill (b))
+      {
+        *result = 0;
+        return false;
+      }
+    if (m_last == 0 || m_last->mobility != a)
+      {
+        m_last = GetRecord (a);
+      }
+    typename Paths::iterator it = m_last->paths.find (b);
+    if (it == m_last->paths.end ())
+      {
+        Path path;
+        path.peer = GetRecord (b);
+        it = m_last->paths.insert (std::make_pair (b, path)).first;
+      }
+    else if (it->second.epoch == m_last->epoch && it->second.peerEpoch == it->second.peer->epoch)
+      {
+        *result = &it->second.result;
+        return true;
+      }
+    it->second.epoch = m_last->epoch;
+    it->second.peerEpoch = it->second.peer->epoch;
+    *result = &it->second.result;
+    return false;
+  }
+  /**
+   * Forgets all the results and disconnects from the MobilityModels.
+   */
+  void Clear (void)
+  {
+    for (typename Records::iterator i = m_records.begin (); i != m_records.end (); i++)
+      {
+        i->second.mobility->TraceDisconnectWithoutContext (
+          "CourseChange", MakeCallback (&PropagationResultCache<T>::CourseChanged, this));
+      }
+    m_records.clear ();
+    m_last = 0;
+  }
+private:
+  struct PointerHash
+  {
+    size_t operator () (const MobilityModel *mobility) const
+    {
+      return reinterpret_cast<size_t> (mobility) >> 4;
+    }
+  };
+  struct Record;
+  struct Path
+  {
+    Record *peer;
+    uint32_t epoch;
+    uint32_t peerEpoch;
+    T result;
+  };
+  typedef sgi::hash_map<const MobilityModel *, Path, PointerHash> Paths;
+  /// What is known of a MobilityModel, and the paths it is the sender of
+  struct Record
+  {
+    Ptr<MobilityModel> mobility;
+    uint32_t epoch;
+    Paths paths;
+  };
+  typedef sgi::hash_map<const MobilityModel *, Record, PointerHash> Records;
+
+  static bool IsStill (const MobilityModel *mobility)
+  {
+    Vector velocity = mobility->GetVelocity ();
+    return velocity.x == 0.0 && velocity.y == 0.0 && velocity.z == 0.0;
+  }
+  Record *GetRecord (MobilityModel *mobility)
+  {
+    typename Records::iterator it = m_records.find (mobility);
+    if (it == m_records.end ())
+      {
+        it = m_records.insert (std::make_pair (mobility, Record ())).first;
+        it->second.mobility = mobility;
+        it->second.epoch = 0;
+        mobility->TraceConnectWithoutContext (
+          "CourseChange", MakeCallback (&PropagationResultCache<T>::CourseChanged, this));
+      }
+    return &it->second;
+  }
+  void CourseChanged (Ptr<const MobilityModel> mobility)
+  {
+    typename Records::iterator it = m_records.find (PeekPointer (mobility));
+    if (it != m_records.end ())
+      {
+        it->second.epoch++;
+      }
+  }
+
+  Records m_records;
+  Record *m_last; ///< the record of the last sender, which is often the next one
+};
+
 } // namespace ns3
 
 #endif // PROPAGATION_CACHE_H_
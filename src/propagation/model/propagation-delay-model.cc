@@ -22,6 +22,7 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/assert.h"
 
 namespace ns3 {
 
@@ -128,4 +129,86 @@ ConstantSpeedPropagationDelayModel::DoAssignStreams (int64_t stream)
 }
 
 
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationDelayModel);
+
+TypeId
+CachedPropagationDelayModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationDelayModel")
+    .SetParent<PropagationDelayModel> ()
+    .AddConstructor<CachedPropagationDelayModel> ()
+    .AddAttribute ("Model", "The delay model whose results are cached.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationDelayModel::SetModel,
+                                        &CachedPropagationDelayModel::GetModel),
+                   MakePointerChecker<PropagationDelayModel> ())
+  ;
+  return tid;
+}
+
+CachedPropagationDelayModel::CachedPropagationDelayModel ()
+  : m_nHits (0),
+    m_nMisses (0)
+{
+}
+CachedPropagationDelayModel::~CachedPropagationDelayModel ()
+{
+}
+void
+CachedPropagationDelayModel::DoDispose (void)
+{
+  m_cache.Clear ();
+  m_model = 0;
+  PropagationDelayModel::DoDispose ();
+}
+Time
+CachedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "CachedPropagationDelayModel has no model to cache");
+  Time *result;
+  if (m_cache.Lookup (PeekPointer (a), PeekPointer (b), &result))
+    {
+      m_nHits++;
+      return *result;
+    }
+  m_nMisses++;
+  Time delay = m_model->GetDelay (a, b);
+  if (result != 0)
+    {
+      *result = delay;
+    }
+  return delay;
+}
+void
+CachedPropagationDelayModel::SetModel (Ptr<PropagationDelayModel> model)
+{
+  m_cache.Clear ();
+  m_model = model;
+}
+Ptr<PropagationDelayModel>
+CachedPropagationDelayModel::GetModel (void) const
+{
+  return m_model;
+}
+uint64_t
+CachedPropagationDelayModel::GetNHits (void) const
+{
+  return m_nHits;
+}
+uint64_t
+CachedPropagationDelayModel::GetNMisses (void) const
+{
+  return m_nMisses;
+}
+
+int64_t
+CachedPropagationDelayModel::DoAssignStreams (int64_t stream)
+{
+  if (m_model == 0)
+    {
+      return 0;
+    }
+  return m_model->AssignStreams (stream);
+}
+
 } // namespace ns3
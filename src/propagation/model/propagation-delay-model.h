@@ -24,6 +24,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/random-variable-stream.h"
+#include "propagation-cache.h"
 
 namespace ns3 {
 
@@ -115,6 +116,47 @@ private:
   double m_speed;
 };
 
+/**
+ * \ingroup propagation
+ *
+ * \brief Caches the delay computed by another delay model for each pair
+ * of sender and receiver.
+ *
+ * The cached delay of a path is used again as long as neither end reported
+ * a course change; paths with an end that is moving are not cached.  The
+ * cached model should not use random variables, since the cache would
+ * freeze their values.
+ */
+class CachedPropagationDelayModel : public PropagationDelayModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CachedPropagationDelayModel ();
+  virtual ~CachedPropagationDelayModel ();
+  virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * \param model the delay model whose results are cached
+   */
+  void SetModel (Ptr<PropagationDelayModel> model);
+  Ptr<PropagationDelayModel> GetModel (void) const;
+  /**
+   * \returns the number of delays taken from the cache
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \returns the number of delays computed by the cached model
+   */
+  uint64_t GetNMisses (void) const;
+private:
+  virtual void DoDispose (void);
+  virtual int64_t DoAssignStreams (int64_t stream);
+  Ptr<PropagationDelayModel> m_model;
+  mutable PropagationResultCache<Time> m_cache;
+  mutable uint64_t m_nHits;
+  mutable uint64_t m_nMisses;
+};
+
 } // namespace ns3
 
 #endif /* PROPAGATION_DELAY_MODEL_H */
@@ -27,6 +27,7 @@
 
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
+#include "propagation-cache.h"
 #include <map>
 
 namespace ns3 {
@@ -603,6 +604,62 @@ private:
   double m_range;
 };
 
+/**
+ * \ingroup propagation
+ *
+ * \brief Caches the received power computed by another loss model (and
+ * the models chained to it) for each pair of sender and receiver.
+ *
+ * The cached power of a path is used again as long as the transmit power is
+ * the same and neither end reported a course change; paths with an end that
+ * is moving are not cached.  This pays off for chains of costly
+ * deterministic models, such as Cost231 or Okumura-Hata: the cached model
+ * should not use random variables, since the cache would freeze their
+ * values.  Fading models can instead be chained after this one with
+ * SetNext(), to be computed for every packet.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+  /**
+   * \param model the loss model whose results are cached
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+  Ptr<PropagationLossModel> GetModel (void) const;
+  /**
+   * \returns the number of received powers taken from the cache
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \returns the number of received powers computed by the cached model
+   */
+  uint64_t GetNMisses (void) const;
+
+private:
+  CachedPropagationLossModel (const CachedPropagationLossModel &o);
+  CachedPropagationLossModel & operator = (const CachedPropagationLossModel &o);
+  virtual void DoDispose (void);
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  struct Result
+  {
+    double txPowerDbm;
+    double rxPowerDbm;
+  };
+
+  Ptr<PropagationLossModel> m_model;
+  mutable PropagationResultCache<Result> m_cache;
+  mutable uint64_t m_nHits;
+  mutable uint64_t m_nMisses;
+};
+
 } // namespace ns3
 
 #endif /* PROPAGATION_LOSS_MODEL_H */
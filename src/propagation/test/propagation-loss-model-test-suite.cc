@@ -21,8 +21,11 @@
 #include "ns3/test.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
+#include "ns3/pointer.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/simulator.h"
 
 using namespace ns3;
@@ -434,6 +437,98 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class CachedPropagationModelTestCase : public TestCase
+{
+public:
+  CachedPropagationModelTestCase ();
+  virtual ~CachedPropagationModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (double txPowerDbm);
+
+  std::vector<Ptr<MobilityModel> > m_mobility;
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<CachedPropagationLossModel> m_cachedLoss;
+  Ptr<PropagationDelayModel> m_delay;
+  Ptr<CachedPropagationDelayModel> m_cachedDelay;
+};
+
+CachedPropagationModelTestCase::CachedPropagationModelTestCase ()
+  : TestCase ("Test CachedPropagationLossModel and CachedPropagationDelayModel")
+{
+}
+
+CachedPropagationModelTestCase::~CachedPropagationModelTestCase ()
+{
+}
+
+void
+CachedPropagationModelTestCase::Check (double txPowerDbm)
+{
+  for (uint32_t i = 0; i < m_mobility.size (); i++)
+    {
+      for (uint32_t j = 0; j < m_mobility.size (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          NS_TEST_EXPECT_MSG_EQ (m_cachedLoss->CalcRxPower (txPowerDbm, m_mobility[i], m_mobility[j]),
+                                 m_loss->CalcRxPower (txPowerDbm, m_mobility[i], m_mobility[j]),
+                                 "Got unexpected rcv power from " << i << " to " << j);
+          NS_TEST_EXPECT_MSG_EQ (m_cachedDelay->GetDelay (m_mobility[i], m_mobility[j]),
+                                 m_delay->GetDelay (m_mobility[i], m_mobility[j]),
+                                 "Got unexpected delay from " << i << " to " << j);
+        }
+    }
+}
+
+void
+CachedPropagationModelTestCase::DoRun (void)
+{
+  // two nodes standing still, and a third one moving from t = 1s to t = 2s
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<MobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (100.0 * i, 10.0 * i, 0.0));
+      m_mobility.push_back (mobility);
+    }
+
+  m_loss = CreateObject<LogDistancePropagationLossModel> ();
+  m_cachedLoss = CreateObject<CachedPropagationLossModel> ();
+  m_cachedLoss->SetAttribute ("Model", PointerValue (m_loss));
+  m_delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  m_cachedDelay = CreateObject<CachedPropagationDelayModel> ();
+  m_cachedDelay->SetAttribute ("Model", PointerValue (m_delay));
+
+  // 6 misses, then 6 hits
+  Simulator::Schedule (Seconds (0.0), &CachedPropagationModelTestCase::Check, this, 16.0);
+  Simulator::Schedule (Seconds (0.1), &CachedPropagationModelTestCase::Check, this, 16.0);
+  // the loss misses 6 times for another tx power, the delay hits 6 times
+  Simulator::Schedule (Seconds (0.2), &CachedPropagationModelTestCase::Check, this, 20.0);
+  // 4 misses for the paths from or to node 0, then 2 hits
+  Simulator::Schedule (Seconds (0.3), &MobilityModel::SetPosition, m_mobility[0], Vector (-50.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (0.4), &CachedPropagationModelTestCase::Check, this, 20.0);
+  // 4 misses for each check while node 2 moves, 2 hits
+  Simulator::Schedule (Seconds (1.0), &ConstantVelocityMobilityModel::SetVelocity,
+                       DynamicCast<ConstantVelocityMobilityModel> (m_mobility[2]), Vector (0.0, 20.0, 0.0));
+  Simulator::Schedule (Seconds (1.5), &CachedPropagationModelTestCase::Check, this, 20.0);
+  Simulator::Schedule (Seconds (1.6), &CachedPropagationModelTestCase::Check, this, 20.0);
+  // 4 misses once it stopped, then 6 hits
+  Simulator::Schedule (Seconds (2.0), &ConstantVelocityMobilityModel::SetVelocity,
+                       DynamicCast<ConstantVelocityMobilityModel> (m_mobility[2]), Vector (0.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (2.5), &CachedPropagationModelTestCase::Check, this, 20.0);
+  Simulator::Schedule (Seconds (2.6), &CachedPropagationModelTestCase::Check, this, 20.0);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_cachedLoss->GetNHits (), 6 + 2 + 2 + 2 + 2 + 6, "Wrong number of cache hits");
+  NS_TEST_EXPECT_MSG_EQ (m_cachedLoss->GetNMisses (), 6 + 6 + 4 + 4 + 4 + 4, "Wrong number of cache misses");
+  NS_TEST_EXPECT_MSG_EQ (m_cachedDelay->GetNHits (), 6 + 6 + 2 + 2 + 2 + 2 + 6, "Wrong number of cache hits");
+  NS_TEST_EXPECT_MSG_EQ (m_cachedDelay->GetNMisses (), 6 + 4 + 4 + 4 + 4, "Wrong number of cache misses");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -448,6 +543,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase);
   AddTestCase (new MatrixPropagationLossModelTestCase);
   AddTestCase (new RangePropagationLossModelTestCase);
+  AddTestCase (new CachedPropagationModelTestCase);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
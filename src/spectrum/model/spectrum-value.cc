@@ -23,11 +23,245 @@
 #include <ns3/math.h>
 #include <ns3/log.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 NS_LOG_COMPONENT_DEFINE ("SpectrumValue");
 
 
 namespace ns3 {
 
+namespace {
+
+/*
+ * Element-wise kernels used by the arithmetic of SpectrumValue. Each
+ * operation is described by a class providing it both for a single
+ * double and, on SSE2 targets, for a pair of doubles; the loops below
+ * then handle four values per iteration and finish with scalar code.
+ * Only exactly rounded operations are used (no fused multiply-add), so
+ * the results are the same as those of the plain scalar loops.
+ */
+
+struct AddOp
+{
+  static double Apply (double a, double b)
+  {
+    return a + b;
+  }
+#ifdef __SSE2__
+  static __m128d Apply (__m128d a, __m128d b)
+  {
+    return _mm_add_pd (a, b);
+  }
+#endif
+};
+
+struct SubtractOp
+{
+  static double Apply (double a, double b)
+  {
+    return a - b;
+  }
+#ifdef __SSE2__
+  static __m128d Apply (__m128d a, __m128d b)
+  {
+    return _mm_sub_pd (a, b);
+  }
+#endif
+};
+
+struct MultiplyOp
+{
+  static double Apply (double a, double b)
+  {
+    return a * b;
+  }
+#ifdef __SSE2__
+  static __m128d Apply (__m128d a, __m128d b)
+  {
+    return _mm_mul_pd (a, b);
+  }
+#endif
+};
+
+struct DivideOp
+{
+  static double Apply (double a, double b)
+  {
+    return a / b;
+  }
+#ifdef __SSE2__
+  static __m128d Apply (__m128d a, __m128d b)
+  {
+    return _mm_div_pd (a, b);
+  }
+#endif
+};
+
+/*
+ * a[i] = Op (a[i], b[i]); a and b may be the same array
+ */
+template <class Op>
+void
+ApplyArray (double *a, const double *b, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128d a0 = _mm_loadu_pd (a + i);
+      __m128d a1 = _mm_loadu_pd (a + i + 2);
+      __m128d b0 = _mm_loadu_pd (b + i);
+      __m128d b1 = _mm_loadu_pd (b + i + 2);
+      _mm_storeu_pd (a + i, Op::Apply (a0, b0));
+      _mm_storeu_pd (a + i + 2, Op::Apply (a1, b1));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] = Op::Apply (a[i], b[i]);
+    }
+}
+
+/*
+ * a[i] = Op (a[i], s)
+ */
+template <class Op>
+void
+ApplyScalar (double *a, double s, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128d sv = _mm_set1_pd (s);
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128d a0 = _mm_loadu_pd (a + i);
+      __m128d a1 = _mm_loadu_pd (a + i + 2);
+      _mm_storeu_pd (a + i, Op::Apply (a0, sv));
+      _mm_storeu_pd (a + i + 2, Op::Apply (a1, sv));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] = Op::Apply (a[i], s);
+    }
+}
+
+/*
+ * a[i] = s
+ */
+void
+FillArray (double *a, double s, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128d sv = _mm_set1_pd (s);
+  for (; i + 4 <= n; i += 4)
+    {
+      _mm_storeu_pd (a + i, sv);
+      _mm_storeu_pd (a + i + 2, sv);
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] = s;
+    }
+}
+
+/*
+ * a[i] += x[i] * y[i]
+ */
+void
+AddProductArray (double *a, const double *x, const double *y, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128d p0 = _mm_mul_pd (_mm_loadu_pd (x + i), _mm_loadu_pd (y + i));
+      __m128d p1 = _mm_mul_pd (_mm_loadu_pd (x + i + 2), _mm_loadu_pd (y + i + 2));
+      _mm_storeu_pd (a + i, _mm_add_pd (_mm_loadu_pd (a + i), p0));
+      _mm_storeu_pd (a + i + 2, _mm_add_pd (_mm_loadu_pd (a + i + 2), p1));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] += x[i] * y[i];
+    }
+}
+
+/*
+ * a[i] += x[i] * s
+ */
+void
+AddScaledArray (double *a, const double *x, double s, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128d sv = _mm_set1_pd (s);
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128d p0 = _mm_mul_pd (_mm_loadu_pd (x + i), sv);
+      __m128d p1 = _mm_mul_pd (_mm_loadu_pd (x + i + 2), sv);
+      _mm_storeu_pd (a + i, _mm_add_pd (_mm_loadu_pd (a + i), p0));
+      _mm_storeu_pd (a + i + 2, _mm_add_pd (_mm_loadu_pd (a + i + 2), p1));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] += x[i] * s;
+    }
+}
+
+/*
+ * a[i] = (a[i] + x[i]) + y[i], the same as adding x and then y
+ */
+void
+AddTwoArrays (double *a, const double *x, const double *y, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128d s0 = _mm_add_pd (_mm_loadu_pd (a + i), _mm_loadu_pd (x + i));
+      __m128d s1 = _mm_add_pd (_mm_loadu_pd (a + i + 2), _mm_loadu_pd (x + i + 2));
+      _mm_storeu_pd (a + i, _mm_add_pd (s0, _mm_loadu_pd (y + i)));
+      _mm_storeu_pd (a + i + 2, _mm_add_pd (s1, _mm_loadu_pd (y + i + 2)));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] = (a[i] + x[i]) + y[i];
+    }
+}
+
+/*
+ * a[i] = s[i] / ((t[i] - s[i]) + n[i])
+ */
+void
+SinrArray (double *a, const double *s, const double *t, const double *no, size_t n)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128d s0 = _mm_loadu_pd (s + i);
+      __m128d s1 = _mm_loadu_pd (s + i + 2);
+      __m128d d0 = _mm_add_pd (_mm_sub_pd (_mm_loadu_pd (t + i), s0), _mm_loadu_pd (no + i));
+      __m128d d1 = _mm_add_pd (_mm_sub_pd (_mm_loadu_pd (t + i + 2), s1), _mm_loadu_pd (no + i + 2));
+      _mm_storeu_pd (a + i, _mm_div_pd (s0, d0));
+      _mm_storeu_pd (a + i + 2, _mm_div_pd (s1, d1));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      a[i] = s[i] / ((t[i] - s[i]) + no[i]);
+    }
+}
+
+} // anonymous namespace
+
 
 SpectrumValue::SpectrumValue ()
 {
@@ -102,17 +336,11 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  if (!m_values.empty ())
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      ApplyArray<AddOp> (&m_values[0], &x.m_values[0], m_values.size ());
     }
 }
 
@@ -120,12 +348,9 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  if (!m_values.empty ())
     {
-      *it1 += s;
-      ++it1;
+      ApplyScalar<AddOp> (&m_values[0], s, m_values.size ());
     }
 }
 
@@ -134,17 +359,11 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  if (!m_values.empty ())
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      ApplyArray<SubtractOp> (&m_values[0], &x.m_values[0], m_values.size ());
     }
 }
 
@@ -160,17 +379,11 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  if (!m_values.empty ())
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      ApplyArray<MultiplyOp> (&m_values[0], &x.m_values[0], m_values.size ());
     }
 }
 
@@ -178,12 +391,9 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  if (!m_values.empty ())
     {
-      *it1 *= s;
-      ++it1;
+      ApplyScalar<MultiplyOp> (&m_values[0], s, m_values.size ());
     }
 }
 
@@ -193,17 +403,11 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  if (!m_values.empty ())
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      ApplyArray<DivideOp> (&m_values[0], &x.m_values[0], m_values.size ());
     }
 }
 
@@ -212,12 +416,9 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  if (!m_values.empty ())
     {
-      *it1 /= s;
-      ++it1;
+      ApplyScalar<DivideOp> (&m_values[0], s, m_values.size ());
     }
 }
 
@@ -227,12 +428,9 @@ SpectrumValue::Divide (double s)
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  if (!m_values.empty ())
     {
-      *it1 = -(*it1);
-      ++it1;
+      ApplyScalar<MultiplyOp> (&m_values[0], -1.0, m_values.size ());
     }
 }
 
@@ -457,9 +655,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -654,12 +851,78 @@ SpectrumValue:: operator/= (double rhs)
 SpectrumValue&
 SpectrumValue:: operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
+  if (!m_values.empty ())
+    {
+      FillArray (&m_values[0], rhs, m_values.size ());
+    }
+  return *this;
+}
 
-  while (it1 != m_values.end ())
+
+SpectrumValue&
+SpectrumValue::AddProduct (const SpectrumValue& x, const SpectrumValue& y)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == y.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  NS_ASSERT (m_values.size () == y.m_values.size ());
+  if (!m_values.empty ())
     {
-      *it1 = rhs;
-      ++it1;
+      AddProductArray (&m_values[0], &x.m_values[0], &y.m_values[0], m_values.size ());
+    }
+  return *this;
+}
+
+SpectrumValue&
+SpectrumValue::AddProduct (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  if (!m_values.empty ())
+    {
+      AddScaledArray (&m_values[0], &x.m_values[0], s, m_values.size ());
+    }
+  return *this;
+}
+
+SpectrumValue&
+SpectrumValue::AddAll (const std::vector<Ptr<const SpectrumValue> >& x)
+{
+  if (m_values.empty ())
+    {
+      return *this;
+    }
+  size_t i = 0;
+  for (; i + 2 <= x.size (); i += 2)
+    {
+      NS_ASSERT (m_spectrumModel == x[i]->m_spectrumModel);
+      NS_ASSERT (m_spectrumModel == x[i + 1]->m_spectrumModel);
+      NS_ASSERT (m_values.size () == x[i]->m_values.size ());
+      NS_ASSERT (m_values.size () == x[i + 1]->m_values.size ());
+      AddTwoArrays (&m_values[0], &x[i]->m_values[0], &x[i + 1]->m_values[0], m_values.size ());
+    }
+  if (i < x.size ())
+    {
+      Add (*x[i]);
+    }
+  return *this;
+}
+
+SpectrumValue&
+SpectrumValue::AssignSinr (const SpectrumValue& signal,
+                           const SpectrumValue& allSignals,
+                           const SpectrumValue& noise)
+{
+  NS_ASSERT (signal.m_spectrumModel == allSignals.m_spectrumModel);
+  NS_ASSERT (signal.m_spectrumModel == noise.m_spectrumModel);
+  NS_ASSERT (signal.m_values.size () == allSignals.m_values.size ());
+  NS_ASSERT (signal.m_values.size () == noise.m_values.size ());
+  m_spectrumModel = signal.m_spectrumModel;
+  m_values.resize (signal.m_values.size ());
+  if (!m_values.empty ())
+    {
+      SinrArray (&m_values[0], &signal.m_values[0], &allSignals.m_values[0],
+                 &noise.m_values[0], m_values.size ());
     }
   return *this;
 }
@@ -401,6 +401,57 @@ public:
   SpectrumValue& operator= (double rhs);
 
 
+  /**
+   * Add the component by component product of x and y to *this,
+   * without creating the temporary that *this += x * y would need
+   *
+   * @param x the first factor
+   * @param y the second factor
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddProduct (const SpectrumValue& x, const SpectrumValue& y);
+
+  /**
+   * Add x multiplied by a scalar to *this, without creating the
+   * temporary that *this += x * s would need
+   *
+   * @param x the value to be scaled
+   * @param s the scalar
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddProduct (const SpectrumValue& x, double s);
+
+  /**
+   * Add all the given values to *this, e.g. the power spectral
+   * densities of a set of interferers. The values are added two at a
+   * time, so that *this is read and written half as often as with a
+   * sequence of +=, and the result is the same.
+   *
+   * @param x the values to be added
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddAll (const std::vector<Ptr<const SpectrumValue> >& x);
+
+  /**
+   * Set *this to signal / (allSignals - signal + noise) in a single
+   * pass, i.e., to the SINR of a signal which is included in the sum
+   * of all the signals being received.
+   *
+   * @param signal the power spectral density of the signal
+   * @param allSignals the power spectral density of all the signals,
+   * including signal
+   * @param noise the power spectral density of the noise
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AssignSinr (const SpectrumValue& signal,
+                             const SpectrumValue& allSignals,
+                             const SpectrumValue& noise);
+
+
 
   /**
    *
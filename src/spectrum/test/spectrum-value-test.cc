@@ -243,6 +243,28 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"));
 
 
+  SpectrumValue tv11 (f), tv12 (f), tv13 (f), tv14 (f);
+
+  tv11 = v3;
+  tv11.AddProduct (v1, v2);
+  AddTestCase (new SpectrumValueTestCase (tv11, v3 + v5, "tv11 = v3; tv11.AddProduct (v1, v2)"));
+
+  tv12 = v2;
+  tv12.AddProduct (v1, doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv12, v2 + v9, "tv12 = v2; tv12.AddProduct (v1, doubleValue)"));
+
+  std::vector<Ptr<const SpectrumValue> > signals;
+  signals.push_back (v2.Copy ());
+  signals.push_back (v3.Copy ());
+  signals.push_back (v7.Copy ());
+  tv13 = v1;
+  tv13.AddAll (signals);
+  AddTestCase (new SpectrumValueTestCase (tv13, v1 + v2 + v3 + v7, "tv13 = v1; tv13.AddAll ({v2, v3, v7})"));
+
+  tv14.AssignSinr (v7, v3, v2);
+  AddTestCase (new SpectrumValueTestCase (tv14, v7 / (v3 - v7 + v2), "tv14.AssignSinr (v7, v3, v2)"));
+
+
 }
 
 
@@ -19,12 +19,12 @@
  * Author: Valerio Sartini (valesar@gmail.com)
  */
 
-#include <fstream>
+#include <cctype>
 #include <cstdlib>
 #include <iostream>
-#include <sstream>
 
 #include "ns3/log.h"
+#include "ns3/sgi-hashmap.h"
 #include "orbis-topology-reader.h"
 
 
@@ -55,63 +55,73 @@ OrbisTopologyReader::~OrbisTopologyReader ()
 NodeContainer
 OrbisTopologyReader::Read (void)
 {
-  std::ifstream topgen;
-  topgen.open (GetFileName ().c_str ());
-  std::map<std::string, Ptr<Node> > nodeMap;
+  typedef sgi::hash_map<std::string, Ptr<Node>, StringHash> NodeMap;
+  NodeMap nodeMap;
   NodeContainer nodes;
+  std::vector<char> buffer;
+  std::vector<char *> lines;
 
-  if ( !topgen.is_open () )
+  if (!ReadLines (buffer, lines))
     {
       return nodes;
     }
 
   std::string from;
   std::string to;
-  std::istringstream lineBuffer;
-  std::string line;
 
   int linksNumber = 0;
   int nodesNumber = 0;
 
-  while (!topgen.eof ())
+  for (std::vector<char *>::const_iterator line = lines.begin (); line != lines.end (); ++line)
     {
-      line.clear ();
-      lineBuffer.clear ();
-      from.clear ();
-      to.clear ();
-
-      getline (topgen,line);
-      lineBuffer.str (line);
-      lineBuffer >> from;
-      lineBuffer >> to;
+      // the first two whitespace separated words of the line
+      const char *p = *line;
+      const char *word[2];
+      size_t length[2];
+      for (int i = 0; i < 2; i++)
+        {
+          while (std::isspace ((unsigned char)*p))
+            {
+              ++p;
+            }
+          word[i] = p;
+          while (*p != '\0' && !std::isspace ((unsigned char)*p))
+            {
+              ++p;
+            }
+          length[i] = p - word[i];
+        }
+      from.assign (word[0], length[0]);
+      to.assign (word[1], length[1]);
 
       if ( (!from.empty ()) && (!to.empty ()) )
         {
           NS_LOG_INFO ( linksNumber << " From: " << from << " to: " << to );
-          if ( nodeMap[from] == 0 )
+          Ptr<Node> fromNode = nodeMap[from];
+          if ( fromNode == 0 )
             {
-              Ptr<Node> tmpNode = CreateObject<Node> ();
-              nodeMap[from] = tmpNode;
-              nodes.Add (tmpNode);
+              fromNode = CreateObject<Node> ();
+              nodeMap[from] = fromNode;
+              nodes.Add (fromNode);
               nodesNumber++;
             }
 
-          if (nodeMap[to] == 0)
+          Ptr<Node> toNode = nodeMap[to];
+          if (toNode == 0)
             {
-              Ptr<Node> tmpNode = CreateObject<Node> ();
-              nodeMap[to] = tmpNode;
-              nodes.Add (tmpNode);
+              toNode = CreateObject<Node> ();
+              nodeMap[to] = toNode;
+              nodes.Add (toNode);
               nodesNumber++;
             }
 
-          Link link ( nodeMap[from], from, nodeMap[to], to );
+          Link link ( fromNode, from, toNode, to );
           AddLink (link);
 
           linksNumber++;
         }
     }
   NS_LOG_INFO ("Orbis topology created with " << nodesNumber << " nodes and " << linksNumber << " links");
-  topgen.close ();
 
   return nodes;
 }
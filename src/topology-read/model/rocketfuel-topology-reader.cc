@@ -22,7 +22,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
-#include <regex.h>
+#include <cstring>
 #include <algorithm>
 
 #include "ns3/log.h"
@@ -43,6 +43,9 @@ TypeId RocketfuelTopologyReader::GetTypeId (void)
 }
 
 RocketfuelTopologyReader::RocketfuelTopologyReader ()
+  : m_linksNumber (0),
+    m_nodesNumber (0),
+    m_isLatencies (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -54,106 +57,363 @@ RocketfuelTopologyReader::~RocketfuelTopologyReader ()
 
 /* uid @loc [+] [bb] (num_neigh) [&ext] -> <nuid-1> <nuid-2> ... {-euid} ... =name[!] rn */
 
-#define REGMATCH_MAX 16
-
-#define START "^"
-#define END "$"
-#define SPACE "[ \t]+"
-#define MAYSPACE "[ \t]*"
-
-#define ROCKETFUEL_MAPS_LINE \
-  START "(-*[0-9]+)" SPACE "(@[?A-Za-z0-9,+.]+)" SPACE \
-  "(\\+)*" MAYSPACE "(bb)*" MAYSPACE \
-  "\\(([0-9]+)\\)" SPACE "(&[0-9]+)*" MAYSPACE \
-  "->" MAYSPACE "(<[0-9 \t<>]+>)*" MAYSPACE \
-  "(\\{-[0-9\\{\\} \t-]+\\})*" SPACE \
-  "=([A-Za-z0-9.!-]+)" SPACE "r([0-9])" \
-  MAYSPACE END
-
-#define ROCKETFUEL_WEIGHTS_LINE \
-  START "([A-Za-z,+.]+)([0-9]+)" SPACE "([A-Za-z,+.]+)([0-9]+)" SPACE "([0-9.]+)" MAYSPACE END
-  //START "([A-Za-z,+.]+)" SPACE "([0-9]+)" SPACE "([A-Za-z,+.]+)" SPACE "([0-9]+)" SPACE "([0-9.]+)" MAYSPACE END
-  // C++ regex library can't seem to support capturing adjacent groups so I had to modify rocketfuel traces for above pattern
-// Actually, it looks like the problem is them using destructive modifications to the line by inserting null characters to terminate c-strings
-
-int linksNumber = 0;
-int nodesNumber = 0;
-// nodeMap indexed by "uid"
-std::map<std::string, Ptr<Node> > nodeMap;
-// linkMap indexed by "fromUid>toUid"
-std::map<std::string, TopologyReader::Link *> linkMap;
-// mapping of UIDs to IP addresses when alias files are available
-std::map<std::string, std::string> nodeAddresses;
-// whether the file contains latencies or weights
-bool isLatencies;
+#define MAPS_FIELDS 10
+#define WEIGHTS_FIELDS 5
 
-std::map<std::string, std::string> 
-RocketfuelTopologyReader::ReadLatencies (std::string filename)
+/*
+ * The lines are split by hand rather than with a regex, which was
+ * compiled again for every line.  The tokenizers accept the same lines as
+ * these expressions, and find the same fields (the groups):
+ *
+ * maps:    ^(-*[0-9]+)[ \t]+(@[?A-Za-z0-9,+.]+)[ \t]+(\+)*[ \t]*(bb)*[ \t]*
+ *          \(([0-9]+)\)[ \t]+(&[0-9]+)*[ \t]*->[ \t]*(<[0-9 \t<>]+>)*[ \t]*
+ *          (\{-[0-9\{\} \t-]+\})*[ \t]+=([A-Za-z0-9.!-]+)[ \t]+r([0-9])[ \t]*$
+ *
+ * weights: ^([A-Za-z,+.]+)([0-9]*)[ \t]+([A-Za-z,+.]+)([0-9]*)[ \t]+([0-9.]+)[ \t]*$
+ *
+ * The uids of the weights lines are optional, as in the files of
+ * latencies between locations.  The fields are copied out of the line
+ * rather than terminated in place, as a location is followed by its uid.
+ */
+
+static inline bool
+IsBlank (char c)
 {
-  std::map<std::string, std::string> weights;
+  return c == ' ' || c == '\t';
+}
 
-  std::ifstream weightFile;
-  weightFile.open (filename.c_str ());
+static inline bool
+IsDigit (char c)
+{
+  return c >= '0' && c <= '9';
+}
 
-  std::istringstream lineBuffer;
-  std::string line;
-  int lineNumber = 0;
-  char errbuf[512];
-  char *buf;
+static inline bool
+IsLetter (char c)
+{
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
 
-  if (!weightFile.is_open ())
+static inline const char *
+SkipBlanks (const char *p)
+{
+  while (IsBlank (*p))
     {
-      NS_LOG_WARN ("Couldn't open the file " << filename);
-      return weights;
+      ++p;
     }
+  return p;
+}
 
-  while (!weightFile.eof ())
+static inline const char *
+SkipDigits (const char *p)
+{
+  while (IsDigit (*p))
     {
-      int ret;
-      char *argv[REGMATCH_MAX];
+      ++p;
+    }
+  return p;
+}
 
-      lineNumber++;
-      line.clear ();
-      lineBuffer.clear ();
+// [?A-Za-z0-9,+.]
+static inline bool
+IsMapsLocationChar (char c)
+{
+  return IsLetter (c) || IsDigit (c) || c == '?' || c == ',' || c == '+' || c == '.';
+}
 
-      getline (weightFile, line);
-      if (weightFile.eof ())
-        break;
-      buf = (char *)line.c_str ();
+// [A-Za-z,+.]
+static inline bool
+IsWeightsLocationChar (char c)
+{
+  return IsLetter (c) || c == ',' || c == '+' || c == '.';
+}
+
+// [0-9 \t<>]
+static inline bool
+IsNeighborChar (char c)
+{
+  return IsDigit (c) || IsBlank (c) || c == '<' || c == '>';
+}
+
+// [0-9{} \t-]
+static inline bool
+IsExternalChar (char c)
+{
+  return IsDigit (c) || IsBlank (c) || c == '{' || c == '}' || c == '-';
+}
+
+// [A-Za-z0-9.!-]
+static inline bool
+IsNameChar (char c)
+{
+  return IsLetter (c) || IsDigit (c) || c == '.' || c == '!' || c == '-';
+}
 
-      regmatch_t regmatch[REGMATCH_MAX];
-      regex_t regex;
+/*
+ * Matches the longest run of characters accepted by isChar which starts
+ * with open and ends with close, at least minLength long; returns the end
+ * of the run, or p if there is none.
+ */
+static const char *
+MatchBracketed (const char *p, char open, char close, size_t minLength, bool (*isChar)(char))
+{
+  if (*p != open)
+    {
+      return p;
+    }
+  const char *end = p + 1;
+  while (isChar (*end) || *end == close)
+    {
+      ++end;
+    }
+  while (end > p && end[-1] != close)
+    {
+      --end;
+    }
+  return (size_t)(end - p) >= minLength ? end : p;
+}
 
-      ret = regcomp (&regex, ROCKETFUEL_WEIGHTS_LINE, REG_EXTENDED | REG_NEWLINE);
-      if (ret != 0)
+/*
+ * Copies the fields found in a line to fields, each followed by a '\0',
+ * and points argv to them (or to NULL for the fields not found).
+ */
+static void
+CopyFields (const char *begin[], const char *end[], int n, std::vector<char> &fields, char *argv[])
+{
+  size_t size = 0;
+  for (int i = 0; i < n; i++)
+    {
+      if (begin[i] != NULL)
         {
-          regerror (ret, &regex, errbuf, sizeof (errbuf));
-          regfree (&regex);
-          break;
+          size += end[i] - begin[i] + 1;
+        }
+    }
+  fields.resize (size);
+  char *field = size ? &fields[0] : NULL;
+  for (int i = 0; i < n; i++)
+    {
+      if (begin[i] == NULL)
+        {
+          argv[i] = NULL;
+          continue;
         }
+      size_t length = end[i] - begin[i];
+      std::memcpy (field, begin[i], length);
+      field[length] = '\0';
+      argv[i] = field;
+      field += length + 1;
+    }
+}
+
+bool
+RocketfuelTopologyReader::TokenizeMapsLine (const char *line, std::vector<char> &fields, char *argv[])
+{
+  const char *begin[MAPS_FIELDS];
+  const char *end[MAPS_FIELDS];
+  for (int i = 0; i < MAPS_FIELDS; i++)
+    {
+      begin[i] = end[i] = NULL;
+    }
+  const char *p = line;
+
+  // uid
+  begin[0] = p;
+  while (*p == '-')
+    {
+      ++p;
+    }
+  if (!IsDigit (*p))
+    {
+      return false;
+    }
+  p = end[0] = SkipDigits (p);
+  if (!IsBlank (*p))
+    {
+      return false;
+    }
+  p = SkipBlanks (p);
+
+  // @location
+  if (*p != '@' || !IsMapsLocationChar (p[1]))
+    {
+      return false;
+    }
+  begin[1] = p++;
+  while (IsMapsLocationChar (*p))
+    {
+      ++p;
+    }
+  end[1] = p;
+  if (!IsBlank (*p))
+    {
+      return false;
+    }
+  p = SkipBlanks (p);
+
+  // [+]
+  while (*p == '+')
+    {
+      begin[2] = p++;
+      end[2] = p;
+    }
+  p = SkipBlanks (p);
+
+  // [bb]
+  while (p[0] == 'b' && p[1] == 'b')
+    {
+      begin[3] = p;
+      p += 2;
+      end[3] = p;
+    }
+  p = SkipBlanks (p);
+
+  // (num_neigh)
+  if (*p != '(' || !IsDigit (p[1]))
+    {
+      return false;
+    }
+  begin[4] = ++p;
+  p = end[4] = SkipDigits (p);
+  if (*p != ')' || !IsBlank (p[1]))
+    {
+      return false;
+    }
+  p = SkipBlanks (p + 1);
+
+  // [&ext]
+  while (*p == '&' && IsDigit (p[1]))
+    {
+      begin[5] = p;
+      p = end[5] = SkipDigits (p + 1);
+    }
+  p = SkipBlanks (p);
+
+  // ->
+  if (p[0] != '-' || p[1] != '>')
+    {
+      return false;
+    }
+  const char *last = p + 2;
+  p = SkipBlanks (last);
+
+  // <nuid-1> <nuid-2> ...
+  const char *neighbors = MatchBracketed (p, '<', '>', 3, IsNeighborChar);
+  if (neighbors != p)
+    {
+      begin[6] = p;
+      end[6] = last = neighbors;
+      p = SkipBlanks (neighbors);
+    }
 
-      ret = regexec (&regex, buf, REGMATCH_MAX, regmatch, 0);
-      if (ret == REG_NOMATCH)
+  // {-euid} ...
+  const char *externals = MatchBracketed (p, '{', '}', 4, IsExternalChar);
+  if (externals != p && p[1] == '-')
+    {
+      begin[7] = p;
+      end[7] = last = externals;
+      p = SkipBlanks (externals);
+    }
+
+  // =name, after at least one blank
+  if (p == last || *p != '=' || !IsNameChar (p[1]))
+    {
+      return false;
+    }
+  begin[8] = ++p;
+  while (IsNameChar (*p))
+    {
+      ++p;
+    }
+  end[8] = p;
+  if (!IsBlank (*p))
+    {
+      return false;
+    }
+  p = SkipBlanks (p);
+
+  // rn
+  if (p[0] != 'r' || !IsDigit (p[1]))
+    {
+      return false;
+    }
+  begin[9] = p + 1;
+  end[9] = p + 2;
+  if (*SkipBlanks (p + 2) != '\0')
+    {
+      return false;
+    }
+
+  CopyFields (begin, end, MAPS_FIELDS, fields, argv);
+  return true;
+}
+
+bool
+RocketfuelTopologyReader::TokenizeWeightsLine (const char *line, std::vector<char> &fields, char *argv[])
+{
+  const char *begin[WEIGHTS_FIELDS];
+  const char *end[WEIGHTS_FIELDS];
+  const char *p = line;
+
+  // location1uid1 location2uid2
+  for (int i = 0; i < 4; i += 2)
+    {
+      if (!IsWeightsLocationChar (*p))
         {
-          NS_LOG_WARN ("match failed (maps file): %s" << buf);
-          regfree (&regex);
-          break;
+          return false;
         }
-      
-      line = buf;
-      
-      /* regmatch[0] is the entire strings that matched */
-      for (int i = 1; i < REGMATCH_MAX; i++)
+      begin[i] = p;
+      while (IsWeightsLocationChar (*p))
         {
-          if (regmatch[i].rm_so == -1)
-            {
-              argv[i - 1] = NULL;
-            }
-          else
-            {
-              line[regmatch[i].rm_eo] = '\0';
-              argv[i - 1] = &line[regmatch[i].rm_so];
-            }
+          ++p;
+        }
+      end[i] = begin[i + 1] = p;
+      p = end[i + 1] = SkipDigits (p);
+      if (!IsBlank (*p))
+        {
+          return false;
+        }
+      p = SkipBlanks (p);
+    }
+
+  // weight
+  begin[4] = p;
+  while (IsDigit (*p) || *p == '.')
+    {
+      ++p;
+    }
+  end[4] = p;
+  if (begin[4] == end[4] || *SkipBlanks (p) != '\0')
+    {
+      return false;
+    }
+
+  CopyFields (begin, end, WEIGHTS_FIELDS, fields, argv);
+  return true;
+}
+
+std::map<std::string, std::string> 
+RocketfuelTopologyReader::ReadLatencies (std::string filename)
+{
+  std::map<std::string, std::string> weights;
+
+  Ptr<RocketfuelTopologyReader> reader = CreateObject<RocketfuelTopologyReader> ();
+  reader->SetFileName (filename);
+  std::vector<char> buffer;
+  std::vector<char *> lines;
+  std::vector<char> fields;
+  if (!reader->ReadLines (buffer, lines))
+    {
+      NS_LOG_WARN ("Couldn't open the file " << filename);
+      return weights;
+    }
+
+  for (std::vector<char *>::const_iterator it = lines.begin (); it != lines.end (); ++it)
+    {
+      char *argv[WEIGHTS_FIELDS];
+      if (!TokenizeWeightsLine (*it, fields, argv))
+        {
+          NS_LOG_WARN ("match failed (weights file): " << *it);
+          break;
         }
 
       std::string loc1 = argv[0];
@@ -170,14 +430,24 @@ RocketfuelTopologyReader::ReadLatencies (std::string filename)
           NS_LOG_INFO (key << ": " << weight << "ms added");
           weights[key] = weight;
         }
-      
-      regfree (&regex);
     }
 
-  weightFile.close ();
   return weights;
 }
 
+Ptr<Node>
+RocketfuelTopologyReader::GetNode (const std::string &uid, NodeContainer &nodes)
+{
+  Ptr<Node> &node = m_nodeMap[uid];
+  if (node == 0)
+    {
+      node = CreateObject<Node> ();
+      nodes.Add (node);
+      m_nodesNumber++;
+    }
+  return node;
+}
+
 NodeContainer
 RocketfuelTopologyReader::GenerateFromMapsFile (int argc, char *argv[])
 {
@@ -278,13 +548,7 @@ RocketfuelTopologyReader::GenerateFromMapsFile (int argc, char *argv[])
   // Create node and link
   if (!uid.empty ())
     {
-      if (nodeMap[uid] == 0)
-        {
-           Ptr<Node> tmpNode = CreateObject<Node> ();
-          nodeMap[uid] = tmpNode;
-          nodes.Add (tmpNode);
-          nodesNumber++;
-        }
+      Ptr<Node> node = GetNode (uid, nodes);
 
       for (uint32_t i = 0; i < neigh_list.size (); ++i)
         {
@@ -295,37 +559,32 @@ RocketfuelTopologyReader::GenerateFromMapsFile (int argc, char *argv[])
               return nodes;
             }
 
-          if (nodeMap[nuid] == 0)
-            {
-              Ptr<Node> tmpNode = CreateObject<Node> ();
-              nodeMap[nuid] = tmpNode;
-              nodes.Add (tmpNode);
-              nodesNumber++;
-            }
+          Ptr<Node> neighbor = GetNode (nuid, nodes);
 
           // Only create link if the neighbor didn't create it already!
-          Link *link = linkMap[nuid + ">" + uid];
-          if (linkMap[nuid + ">" + uid] == 0)
+          uint64_t key = ((uint64_t)neighbor->GetId () << 32) | node->GetId ();
+          LinkMap::iterator link = m_linkMap.find (key);
+          if (link == m_linkMap.end ())
             {
-              NS_LOG_INFO (linksNumber << ":" << nodesNumber << " From: " << uid << " to: " << nuid);
-              link = new Link(nodeMap[uid], uid, nodeMap[nuid], nuid);
+              NS_LOG_INFO (m_linksNumber << ":" << m_nodesNumber << " From: " << uid << " to: " << nuid);
+              m_pendingLinks.push_back (Link (node, uid, neighbor, nuid));
+              Link *newLink = &m_pendingLinks.back ();
 
-              link->SetAttribute("From Location", loc);
-              //link->SetAttribute("From Address", name);
-              link->SetAttribute("From Address", nodeAddresses[name]);
+              newLink->SetAttribute ("From Location", loc);
+              //newLink->SetAttribute("From Address", name);
+              newLink->SetAttribute ("From Address", m_nodeAddresses[name]);
 
-              linkMap[uid + ">" + nuid] = link;
+              m_linkMap[((uint64_t)node->GetId () << 32) | neighbor->GetId ()] = newLink;
             }
           else
             {
-              link->SetAttribute("To Location", loc);
-              //link->SetAttribute("To Address", name);
-              link->SetAttribute("To Address", nodeAddresses[name]);
+              link->second->SetAttribute ("To Location", loc);
+              //link->second->SetAttribute("To Address", name);
+              link->second->SetAttribute ("To Address", m_nodeAddresses[name]);
 
               //update links with full information now that we have it
-              AddLink (*link);
-              linksNumber++;
-              linkMap[nuid + ">" + uid] = link;
+              AddLink (*link->second);
+              m_linksNumber++;
             }
         }
     }
@@ -347,7 +606,7 @@ RocketfuelTopologyReader::GenerateFromWeightsFile (int argc, char *argv[])
   for (int i =0; i < argc; i++)
     NS_LOG_INFO(argv[i]);
 
-  NS_LOG_INFO (linksNumber << ":" << nodesNumber << " From: " << uid1 << " (" << loc1 << ") to: " 
+  NS_LOG_INFO (m_linksNumber << ":" << m_nodesNumber << " From: " << uid1 << " (" << loc1 << ") to: " 
                << uid2 << " (" << loc2 << ") with weight: " << weight);
 
   std::replace(loc1.begin(), loc1.end(), '+', ' ');
@@ -356,40 +615,26 @@ RocketfuelTopologyReader::GenerateFromWeightsFile (int argc, char *argv[])
   // Create node and link
   if (!uid1.empty () && !uid2.empty ())
     {
-      if (nodeMap[uid1] == 0)
-        {
-          Ptr<Node> tmpNode = CreateObject<Node> ();
-          nodeMap[uid1] = tmpNode;
-          nodes.Add (tmpNode);
-          nodesNumber++;
-        }
-
-      if (nodeMap[uid2] == 0)
-        {
-          Ptr<Node> tmpNode = CreateObject<Node> ();
-          nodeMap[uid2] = tmpNode;
-          nodes.Add (tmpNode);
-          nodesNumber++;
-        }
-
-      NS_LOG_INFO (linksNumber << ":" << nodesNumber << " From: " << uid1 << " (" << loc1 << ") to: " 
-                   << uid2 << " (" << loc2 << ") with weight: " << weight);
+      Ptr<Node> node1 = GetNode (uid1, nodes);
+      Ptr<Node> node2 = GetNode (uid2, nodes);
 
       // Only create link if the neighbor didn't create it already!
-      if (linkMap[uid2 + ">" + uid1] == 0)
+      uint64_t key = ((uint64_t)node2->GetId () << 32) | node1->GetId ();
+      if (m_linkMap.find (key) == m_linkMap.end ())
         {
-          NS_LOG_INFO (linksNumber << ":" << nodesNumber << " From: " << uid1 << " (" << loc1 << ") to: " 
+          NS_LOG_INFO (m_linksNumber << ":" << m_nodesNumber << " From: " << uid1 << " (" << loc1 << ") to: " 
                        << uid2 << " (" << loc2 << ") with weight: " << weight);
 
-          Link *link = new Link(nodeMap[uid1], uid1, nodeMap[uid2], uid2);
+          m_pendingLinks.push_back (Link (node1, uid1, node2, uid2));
+          Link *link = &m_pendingLinks.back ();
           
           link->SetAttribute("From Location", loc1);
           link->SetAttribute("To Location", loc2);
-          link->SetAttribute( (isLatencies ? "Latency" : "Weight"), weight);
+          link->SetAttribute( (m_isLatencies ? "Latency" : "Weight"), weight);
           
-          linkMap[uid1 + ">" + uid2] = link;
+          m_linkMap[((uint64_t)node1->GetId () << 32) | node2->GetId ()] = link;
           AddLink (*link);
-          linksNumber++;
+          m_linksNumber++;
         }
     }
   return nodes;
@@ -398,40 +643,20 @@ RocketfuelTopologyReader::GenerateFromWeightsFile (int argc, char *argv[])
 enum RocketfuelTopologyReader::RF_FileType
 RocketfuelTopologyReader::GetFileType (const char *line)
 {
-  int ret;
-  regmatch_t regmatch[REGMATCH_MAX];
-  regex_t regex;
-  char errbuf[512];
+  std::vector<char> fields;
+  char *argv[MAPS_FIELDS];
 
   // Check whether MAPS file or not
-  ret = regcomp (&regex, ROCKETFUEL_MAPS_LINE, REG_EXTENDED | REG_NEWLINE);
-  if (ret != 0)
-    {
-      regerror (ret, &regex, errbuf, sizeof (errbuf));
-      return RF_UNKNOWN;
-    }
-  ret = regexec (&regex, line, REGMATCH_MAX, regmatch, 0);
-  if (ret != REG_NOMATCH)
+  if (TokenizeMapsLine (line, fields, argv))
     {
-      regfree (&regex);
       return RF_MAPS;
     }
-  regfree (&regex);
 
   // Check whether Weights file or not
-  ret = regcomp (&regex, ROCKETFUEL_WEIGHTS_LINE, REG_EXTENDED | REG_NEWLINE);
-  if (ret != 0)
+  if (TokenizeWeightsLine (line, fields, argv))
     {
-      regerror (ret, &regex, errbuf, sizeof (errbuf));
-      return RF_UNKNOWN;
-    }
-  ret = regexec (&regex, line, REGMATCH_MAX, regmatch, 0);
-  if (ret != REG_NOMATCH)
-    {
-      regfree (&regex);
       return RF_WEIGHTS;
     }
-  regfree (&regex);
 
   return RF_UNKNOWN;
 }
@@ -477,7 +702,7 @@ RocketfuelTopologyReader::TryBuildAliases (void)
       address = line.substr (firstSpace + 1, secondSpace - firstSpace - 1);
       name = line.substr (secondSpace + 1);
       
-      nodeAddresses[name] = address;
+      m_nodeAddresses[name] = address;
       NS_LOG_INFO ("Uid: " << uid << ", IP: " << address << ", Name: " << name);
     }
 
@@ -487,41 +712,25 @@ RocketfuelTopologyReader::TryBuildAliases (void)
 NodeContainer
 RocketfuelTopologyReader::Read (void)
 {
-  std::ifstream topgen;
-  topgen.open (GetFileName ().c_str ());
   NodeContainer nodes;
-
-  std::istringstream lineBuffer;
-  std::string line;
-  int lineNumber = 0;
+  std::vector<char> buffer;
+  std::vector<char *> lines;
+  std::vector<char> fields;
   enum RF_FileType ftype = RF_UNKNOWN;
-  char errbuf[512];
-  //char buf[2048];
-  char *buf;
 
-  if (!topgen.is_open ())
+  if (!ReadLines (buffer, lines))
     {
       NS_LOG_WARN ("Couldn't open the file " << GetFileName ());
       return nodes;
     }
 
-  while (!topgen.eof ())
+  for (size_t lineNumber = 0; lineNumber < lines.size (); lineNumber++)
     {
-      int ret;
-      int argc;
-      char *argv[REGMATCH_MAX];
-
-      lineNumber++;
-      line.clear ();
-      lineBuffer.clear ();
-
-      getline (topgen, line);
-      if (topgen.eof ())
-        break;
-      buf = (char *)line.c_str ();
-      //strncpy(buf, (char *)line.c_str(), sizeof(buf));
+      int argc = 0;
+      char *argv[MAPS_FIELDS];
+      char *buf = lines[lineNumber];
 
-      if (lineNumber == 1)
+      if (lineNumber == 0)
         {
           ftype = GetFileType (buf);
           if (ftype == RF_UNKNOWN)
@@ -535,66 +744,27 @@ RocketfuelTopologyReader::Read (void)
           // Determine whether it's weights or latencies
           else if (ftype == RF_WEIGHTS)
             {
-              isLatencies = (GetFileName ().find("latencies") != std::string::npos);
+              m_isLatencies = (GetFileName ().find("latencies") != std::string::npos);
             }
         }
 
-      regmatch_t regmatch[REGMATCH_MAX];
-      regex_t regex;
-
       if (ftype == RF_MAPS)
         {
-          ret = regcomp (&regex, ROCKETFUEL_MAPS_LINE, REG_EXTENDED | REG_NEWLINE);
-          if (ret != 0)
-            {
-              regerror (ret, &regex, errbuf, sizeof (errbuf));
-              regfree (&regex);
-              break;
-            }
-
-          ret = regexec (&regex, buf, REGMATCH_MAX, regmatch, 0);
-          if (ret == REG_NOMATCH)
+          if (!TokenizeMapsLine (buf, fields, argv))
             {
-              NS_LOG_WARN ("match failed (maps file): %s" << buf);
-              regfree (&regex);
+              NS_LOG_WARN ("match failed (maps file): " << buf);
               break;
             }
+          argc = MAPS_FIELDS;
         }
       else if (ftype == RF_WEIGHTS)
         {
-          ret = regcomp (&regex, ROCKETFUEL_WEIGHTS_LINE, REG_EXTENDED | REG_NEWLINE);
-          if (ret != 0)
-            {
-              regerror (ret, &regex, errbuf, sizeof (errbuf));
-              regfree (&regex);
-              break;
-            }
-
-          ret = regexec (&regex, buf, REGMATCH_MAX, regmatch, 0);
-          if (ret == REG_NOMATCH)
+          if (!TokenizeWeightsLine (buf, fields, argv))
             {
-              NS_LOG_WARN ("match failed (weights file): %s" << buf);
-              regfree (&regex);
+              NS_LOG_WARN ("match failed (weights file): " << buf);
               break;
             }
-        }
-
-      line = buf;
-      argc = 0;
-
-      /* regmatch[0] is the entire strings that matched */
-      for (int i = 1; i < REGMATCH_MAX; i++)
-        {
-          if (regmatch[i].rm_so == -1)
-            {
-              argv[i - 1] = NULL;
-            }
-          else
-            {
-              line[regmatch[i].rm_eo] = '\0';
-              argv[i - 1] = &line[regmatch[i].rm_so];
-              argc = i;
-            }
+          argc = WEIGHTS_FIELDS;
         }
 
       if (ftype == RF_MAPS)
@@ -609,14 +779,13 @@ RocketfuelTopologyReader::Read (void)
         {
           NS_LOG_WARN ("Unsupported file format (only Maps/Weights are supported)");
         }
-
-      regfree (&regex);
     }
 
+  // links whose other end never showed up are dropped
+  m_linkMap.clear ();
+  m_pendingLinks.clear ();
 
-  topgen.close ();
-
-  NS_LOG_INFO ("Rocketfuel topology created with " << nodesNumber << " nodes and " << linksNumber << " links");
+  NS_LOG_INFO ("Rocketfuel topology created with " << m_nodesNumber << " nodes and " << m_linksNumber << " links");
   return nodes;
 }
 
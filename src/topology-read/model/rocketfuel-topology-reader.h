@@ -22,8 +22,10 @@
 #define ROCKETFUEL_TOPOLOGY_READER_H
 
 #include "ns3/nstime.h"
+#include "ns3/sgi-hashmap.h"
 #include "topology-reader.h"
 #include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -61,6 +63,19 @@ public:
    */
   virtual NodeContainer Read (void);
 
+  /**
+   * \brief Reads a file of latencies (or weights) between locations.
+   *
+   * Each line holds two locations, each optionally followed by the uid of
+   * a router there, and the latency between them, e.g.
+   * "San+Jose,+CA4062 Anaheim,+CA4101 4" or "San+Jose,+CA Anaheim,+CA 4".
+   *
+   * \param filename the name of the file
+   *
+   * \return the latencies, indexed by "location1 -> location2" where the
+   * '+' of the locations are replaced by spaces; only the first latency
+   * given for a pair is kept.
+   */
   static std::map<std::string, std::string> ReadLatencies (std::string filename);
 
 
@@ -75,6 +90,14 @@ private:
   NodeContainer GenerateFromWeightsFile (int argc, char *argv[]);
   // Attempts to find the alias file for the given input map file and builds a map of aliases
   void TryBuildAliases ();
+  // Returns the node with the given uid, creating it (and adding it to nodes) if needed
+  Ptr<Node> GetNode (const std::string &uid, NodeContainer &nodes);
+
+  // Tokenizers for the lines of the two formats: on success, argv points to
+  // copies of the fields of the line stored in fields (or to NULL for the
+  // optional ones that are missing).
+  static bool TokenizeMapsLine (const char *line, std::vector<char> &fields, char *argv[]);
+  static bool TokenizeWeightsLine (const char *line, std::vector<char> &fields, char *argv[]);
 
   enum RF_FileType
   {
@@ -84,6 +107,29 @@ private:
   };
   enum RF_FileType GetFileType (const char *);
 
+  struct LinkKeyHash
+  {
+    size_t operator () (uint64_t key) const
+    {
+      return (size_t)(key ^ (key >> 29));
+    }
+  };
+  typedef sgi::hash_map<std::string, Ptr<Node>, StringHash> NodeMap;
+  // links waiting for their other end, indexed by (from node id, to node id)
+  typedef sgi::hash_map<uint64_t, Link *, LinkKeyHash> LinkMap;
+  typedef sgi::hash_map<std::string, std::string, StringHash> AddressMap;
+
+  int m_linksNumber;
+  int m_nodesNumber;
+  // nodes indexed by "uid"
+  NodeMap m_nodeMap;
+  LinkMap m_linkMap;
+  std::deque<Link> m_pendingLinks;
+  // mapping of names to IP addresses when alias files are available
+  AddressMap m_nodeAddresses;
+  // whether the file contains latencies or weights
+  bool m_isLatencies;
+
   // end class RocketfuelTopologyReader
 };
 
@@ -19,7 +19,19 @@
  * Author: Valerio Sartini (valesar@gmail.com)
  */
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "ns3/log.h"
+#include "ns3/sgi-hashmap.h"
 
 #include "topology-reader.h"
 
@@ -93,6 +105,376 @@ TopologyReader::AddLink (Link link)
   return;
 }
 
+size_t
+TopologyReader::StringHash::operator () (const std::string &s) const
+{
+  // FNV-1a
+  size_t h = 2166136261U;
+  for (std::string::const_iterator c = s.begin (); c != s.end (); ++c)
+    {
+      h = (h ^ (unsigned char)*c) * 16777619U;
+    }
+  return h;
+}
+
+bool
+TopologyReader::ReadLines (std::vector<char> &buffer, std::vector<char *> &lines) const
+{
+  std::ifstream file (m_fileName.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      return false;
+    }
+  file.seekg (0, std::ios::end);
+  std::streamoff size = file.tellg ();
+  file.seekg (0, std::ios::beg);
+  buffer.resize (size + 1);
+  if (size > 0)
+    {
+      file.read (&buffer[0], size);
+      buffer.resize (file.gcount () + 1);
+    }
+  buffer.back () = '\0';
+
+  // like getline, a last line without a newline is still a line,
+  // but nothing after the last newline is not
+  char *begin = &buffer[0];
+  char *end = begin + buffer.size () - 1;
+  while (begin < end)
+    {
+      char *newline = (char *)std::memchr (begin, '\n', end - begin);
+      if (newline == 0)
+        {
+          newline = end;
+        }
+      *newline = '\0';
+      lines.push_back (begin);
+      begin = newline + 1;
+    }
+  return true;
+}
+
+/* Binary cache of a topology */
+
+namespace {
+
+const char g_cacheMagic[8] = { 'N', 'S', '3', 'T', 'O', 'P', 'O', '\0' };
+const uint32_t g_cacheVersion = 2;
+const uint32_t g_cacheByteOrder = 0x01020304;
+
+struct CacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t sourceSize;
+  int64_t sourceMtime;
+  uint64_t latencySourceSize;
+  int64_t latencySourceMtime;
+  uint32_t nNodes;
+  uint32_t nLinks;
+  uint32_t nAttributes;
+  uint32_t nLatencies;
+  uint32_t nStrings;
+  uint32_t stringBytes;
+};
+
+struct CacheLink
+{
+  uint32_t from;
+  uint32_t to;
+  uint32_t fromName;
+  uint32_t toName;
+  uint32_t firstAttribute;
+  uint32_t nAttributes;
+};
+
+struct CacheAttribute
+{
+  uint32_t name;
+  uint32_t value;
+};
+
+/*
+ * Interns the strings of a cache: each distinct string gets an index in
+ * a single table of offsets into a blob of '\0' terminated strings.
+ */
+class CacheStrings
+{
+public:
+  CacheStrings ()
+  {
+    m_offsets.push_back (0);
+    Intern ("");
+  }
+  uint32_t Intern (const std::string &s)
+  {
+    Index::iterator it = m_index.find (s);
+    if (it != m_index.end ())
+      {
+        return it->second;
+      }
+    uint32_t id = m_offsets.size () - 1;
+    m_index[s] = id;
+    m_blob.insert (m_blob.end (), s.begin (), s.end ());
+    m_blob.push_back ('\0');
+    m_offsets.push_back (m_blob.size ());
+    return id;
+  }
+  const std::vector<uint32_t> &GetOffsets (void) const
+  {
+    return m_offsets;
+  }
+  const std::vector<char> &GetBlob (void) const
+  {
+    return m_blob;
+  }
+private:
+  typedef sgi::hash_map<std::string, uint32_t, TopologyReader::StringHash> Index;
+  Index m_index;
+  std::vector<uint32_t> m_offsets;
+  std::vector<char> m_blob;
+};
+
+bool
+GetSourceStat (const std::string &fileName, uint64_t &size, int64_t &mtime)
+{
+  struct stat st;
+  if (::stat (fileName.c_str (), &st) != 0)
+    {
+      return false;
+    }
+  size = st.st_size;
+  mtime = st.st_mtime;
+  return true;
+}
+
+} // anonymous namespace
+
+bool
+TopologyReader::WriteCache (const std::string &cacheFile, NodeContainer nodes,
+                            const std::map<std::string, std::string> &latencies,
+                            const std::string &latencyFile) const
+{
+  NS_LOG_FUNCTION (this << cacheFile << nodes.GetN () << latencies.size () << latencyFile);
+
+  CacheHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, g_cacheMagic, sizeof (header.magic));
+  header.version = g_cacheVersion;
+  header.byteOrder = g_cacheByteOrder;
+  if (!GetSourceStat (m_fileName, header.sourceSize, header.sourceMtime))
+    {
+      NS_LOG_WARN ("Couldn't stat the file " << m_fileName);
+      return false;
+    }
+  if (!latencyFile.empty () && !GetSourceStat (latencyFile, header.latencySourceSize, header.latencySourceMtime))
+    {
+      NS_LOG_WARN ("Couldn't stat the file " << latencyFile);
+      return false;
+    }
+
+  std::map<uint32_t, uint32_t> nodeIndex;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodeIndex[nodes.Get (i)->GetId ()] = i;
+    }
+
+  CacheStrings strings;
+  std::vector<CacheLink> links;
+  std::vector<CacheAttribute> attributes;
+  links.reserve (m_linksList.size ());
+  for (ConstLinksIterator it = m_linksList.begin (); it != m_linksList.end (); ++it)
+    {
+      std::map<uint32_t, uint32_t>::const_iterator from = nodeIndex.find (it->GetFromNode ()->GetId ());
+      std::map<uint32_t, uint32_t>::const_iterator to = nodeIndex.find (it->GetToNode ()->GetId ());
+      if (from == nodeIndex.end () || to == nodeIndex.end ())
+        {
+          NS_LOG_WARN ("Link between nodes not in the container, not writing " << cacheFile);
+          return false;
+        }
+      CacheLink link;
+      link.from = from->second;
+      link.to = to->second;
+      link.fromName = strings.Intern (it->GetFromNodeName ());
+      link.toName = strings.Intern (it->GetToNodeName ());
+      link.firstAttribute = attributes.size ();
+      for (Link::ConstAttributesIterator attr = it->AttributesBegin (); attr != it->AttributesEnd (); ++attr)
+        {
+          CacheAttribute a;
+          a.name = strings.Intern (attr->first);
+          a.value = strings.Intern (attr->second);
+          attributes.push_back (a);
+        }
+      link.nAttributes = attributes.size () - link.firstAttribute;
+      links.push_back (link);
+    }
+  std::vector<CacheAttribute> latencyPairs;
+  latencyPairs.reserve (latencies.size ());
+  for (std::map<std::string, std::string>::const_iterator it = latencies.begin (); it != latencies.end (); ++it)
+    {
+      CacheAttribute a;
+      a.name = strings.Intern (it->first);
+      a.value = strings.Intern (it->second);
+      latencyPairs.push_back (a);
+    }
+
+  header.nNodes = nodes.GetN ();
+  header.nLinks = links.size ();
+  header.nAttributes = attributes.size ();
+  header.nLatencies = latencyPairs.size ();
+  header.nStrings = strings.GetOffsets ().size () - 1;
+  header.stringBytes = strings.GetBlob ().size ();
+
+  std::ostringstream tmpName;
+  tmpName << cacheFile << ".tmp." << getpid ();
+  FILE *file = std::fopen (tmpName.str ().c_str (), "wb");
+  if (file == 0)
+    {
+      NS_LOG_WARN ("Couldn't create the file " << tmpName.str ());
+      return false;
+    }
+  bool ok = std::fwrite (&header, sizeof (header), 1, file) == 1;
+  ok = ok && (links.empty () || std::fwrite (&links[0], sizeof (CacheLink), links.size (), file) == links.size ());
+  ok = ok && (attributes.empty () || std::fwrite (&attributes[0], sizeof (CacheAttribute), attributes.size (), file) == attributes.size ());
+  ok = ok && (latencyPairs.empty () || std::fwrite (&latencyPairs[0], sizeof (CacheAttribute), latencyPairs.size (), file) == latencyPairs.size ());
+  ok = ok && std::fwrite (&strings.GetOffsets ()[0], sizeof (uint32_t), strings.GetOffsets ().size (), file) == strings.GetOffsets ().size ();
+  ok = ok && std::fwrite (&strings.GetBlob ()[0], 1, strings.GetBlob ().size (), file) == strings.GetBlob ().size ();
+  ok = (std::fclose (file) == 0) && ok;
+  if (!ok || std::rename (tmpName.str ().c_str (), cacheFile.c_str ()) != 0)
+    {
+      NS_LOG_WARN ("Couldn't write the file " << cacheFile);
+      std::remove (tmpName.str ().c_str ());
+      return false;
+    }
+  NS_LOG_INFO ("Topology cache " << cacheFile << " written with " << header.nNodes
+                                 << " nodes, " << header.nLinks << " links and "
+                                 << header.nLatencies << " latencies");
+  return true;
+}
+
+NodeContainer
+TopologyReader::ReadCache (const std::string &cacheFile, std::map<std::string, std::string> *latencies,
+                           const std::string &latencyFile)
+{
+  NS_LOG_FUNCTION (this << cacheFile << latencyFile);
+  NodeContainer nodes;
+
+  int fd = ::open (cacheFile.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_INFO ("No topology cache " << cacheFile);
+      return nodes;
+    }
+  struct stat st;
+  if (::fstat (fd, &st) != 0 || (size_t)st.st_size < sizeof (CacheHeader))
+    {
+      ::close (fd);
+      return nodes;
+    }
+  size_t size = st.st_size;
+  void *map = ::mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close (fd);
+  if (map == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Couldn't map the file " << cacheFile);
+      return nodes;
+    }
+
+  const char *base = (const char *)map;
+  const CacheHeader *header = (const CacheHeader *)base;
+  uint64_t sourceSize = 0;
+  int64_t sourceMtime = 0;
+  GetSourceStat (m_fileName, sourceSize, sourceMtime);
+  uint64_t latencySourceSize = 0;
+  int64_t latencySourceMtime = 0;
+  if (!latencyFile.empty ())
+    {
+      GetSourceStat (latencyFile, latencySourceSize, latencySourceMtime);
+    }
+  size_t expected = sizeof (CacheHeader)
+    + (size_t)header->nLinks * sizeof (CacheLink)
+    + (size_t)header->nAttributes * sizeof (CacheAttribute)
+    + (size_t)header->nLatencies * sizeof (CacheAttribute)
+    + ((size_t)header->nStrings + 1) * sizeof (uint32_t)
+    + header->stringBytes;
+  if (std::memcmp (header->magic, g_cacheMagic, sizeof (header->magic)) != 0
+      || header->version != g_cacheVersion
+      || header->byteOrder != g_cacheByteOrder
+      || header->sourceSize != sourceSize
+      || header->sourceMtime != sourceMtime
+      || header->latencySourceSize != latencySourceSize
+      || header->latencySourceMtime != latencySourceMtime
+      || expected != size)
+    {
+      NS_LOG_INFO ("Topology cache " << cacheFile << " is not valid for " << m_fileName);
+      ::munmap (map, size);
+      return nodes;
+    }
+
+  const CacheLink *links = (const CacheLink *)(base + sizeof (CacheHeader));
+  const CacheAttribute *attributes = (const CacheAttribute *)(links + header->nLinks);
+  const CacheAttribute *latencyPairs = attributes + header->nAttributes;
+  const uint32_t *offsets = (const uint32_t *)(latencyPairs + header->nLatencies);
+  const char *blob = (const char *)(offsets + header->nStrings + 1);
+
+  // check every index before creating anything
+  bool valid = offsets[header->nStrings] == header->stringBytes;
+  for (uint32_t i = 0; valid && i < header->nStrings; i++)
+    {
+      valid = offsets[i] < offsets[i + 1] && blob[offsets[i + 1] - 1] == '\0';
+    }
+  for (uint32_t i = 0; valid && i < header->nLinks; i++)
+    {
+      valid = links[i].from < header->nNodes && links[i].to < header->nNodes
+        && links[i].fromName < header->nStrings && links[i].toName < header->nStrings
+        && links[i].firstAttribute <= header->nAttributes
+        && links[i].nAttributes <= header->nAttributes - links[i].firstAttribute;
+    }
+  for (uint32_t i = 0; valid && i < header->nAttributes; i++)
+    {
+      valid = attributes[i].name < header->nStrings && attributes[i].value < header->nStrings;
+    }
+  for (uint32_t i = 0; valid && i < header->nLatencies; i++)
+    {
+      valid = latencyPairs[i].name < header->nStrings && latencyPairs[i].value < header->nStrings;
+    }
+  if (!valid)
+    {
+      NS_LOG_WARN ("Topology cache " << cacheFile << " is corrupted");
+      ::munmap (map, size);
+      return nodes;
+    }
+
+  nodes.Create (header->nNodes);
+  for (uint32_t i = 0; i < header->nLinks; i++)
+    {
+      Link link (nodes.Get (links[i].from), blob + offsets[links[i].fromName],
+                 nodes.Get (links[i].to), blob + offsets[links[i].toName]);
+      const CacheAttribute *attr = attributes + links[i].firstAttribute;
+      for (uint32_t j = 0; j < links[i].nAttributes; j++, attr++)
+        {
+          link.SetAttribute (blob + offsets[attr->name], blob + offsets[attr->value]);
+        }
+      AddLink (link);
+    }
+  if (latencies != 0)
+    {
+      latencies->clear ();
+      for (uint32_t i = 0; i < header->nLatencies; i++)
+        {
+          latencies->insert (latencies->end (), std::make_pair (std::string (blob + offsets[latencyPairs[i].name]),
+                                                                std::string (blob + offsets[latencyPairs[i].value])));
+        }
+    }
+  ::munmap (map, size);
+
+  NS_LOG_INFO ("Topology read from cache " << cacheFile << " with " << nodes.GetN ()
+                                           << " nodes, " << header->nLinks << " links and "
+                                           << header->nLatencies << " latencies");
+  return nodes;
+}
+
 
 TopologyReader::Link::Link ( Ptr<Node> fromPtr, const std::string &fromName, Ptr<Node> toPtr, const std::string &toName )
 {
@@ -25,6 +25,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 
 #include "ns3/object.h"
 #include "ns3/node-container.h"
@@ -196,6 +197,73 @@ private:
    */
   void AddLink (Link link);
 
+  /**
+   * \brief Saves the given nodes and the links read so far to a binary cache file.
+   *
+   * The cache holds the node names, the links as pairs of node indices and
+   * the link attributes (e.g. locations and latencies) as indices into a
+   * table of strings, all in flat arrays, together with the size and the
+   * modification time of the input file.  The latencies between locations
+   * read from a separate file (see RocketfuelTopologyReader::ReadLatencies)
+   * can be saved along, tied in the same way to that file.  The cache is
+   * first written to a temporary file which is then renamed, so that
+   * concurrent readers never see a partial cache.
+   *
+   * \param cacheFile the name of the cache file.
+   * \param nodes the nodes returned by Read (), in the order they were created.
+   * \param latencies the latencies read from latencyFile, if any.
+   * \param latencyFile the name of the file the latencies were read from, or
+   *        an empty string if there is none.
+   *
+   * \return true if the cache was written, false otherwise.
+   */
+  bool WriteCache (const std::string &cacheFile, NodeContainer nodes,
+                   const std::map<std::string, std::string> &latencies = std::map<std::string, std::string> (),
+                   const std::string &latencyFile = "") const;
+
+  /**
+   * \brief Recreates the nodes and the links saved by WriteCache.
+   *
+   * The nodes are created in the same order as Read () creates them, so
+   * that they get the same ids.  The cache is only used if it has the
+   * current format version and was written for an input file of the same
+   * size and modification time as the one set with SetFileName, and for
+   * the same latency file (or none).
+   *
+   * \param cacheFile the name of the cache file.
+   * \param latencies (returned) the latencies saved with the cache, if not null.
+   * \param latencyFile the name of the latency file the cache must have been
+   *        written for, or an empty string if there is none.
+   *
+   * \return the container of the nodes created (or empty container if
+   * the cache is missing or cannot be used).
+   */
+  NodeContainer ReadCache (const std::string &cacheFile, std::map<std::string, std::string> *latencies = 0,
+                           const std::string &latencyFile = "");
+
+  /**
+   * \brief Hash function for the std::string keyed sgi::hash_map
+   * used by the readers to find nodes by name.
+   */
+  struct StringHash
+  {
+    size_t operator () (const std::string &s) const;
+  };
+
+protected:
+  /**
+   * \brief Reads the whole input file in memory and splits it in lines.
+   *
+   * The newline at the end of each line is replaced by a '\0', so that the
+   * lines can be tokenized in place.
+   *
+   * \param buffer where the content of the file is stored.
+   * \param lines where a pointer to the beginning of each line is stored.
+   *
+   * \return false if the file could not be opened, true otherwise.
+   */
+  bool ReadLines (std::vector<char> &buffer, std::vector<char *> &lines) const;
+
 private:
   TopologyReader (const TopologyReader&);
   TopologyReader& operator= (const TopologyReader&);
@@ -72,6 +72,74 @@ RocketfuelTopologyReaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+class RocketfuelTopologyCacheTest : public TestCase
+{
+public:
+  RocketfuelTopologyCacheTest ();
+private:
+  virtual void DoRun (void);
+};
+
+RocketfuelTopologyCacheTest::RocketfuelTopologyCacheTest ()
+  : TestCase ("RocketfuelTopologyCacheTest")
+{
+}
+
+
+void
+RocketfuelTopologyCacheTest::DoRun (void)
+{
+  std::string input ("./src/topology-read/examples/RocketFuel_toposample_1239_weights.txt");
+  std::string cache = CreateTempDirFilename ("rocketfuel-1239-weights.cache");
+
+  Ptr<RocketfuelTopologyReader> inFile = CreateObject<RocketfuelTopologyReader> ();
+  inFile->SetFileName (input);
+  NodeContainer nodes = inFile->Read ();
+  NS_TEST_ASSERT_MSG_EQ (inFile->WriteCache (cache, nodes), true, "Problems writing the topology cache.");
+
+  Ptr<RocketfuelTopologyReader> cachedFile = CreateObject<RocketfuelTopologyReader> ();
+  cachedFile->SetFileName (input);
+  NodeContainer cachedNodes = cachedFile->ReadCache (cache);
+
+  NS_TEST_ASSERT_MSG_EQ (cachedNodes.GetN (), nodes.GetN (), "nodes");
+  NS_TEST_ASSERT_MSG_EQ (cachedFile->LinksSize (), inFile->LinksSize (), "links");
+
+  // the cached nodes are created in the same order, so their ids are shifted by the number of nodes
+  uint32_t shift = cachedNodes.Get (0)->GetId () - nodes.Get (0)->GetId ();
+  TopologyReader::ConstLinksIterator cachedLink = cachedFile->LinksBegin ();
+  for (TopologyReader::ConstLinksIterator link = inFile->LinksBegin (); link != inFile->LinksEnd (); ++link, ++cachedLink)
+    {
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetFromNode ()->GetId (), link->GetFromNode ()->GetId () + shift, "from node");
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetToNode ()->GetId (), link->GetToNode ()->GetId () + shift, "to node");
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetFromNodeName (), link->GetFromNodeName (), "from node name");
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetToNodeName (), link->GetToNodeName (), "to node name");
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetAttribute ("From Location"), link->GetAttribute ("From Location"), "from location");
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetAttribute ("To Location"), link->GetAttribute ("To Location"), "to location");
+      NS_TEST_ASSERT_MSG_EQ (cachedLink->GetAttribute ("Weight"), link->GetAttribute ("Weight"), "weight");
+    }
+
+  // latencies read from a separate file are saved with the cache, which is only used for that file
+  std::map<std::string, std::string> latencies = RocketfuelTopologyReader::ReadLatencies (input);
+  NS_TEST_ASSERT_MSG_NE (latencies.size (), 0, "latencies");
+  NS_TEST_ASSERT_MSG_EQ (inFile->WriteCache (cache, nodes, latencies, input), true, "Problems writing the topology cache.");
+  Ptr<RocketfuelTopologyReader> latencyFile = CreateObject<RocketfuelTopologyReader> ();
+  latencyFile->SetFileName (input);
+  std::map<std::string, std::string> cachedLatencies;
+  NS_TEST_ASSERT_MSG_EQ (latencyFile->ReadCache (cache, &cachedLatencies, input).GetN (), nodes.GetN (), "nodes");
+  NS_TEST_EXPECT_MSG_EQ ((cachedLatencies == latencies), true, "latencies");
+  Ptr<RocketfuelTopologyReader> noLatencyFile = CreateObject<RocketfuelTopologyReader> ();
+  noLatencyFile->SetFileName (input);
+  NS_TEST_EXPECT_MSG_EQ (noLatencyFile->ReadCache (cache).GetN (), 0, "cache with latencies read without them");
+
+  // a cache written for another input file is not used
+  Ptr<RocketfuelTopologyReader> otherFile = CreateObject<RocketfuelTopologyReader> ();
+  otherFile->SetFileName ("./src/topology-read/examples/Orbis_toposample.txt");
+  NS_TEST_EXPECT_MSG_EQ (otherFile->ReadCache (cache).GetN (), 0, "cache of another file");
+  NS_TEST_EXPECT_MSG_EQ (otherFile->LinksSize (), 0, "cache of another file");
+
+  Simulator::Destroy ();
+}
+
 class RocketfuelTopologyReaderTestSuite : public TestSuite
 {
 public:
@@ -83,6 +151,7 @@ RocketfuelTopologyReaderTestSuite::RocketfuelTopologyReaderTestSuite ()
   : TestSuite ("rocketfuel-topology-reader", UNIT)
 {
   AddTestCase (new RocketfuelTopologyReaderTest ());
+  AddTestCase (new RocketfuelTopologyCacheTest ());
 }
 
 static RocketfuelTopologyReaderTestSuite rocketfuelTopologyReaderTestSuite;
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Times the interference tracking of one receiver on a dense channel: many
+// transmitters send frames back to back, so that about as many signals as
+// there are transmitters overlap at any time.  The receiver drives its
+// InterferenceHelper the way YansWifiPhy does: it syncs to the frames
+// strong enough when it is not already receiving, works out their error
+// rate when they end, and asks how long the medium stays busy for all the
+// others.  The checksum of these results tells whether two versions of the
+// InterferenceHelper compute the same thing.
+
+#include "ns3/core-module.h"
+#include "ns3/interference-helper.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/wifi-phy.h"
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+class InterferenceBench
+{
+public:
+  InterferenceBench (uint32_t ntransmitters, uint32_t nframes);
+  void Run (void);
+
+private:
+  void Transmit (uint32_t transmitter);
+  void EndReceive (Ptr<InterferenceHelper::Event> event);
+
+  InterferenceHelper m_interference;
+  Ptr<UniformRandomVariable> m_random;
+  WifiMode m_mode;
+  uint32_t m_ntransmitters;
+  uint32_t m_nframes;
+  uint32_t m_sent;
+  uint32_t m_synced;
+  bool m_rxing;
+  double m_checksum;
+};
+
+InterferenceBench::InterferenceBench (uint32_t ntransmitters, uint32_t nframes)
+  : m_mode (WifiPhy::GetOfdmRate6Mbps ()),
+    m_ntransmitters (ntransmitters),
+    m_nframes (nframes),
+    m_sent (0),
+    m_synced (0),
+    m_rxing (false),
+    m_checksum (0.0)
+{
+  m_interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  m_interference.SetNoiseFigure (std::pow (10.0, 7.0 / 10.0));
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+void
+InterferenceBench::Transmit (uint32_t transmitter)
+{
+  if (m_sent == m_nframes)
+    {
+      return;
+    }
+  m_sent++;
+
+  uint32_t size = m_random->GetInteger (100, 1500);
+  Time duration = WifiPhy::CalculateTxDuration (size, m_mode, WIFI_PREAMBLE_LONG);
+  double rxPowerW = std::pow (10.0, (m_random->GetValue (-100.0, -60.0) - 30.0) / 10.0);
+  Ptr<InterferenceHelper::Event> event = m_interference.Add (size, m_mode, WIFI_PREAMBLE_LONG, duration, rxPowerW);
+
+  // like YansWifiPhy, with its default energy detection and CCA thresholds
+  if (!m_rxing && rxPowerW > std::pow (10.0, (-96.0 - 30.0) / 10.0))
+    {
+      m_rxing = true;
+      m_synced++;
+      m_interference.NotifyRxStart ();
+      Simulator::Schedule (duration, &InterferenceBench::EndReceive, this, event);
+    }
+  else
+    {
+      m_checksum += m_interference.GetEnergyDuration (std::pow (10.0, (-99.0 - 30.0) / 10.0)).GetSeconds ();
+    }
+
+  Simulator::Schedule (duration + MicroSeconds (m_random->GetInteger (0, 50)),
+                       &InterferenceBench::Transmit, this, transmitter);
+}
+
+void
+InterferenceBench::EndReceive (Ptr<InterferenceHelper::Event> event)
+{
+  struct InterferenceHelper::SnrPer snrPer = m_interference.CalculateSnrPer (event);
+  m_interference.NotifyRxEnd ();
+  m_rxing = false;
+  m_checksum += snrPer.per;
+}
+
+void
+InterferenceBench::Run (void)
+{
+  for (uint32_t i = 0; i < m_ntransmitters; i++)
+    {
+      Simulator::Schedule (MicroSeconds (m_random->GetInteger (0, 2000)), &InterferenceBench::Transmit, this, i);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t ms = clock.End ();
+  Simulator::Destroy ();
+
+  std::cout << m_ntransmitters << " transmitters, " << m_sent << " frames, " << m_synced << " received: "
+            << ms << " ms, " << (uint64_t)m_sent * 1000 / std::max (ms, (int64_t)1) << " frames/s, checksum "
+            << std::setprecision (17) << m_checksum << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t ntransmitters = 500;
+  uint32_t nframes = 200000;
+
+  CommandLine cmd;
+  cmd.AddValue ("transmitters", "Number of transmitters sending at the same time", ntransmitters);
+  cmd.AddValue ("frames", "Number of frames to send", nframes);
+  cmd.Parse (argc, argv);
+
+  InterferenceBench bench (ntransmitters, nframes);
+  bench.Run ();
+
+  return 0;
+}
@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include <algorithm>
+#include <limits>
 
 NS_LOG_COMPONENT_DEFINE ("InterferenceHelper");
 
@@ -109,6 +110,294 @@ InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o)
   return (m_time < o.m_time);
 }
 
+/****************************************************************
+ *       Treap of the SNIR change events
+ ****************************************************************/
+
+InterferenceHelper::NiChangeTree::NiChangeTree ()
+  : m_root (-1),
+    m_order (0),
+    m_seed (2463534242U)
+{
+}
+bool
+InterferenceHelper::NiChangeTree::IsBefore (const Node &node, Time time, uint64_t order) const
+{
+  return node.time < time || (node.time == time && node.order < order);
+}
+void
+InterferenceHelper::NiChangeTree::Update (int32_t node)
+{
+  Node &n = m_nodes[node];
+  double partial = 0.0;
+  double minPartial = std::numeric_limits<double>::infinity ();
+  if (n.left != -1)
+    {
+      partial = m_nodes[n.left].sum;
+      minPartial = m_nodes[n.left].minPartial;
+    }
+  partial += n.delta;
+  minPartial = std::min (minPartial, partial);
+  if (n.right != -1)
+    {
+      minPartial = std::min (minPartial, partial + m_nodes[n.right].minPartial);
+      partial += m_nodes[n.right].sum;
+    }
+  n.sum = partial;
+  n.minPartial = minPartial;
+}
+/* splits the subtree into the changes before (time, order) and the others */
+void
+InterferenceHelper::NiChangeTree::Split (int32_t node, Time time, uint64_t order, int32_t *left, int32_t *right)
+{
+  if (node == -1)
+    {
+      *left = -1;
+      *right = -1;
+    }
+  else if (IsBefore (m_nodes[node], time, order))
+    {
+      Split (m_nodes[node].right, time, order, &m_nodes[node].right, right);
+      *left = node;
+      Update (node);
+    }
+  else
+    {
+      Split (m_nodes[node].left, time, order, left, &m_nodes[node].left);
+      *right = node;
+      Update (node);
+    }
+}
+/* all the changes of left are before those of right */
+int32_t
+InterferenceHelper::NiChangeTree::Merge (int32_t left, int32_t right)
+{
+  if (left == -1)
+    {
+      return right;
+    }
+  if (right == -1)
+    {
+      return left;
+    }
+  if (m_nodes[left].priority > m_nodes[right].priority)
+    {
+      m_nodes[left].right = Merge (m_nodes[left].right, right);
+      Update (left);
+      return left;
+    }
+  else
+    {
+      m_nodes[right].left = Merge (left, m_nodes[right].left);
+      Update (right);
+      return right;
+    }
+}
+uint64_t
+InterferenceHelper::NiChangeTree::Add (NiChange change)
+{
+  int32_t node;
+  if (m_free.empty ())
+    {
+      node = m_nodes.size ();
+      m_nodes.push_back (Node ());
+    }
+  else
+    {
+      node = m_free.back ();
+      m_free.pop_back ();
+    }
+  // xorshift, so that the simulation's random variables are left alone
+  m_seed ^= m_seed << 13;
+  m_seed ^= m_seed >> 17;
+  m_seed ^= m_seed << 5;
+
+  Node &n = m_nodes[node];
+  n.time = change.GetTime ();
+  n.order = m_order++;
+  n.delta = change.GetDelta ();
+  n.priority = m_seed;
+  n.left = -1;
+  n.right = -1;
+  Update (node);
+
+  // after the changes at the same time
+  int32_t left, right;
+  uint64_t order = n.order;
+  Split (m_root, n.time, order, &left, &right);
+  m_root = Merge (Merge (left, node), right);
+  return order;
+}
+double
+InterferenceHelper::NiChangeTree::EraseUpTo (Time time, uint64_t order, double power)
+{
+  int32_t left, right;
+  Split (m_root, time, order, &left, &right);
+  m_root = right;
+
+  // summed in order, as CalculateNoiseInterferenceW starts from the sum
+  return Free (left, power);
+}
+/* finds the first change of the subtree after which power is below
+ * energyW, or adds all of their deltas to power if there is none */
+int32_t
+InterferenceHelper::NiChangeTree::FindBelow (int32_t node, double &power, double energyW) const
+{
+  if (node == -1)
+    {
+      return -1;
+    }
+  if (power + m_nodes[node].minPartial >= energyW)
+    {
+      power += m_nodes[node].sum;
+      return -1;
+    }
+  while (true)
+    {
+      const Node &n = m_nodes[node];
+      if (n.left != -1)
+        {
+          if (power + m_nodes[n.left].minPartial < energyW)
+            {
+              node = n.left;
+              continue;
+            }
+          power += m_nodes[n.left].sum;
+        }
+      power += n.delta;
+      if (power < energyW)
+        {
+          return node;
+        }
+      node = n.right;
+    }
+}
+/* same as FindBelow, for the changes of the subtree from now on; the
+ * deltas of the changes before are added to power */
+int32_t
+InterferenceHelper::NiChangeTree::FindBelowFrom (int32_t node, Time now, double &power, double energyW) const
+{
+  while (node != -1)
+    {
+      const Node &n = m_nodes[node];
+      if (IsBefore (n, now, 0))
+        {
+          // and so is the left subtree
+          if (n.left != -1)
+            {
+              power += m_nodes[n.left].sum;
+            }
+          power += n.delta;
+          node = n.right;
+        }
+      else
+        {
+          int32_t below = FindBelowFrom (n.left, now, power, energyW);
+          if (below != -1)
+            {
+              return below;
+            }
+          power += n.delta;
+          if (power < energyW)
+            {
+              return node;
+            }
+          return FindBelow (n.right, power, energyW);
+        }
+    }
+  return -1;
+}
+Time
+InterferenceHelper::NiChangeTree::GetEnergyEnd (Time now, double power, double energyW) const
+{
+  int32_t below = FindBelowFrom (m_root, now, power, energyW);
+  if (below != -1)
+    {
+      return m_nodes[below].time;
+    }
+  int32_t last = m_root;
+  while (last != -1 && m_nodes[last].right != -1)
+    {
+      last = m_nodes[last].right;
+    }
+  if (last != -1 && !IsBefore (m_nodes[last], now, 0))
+    {
+      return m_nodes[last].time;
+    }
+  return now;
+}
+/* appends the changes of the subtree strictly between the two changes */
+void
+InterferenceHelper::NiChangeTree::Collect (int32_t node, Time fromTime, uint64_t fromOrder,
+                                           Time toTime, uint64_t toOrder, NiChanges *changes) const
+{
+  if (node == -1)
+    {
+      return;
+    }
+  const Node &n = m_nodes[node];
+  bool afterFrom = n.time > fromTime || (n.time == fromTime && n.order > fromOrder);
+  bool beforeTo = IsBefore (n, toTime, toOrder);
+  if (afterFrom)
+    {
+      Collect (n.left, fromTime, fromOrder, toTime, toOrder, changes);
+    }
+  if (afterFrom && beforeTo)
+    {
+      changes->push_back (NiChange (n.time, n.delta));
+    }
+  if (beforeTo)
+    {
+      Collect (n.right, fromTime, fromOrder, toTime, toOrder, changes);
+    }
+}
+double
+InterferenceHelper::NiChangeTree::GetChanges (Time fromTime, uint64_t fromOrder, Time toTime, uint64_t toOrder,
+                                              NiChanges *changes) const
+{
+  double power = 0.0;
+  int32_t node = m_root;
+  while (node != -1)
+    {
+      const Node &n = m_nodes[node];
+      if (IsBefore (n, fromTime, fromOrder))
+        {
+          if (n.left != -1)
+            {
+              power += m_nodes[n.left].sum;
+            }
+          power += n.delta;
+          node = n.right;
+        }
+      else
+        {
+          node = n.left;
+        }
+    }
+  Collect (m_root, fromTime, fromOrder, toTime, toOrder, changes);
+  return power;
+}
+/* frees the nodes of the subtree, and returns power plus their deltas in order */
+double
+InterferenceHelper::NiChangeTree::Free (int32_t node, double power)
+{
+  if (node != -1)
+    {
+      power = Free (m_nodes[node].left, power);
+      power += m_nodes[node].delta;
+      power = Free (m_nodes[node].right, power);
+      m_free.push_back (node);
+    }
+  return power;
+}
+void
+InterferenceHelper::NiChangeTree::Clear (void)
+{
+  m_nodes.clear ();
+  m_free.clear ();
+  m_root = -1;
+}
+
 /****************************************************************
  *       The actual InterferenceHelper
  ****************************************************************/
@@ -116,7 +405,9 @@ InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o)
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_firstPower (0.0),
-    m_rxing (false)
+    m_rxing (false),
+    m_lastStartOrder (0),
+    m_rxStartOrder (0)
 {
 }
 InterferenceHelper::~InterferenceHelper ()
@@ -170,45 +461,31 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
-  Time end = now;
-  noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
-    {
-      noiseInterferenceW += i->GetDelta ();
-      end = i->GetTime ();
-      if (end < now)
-        {
-          continue;
-        }
-      if (noiseInterferenceW < energyW)
-        {
-          break;
-        }
-    }
+  Time end = m_niChanges.GetEnergyEnd (now, m_firstPower, energyW);
   return end > now ? end - now : MicroSeconds (0);
 }
 
+/* drops the changes which can no longer be asked for: those before the
+ * start of the packet being received, or if there is none, those up to now */
 void
-InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
+InterferenceHelper::Prune (void)
 {
-  Time now = Simulator::Now ();
-  if (!m_rxing)
+  if (m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      m_firstPower = m_niChanges.EraseUpTo (m_rxStartTime, m_rxStartOrder, m_firstPower);
     }
   else
     {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      m_firstPower = m_niChanges.EraseUpTo (Simulator::Now (), std::numeric_limits<uint64_t>::max (), m_firstPower);
     }
-  AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
+}
 
+void
+InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
+{
+  Prune ();
+  m_lastStartOrder = m_niChanges.Add (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+  m_niChanges.Add (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
 }
 
 
@@ -229,17 +506,14 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, WifiM
 double
 InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
 {
-  double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
-    {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
-        {
-          break;
-        }
-      ni->push_back (*i);
-    }
-  ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
+  NS_ASSERT (event->GetStartTime () == m_rxStartTime);
+  ni->push_back (NiChange (event->GetStartTime (), 0));
+  // the end of the event was added right after its start
+  double noiseInterference = m_firstPower + m_niChanges.GetChanges (m_rxStartTime, m_rxStartOrder,
+                                                                    event->GetEndTime (), m_rxStartOrder + 1,
+                                                                    ni);
+  (*ni)[0] = NiChange (event->GetStartTime (), noiseInterference);
   ni->push_back (NiChange (event->GetEndTime (), 0));
   return noiseInterference;
 }
@@ -368,29 +642,23 @@ InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
 void
 InterferenceHelper::EraseEvents (void)
 {
-  m_niChanges.clear ();
+  m_niChanges.Clear ();
   m_rxing = false;
   m_firstPower = 0.0;
 }
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPosition (Time moment)
-{
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
-
-}
-void
-InterferenceHelper::AddNiChangeEvent (NiChange change)
-{
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
-}
 void
 InterferenceHelper::NotifyRxStart ()
 {
+  // the packet being received is the last one added
   m_rxing = true;
+  m_rxStartTime = Simulator::Now ();
+  m_rxStartOrder = m_lastStartOrder;
 }
 void
 InterferenceHelper::NotifyRxEnd ()
 {
   m_rxing = false;
+  // keep the changes at the current time, which GetEnergyDuration looks at
+  m_firstPower = m_niChanges.EraseUpTo (Simulator::Now (), 0, m_firstPower);
 }
 } // namespace ns3
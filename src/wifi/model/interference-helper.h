@@ -97,6 +97,8 @@ private:
   void NotifyRxEnd ();
   void EraseEvents (void);
 private:
+  friend class InterferenceHelperTest;
+
   class NiChange
   {
 public:
@@ -111,6 +113,68 @@ private:
   typedef std::vector <NiChange> NiChanges;
   typedef std::list<Ptr<Event> > Events;
 
+  /**
+   * The changes of the noise and interference power, ordered by time and
+   * then by the order they were added in.  They are kept in a treap whose
+   * nodes also hold the sum of the changes below them and the lowest
+   * partial sum of these changes, so that adding a change and finding when
+   * the power falls below a level both take O(log n).
+   */
+  class NiChangeTree
+  {
+public:
+    NiChangeTree ();
+    /// Adds the change after those at the same time, and returns its order
+    uint64_t Add (NiChange change);
+    /**
+     * Removes the changes before the one at time with the given order, and
+     * returns power plus their deltas.
+     */
+    double EraseUpTo (Time time, uint64_t order, double power);
+    /**
+     * Returns the time of the first change from now on after which the
+     * power, starting at power before the first change, is below energyW,
+     * or the time of the last change if there is none, or now if there is
+     * no change from now on.
+     */
+    Time GetEnergyEnd (Time now, double power, double energyW) const;
+    /**
+     * Appends in order the changes strictly between the change at fromTime
+     * with order fromOrder and the one at toTime with order toOrder, and
+     * returns the sum of the deltas of the changes before the first one.
+     */
+    double GetChanges (Time fromTime, uint64_t fromOrder, Time toTime, uint64_t toOrder,
+                       NiChanges *changes) const;
+    void Clear (void);
+private:
+    struct Node
+    {
+      Time time;
+      uint64_t order;
+      double delta;
+      uint32_t priority;
+      int32_t left;
+      int32_t right;
+      double sum;        // of the deltas in the subtree
+      double minPartial; // lowest sum of the deltas from the first one of the subtree
+    };
+    bool IsBefore (const Node &node, Time time, uint64_t order) const;
+    void Update (int32_t node);
+    void Split (int32_t node, Time time, uint64_t order, int32_t *left, int32_t *right);
+    int32_t Merge (int32_t left, int32_t right);
+    int32_t FindBelow (int32_t node, double &power, double energyW) const;
+    int32_t FindBelowFrom (int32_t node, Time now, double &power, double energyW) const;
+    void Collect (int32_t node, Time fromTime, uint64_t fromOrder, Time toTime, uint64_t toOrder,
+                  NiChanges *changes) const;
+    double Free (int32_t node, double power);
+
+    std::vector<Node> m_nodes;
+    std::vector<int32_t> m_free;
+    int32_t m_root;
+    uint64_t m_order;
+    uint32_t m_seed;
+  };
+
   InterferenceHelper (const InterferenceHelper &o);
   InterferenceHelper &operator = (const InterferenceHelper &o);
   void AppendEvent (Ptr<Event> event);
@@ -118,16 +182,22 @@ private:
   double CalculateSnr (double signal, double noiseInterference, WifiMode mode) const;
   double CalculateChunkSuccessRate (double snir, Time delay, WifiMode mode) const;
   double CalculatePer (Ptr<const Event> event, NiChanges *ni) const;
+  void Prune (void);
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
-  /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
+  /**
+   * The changes since the start of the packet being received, or since the
+   * last packet arrived if none is being received: the changes before only
+   * matter through their sum, m_firstPower, and are pruned as new packets
+   * arrive and when the reception ends.
+   */
+  NiChangeTree m_niChanges;
   double m_firstPower;
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
-  void AddNiChangeEvent (NiChange change);
+  uint64_t m_lastStartOrder; /**< order of the start of the last packet */
+  Time m_rxStartTime;        /**< start of the packet being received */
+  uint64_t m_rxStartOrder;   /**< order of the start of the packet being received */
 };
 
 } // namespace ns3
@@ -24,11 +24,14 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include <algorithm>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
@@ -50,11 +53,25 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The distance (m) beyond which packets are not delivered, or 0 to deliver them at any distance.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinRxPower",
+                   "The reception power (dBm) below which packets are not delivered.",
+                   DoubleValue (-1e9),
+                   MakeDoubleAccessor (&YansWifiChannel::m_minRxPowerDbm),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0.0),
+    m_minRxPowerDbm (-1e9),
+    m_gridCellSize (0.0),
+    m_gridMaxSpeed (0.0)
 {
 }
 YansWifiChannel::~YansWifiChannel ()
@@ -63,6 +80,21 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  for (MobilityPhys::iterator i = m_mobilityPhys.begin (); i != m_mobilityPhys.end (); i++)
+    {
+      m_gridMobility[i->second.front ()]->TraceDisconnectWithoutContext (
+        "CourseChange", MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
+  m_mobilityPhys.clear ();
+  m_gridMobility.clear ();
+  m_gridCells.clear ();
+  m_grid.clear ();
+  WifiChannel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -80,24 +112,39 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  std::vector<uint32_t> receivers;
+  uint32_t nreceivers = m_phyList.size ();
+  if (m_maxRange > 0.0)
+    {
+      GetReceiversInRange (senderMobility->GetPosition (), receivers);
+      nreceivers = receivers.size ();
+    }
+  for (uint32_t k = 0; k < nreceivers; k++)
     {
-      if (sender != (*i))
+      uint32_t j = m_maxRange > 0.0 ? receivers[k] : k;
+      Ptr<YansWifiPhy> phy = m_phyList[j];
+      if (sender != phy)
         {
           // For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (phy->GetChannelNumber () != sender->GetChannelNumber ())
             {
               continue;
             }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = phy->GetMobility ()->GetObject<MobilityModel> ();
+          if (m_maxRange > 0.0 && senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+            {
+              continue;
+            }
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
+          if (rxPowerDbm < m_minRxPowerDbm)
+            {
+              continue;
+            }
+          Ptr<Object> dstNetDevice = phy->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
             {
@@ -109,18 +156,29 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
             }
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive, this,
-                                          j, copy, rxPowerDbm, wifiMode, preamble);
+                                          j, packet, rxPowerDbm, wifiMode, preamble);
         }
     }
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+YansWifiChannel::Receive (uint32_t i, Ptr<const Packet> packet, double rxPowerDbm,
                           WifiMode txMode, WifiPreamble preamble) const
 {
   m_phyList[i]->StartReceivePacket (packet, rxPowerDbm, txMode, preamble);
 }
 
+uint64_t
+YansWifiChannel::GetNCopiesAvoided (void) const
+{
+  uint64_t ncopies = 0;
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      ncopies += (*i)->GetNCopiesAvoided ();
+    }
+  return ncopies;
+}
+
 uint32_t
 YansWifiChannel::GetNDevices (void) const
 {
@@ -138,6 +196,116 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
   m_phyList.push_back (phy);
 }
 
+YansWifiChannel::Cell
+YansWifiChannel::GetCell (const Vector &position) const
+{
+  return Cell ((int32_t) std::floor (position.x / m_gridCellSize),
+               (int32_t) std::floor (position.y / m_gridCellSize));
+}
+
+/* moves the PHY i to the cell of its current position, and accounts for
+ * its current speed */
+void
+YansWifiChannel::MoveInGrid (uint32_t i) const
+{
+  Cell cell = GetCell (m_gridMobility[i]->GetPosition ());
+  if (i == m_gridCells.size ())
+    {
+      m_gridCells.push_back (cell);
+      m_grid[cell].push_back (i);
+    }
+  else if (cell != m_gridCells[i])
+    {
+      Grid::iterator old = m_grid.find (m_gridCells[i]);
+      old->second.erase (std::find (old->second.begin (), old->second.end (), i));
+      if (old->second.empty ())
+        {
+          m_grid.erase (old);
+        }
+      m_gridCells[i] = cell;
+      m_grid[cell].push_back (i);
+    }
+  Vector velocity = m_gridMobility[i]->GetVelocity ();
+  double speed = std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y);
+  m_gridMaxSpeed = std::max (m_gridMaxSpeed, speed);
+}
+
+/* adds the PHYs added since the last call to the grid, and moves all the
+ * PHYs to their current cells when they may have gone too far from them to
+ * be found by GetReceiversInRange in the cells next to the sender's */
+void
+YansWifiChannel::UpdateGrid (void) const
+{
+  Time now = Simulator::Now ();
+  if (m_gridCellSize != m_maxRange
+      || m_gridMaxSpeed * (now - m_gridTime).GetSeconds () > m_gridCellSize / 2)
+    {
+      m_grid.clear ();
+      m_gridCells.clear ();
+      m_gridCellSize = m_maxRange;
+      m_gridMaxSpeed = 0.0;
+      m_gridTime = now;
+      for (uint32_t i = 0; i < m_gridMobility.size (); i++)
+        {
+          MoveInGrid (i);
+        }
+    }
+
+  while (m_gridMobility.size () < m_phyList.size ())
+    {
+      uint32_t i = m_gridMobility.size ();
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      m_gridMobility.push_back (mobility);
+      std::vector<uint32_t> &phys = m_mobilityPhys[PeekPointer (mobility)];
+      if (phys.empty ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange",
+                                                MakeCallback (&YansWifiChannel::CourseChanged, this));
+        }
+      phys.push_back (i);
+      MoveInGrid (i);
+    }
+}
+
+/* the PHYs in the cells that may hold the PHYs within MaxRange of the
+ * position, in the order they were added to the channel */
+void
+YansWifiChannel::GetReceiversInRange (const Vector &position, std::vector<uint32_t> &receivers) const
+{
+  UpdateGrid ();
+  double range = m_maxRange + m_gridMaxSpeed * (Simulator::Now () - m_gridTime).GetSeconds ();
+  int32_t span = (int32_t) std::ceil (range / m_gridCellSize);
+  Cell center = GetCell (position);
+  for (int32_t x = center.first - span; x <= center.first + span; x++)
+    {
+      for (int32_t y = center.second - span; y <= center.second + span; y++)
+        {
+          Grid::const_iterator cell = m_grid.find (Cell (x, y));
+          if (cell != m_grid.end ())
+            {
+              receivers.insert (receivers.end (), cell->second.begin (), cell->second.end ());
+            }
+        }
+    }
+  // same order of reception events as without MaxRange
+  std::sort (receivers.begin (), receivers.end ());
+}
+
+void
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+  MobilityPhys::const_iterator phys = m_mobilityPhys.find (PeekPointer (mobility));
+  if (phys == m_mobilityPhys.end () || m_gridCellSize != m_maxRange)
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator i = phys->second.begin (); i != phys->second.end (); i++)
+    {
+      MoveInGrid (*i);
+    }
+}
+
 int64_t
 YansWifiChannel::AssignStreams (int64_t stream)
 {
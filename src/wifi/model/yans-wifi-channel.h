@@ -21,8 +21,11 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
 #include "wifi-channel.h"
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
@@ -33,6 +36,7 @@ class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
+class MobilityModel;
 
 /**
  * \brief A Yans wifi channel
@@ -45,6 +49,18 @@ class YansWifiPhy;
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * By default, every packet sent is delivered to every other PHY on the
+ * channel, however weak it arrives.  In large networks, the MaxRange
+ * attribute limits the delivery to the PHYs within that distance of the
+ * sender, which the channel finds from a grid of their positions rather
+ * than by visiting every PHY; the MinRxPower attribute drops the packets
+ * that would arrive weaker than a floor.  The grid is kept up to date from
+ * the CourseChange notifications of the mobility models, which must thus
+ * move the PHYs at a constant velocity between two notifications, as all
+ * the models of the mobility module do.  The receivers left out neither
+ * receive the packet nor draw the random variables of the propagation
+ * models for it.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -80,10 +96,20 @@ public:
    * currently invoked only from WifiPhy::Send. YansWifiChannel
    * delivers packets only between PHYs with the same m_channelNumber,
    * e.g. PHYs that are operating on the same channel.
+   *
+   * All the receivers share the packet, which must thus not be changed
+   * after it is sent; they copy it only when they pass it up.
    */
   void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
              WifiMode wifiMode, WifiPreamble preamble) const;
 
+  /**
+   * \returns the number of packet copies that the PHYs on this channel
+   * avoided by sharing the packets sent rather than getting their own
+   * copies of them, see YansWifiPhy::GetNCopiesAvoided
+   */
+  uint64_t GetNCopiesAvoided (void) const;
+
  /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -99,13 +125,36 @@ private:
   YansWifiChannel (const YansWifiChannel &);
 
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
-  void Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+  typedef std::pair<int32_t, int32_t> Cell;
+  typedef std::map<Cell, std::vector<uint32_t> > Grid;
+  typedef std::map<const MobilityModel *, std::vector<uint32_t> > MobilityPhys;
+
+  virtual void DoDispose (void);
+  void Receive (uint32_t i, Ptr<const Packet> packet, double rxPowerDbm,
                 WifiMode txMode, WifiPreamble preamble) const;
 
+  Cell GetCell (const Vector &position) const;
+  void MoveInGrid (uint32_t i) const;
+  void UpdateGrid (void) const;
+  void GetReceiversInRange (const Vector &position, std::vector<uint32_t> &receivers) const;
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
 
   PhyList m_phyList;
   Ptr<PropagationLossModel> m_loss;
   Ptr<PropagationDelayModel> m_delay;
+  double m_maxRange;
+  double m_minRxPowerDbm;
+
+  // the grid of the PHYs, with cells MaxRange wide, filled in by the first
+  // Send after each Add
+  mutable Grid m_grid;
+  mutable double m_gridCellSize;
+  mutable std::vector<Ptr<MobilityModel> > m_gridMobility; // of the PHYs in the grid
+  mutable std::vector<Cell> m_gridCells;                   // of the PHYs in the grid
+  mutable MobilityPhys m_mobilityPhys;                     // the PHYs of each mobility model
+  // PHYs are at most m_gridMaxSpeed * (now - m_gridTime) away from their cell
+  mutable double m_gridMaxSpeed;
+  mutable Time m_gridTime;
 };
 
 } // namespace ns3
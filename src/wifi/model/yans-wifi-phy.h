@@ -89,10 +89,25 @@ public:
   /// Return current center channel frequency in MHz, see SetChannelNumber()
   double GetChannelFrequencyMhz () const;
 
-  void StartReceivePacket (Ptr<Packet> packet,
+  /**
+   * \param packet the packet arriving, which may be shared with the other
+   * PHYs of the channel
+   * \param rxPowerDbm the reception power, before the rx gain
+   * \param mode the tx mode of the packet
+   * \param preamble the preamble of the packet
+   *
+   * The packet is only copied if it is received successfully and passed up
+   * to the MAC.
+   */
+  void StartReceivePacket (Ptr<const Packet> packet,
                            double rxPowerDbm,
                            WifiMode mode,
                            WifiPreamble preamble);
+  /**
+   * \returns the number of packets arriving from the channel that this PHY
+   * did not have to copy, because it did not pass them up to the MAC
+   */
+  uint64_t GetNCopiesAvoided (void) const;
 
   void SetRxNoiseFigure (double noiseFigureDb);
   void SetTxPowerStart (double start);
@@ -166,7 +181,7 @@ private:
   double WToDbm (double w) const;
   double RatioToDb (double ratio) const;
   double GetPowerDbm (uint8_t power) const;
-  void EndReceive (Ptr<Packet> packet, Ptr<InterferenceHelper::Event> event);
+  void EndReceive (Ptr<const Packet> packet, Ptr<InterferenceHelper::Event> event);
 
 private:
   double   m_edThresholdW;
@@ -228,6 +243,8 @@ private:
   Ptr<WifiPhyStateHelper> m_state;
   InterferenceHelper m_interference;
   Time m_channelSwitchDelay;
+  /// Packets from the channel not copied, see GetNCopiesAvoided
+  uint64_t m_nCopiesAvoided;
 
 };
 
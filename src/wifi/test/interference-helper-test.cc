@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable.h"
+#include "ns3/interference-helper.h"
+#include "ns3/wifi-phy.h"
+
+namespace ns3 {
+
+/**
+ * Drives an InterferenceHelper through random sequences of packets
+ * arriving, receptions starting and ending, and events being erased,
+ * many of them at the same time, and checks it against a plain sorted
+ * vector of the changes, pruned at the same points.  Powers are whole
+ * numbers so that both sum them exactly.
+ */
+class InterferenceHelperTest : public TestCase
+{
+public:
+  InterferenceHelperTest ();
+  virtual void DoRun (void);
+private:
+  struct Change
+  {
+    Time time;
+    double delta;
+    uint32_t id;
+  };
+  void Step (void);
+  void AddEvent (Time duration, double power);
+  void Check (void);
+  uint32_t FindChange (uint32_t id) const;
+  /// Removes the changes before the end-th one and adds them to m_firstPower
+  void Prune (uint32_t end);
+
+  InterferenceHelper m_helper;
+  UniformVariable m_random;
+  uint32_t m_steps;
+  std::vector<Change> m_changes; // sorted by time, then by the order they were added in
+  double m_firstPower;
+  uint32_t m_nextId;
+  Ptr<InterferenceHelper::Event> m_rxEvent;
+  uint32_t m_rxStartId;
+};
+
+InterferenceHelperTest::InterferenceHelperTest ()
+  : TestCase ("Check the noise and interference changes against a sorted vector"),
+    m_steps (0),
+    m_firstPower (0),
+    m_nextId (0)
+{
+}
+
+uint32_t
+InterferenceHelperTest::FindChange (uint32_t id) const
+{
+  for (uint32_t i = 0; i < m_changes.size (); i++)
+    {
+      if (m_changes[i].id == id)
+        {
+          return i;
+        }
+    }
+  NS_FATAL_ERROR ("No change " << id);
+  return 0;
+}
+
+void
+InterferenceHelperTest::Prune (uint32_t end)
+{
+  for (uint32_t i = 0; i < end; i++)
+    {
+      m_firstPower += m_changes[i].delta;
+    }
+  m_changes.erase (m_changes.begin (), m_changes.begin () + end);
+}
+
+void
+InterferenceHelperTest::AddEvent (Time duration, double power)
+{
+  // a new packet prunes the changes before the start of the one being
+  // received, or those up to now, including the ones at the current time
+  uint32_t end = 0;
+  if (m_rxEvent != 0)
+    {
+      end = FindChange (m_rxStartId);
+    }
+  else
+    {
+      while (end < m_changes.size () && m_changes[end].time <= Simulator::Now ())
+        {
+          end++;
+        }
+    }
+  Prune (end);
+
+  Ptr<InterferenceHelper::Event> event = m_helper.Add (1000, WifiPhy::GetOfdmRate6Mbps (), WIFI_PREAMBLE_LONG,
+                                                       duration, power);
+  Time times[2] = { Simulator::Now (), Simulator::Now () + duration };
+  double deltas[2] = { power, -power };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      // after the changes at the same time
+      std::vector<Change>::iterator it = m_changes.end ();
+      while (it != m_changes.begin () && (it - 1)->time > times[i])
+        {
+          it--;
+        }
+      Change change;
+      change.time = times[i];
+      change.delta = deltas[i];
+      change.id = m_nextId++;
+      m_changes.insert (it, change);
+    }
+
+  if (m_rxEvent == 0 && m_random.GetInteger (0, 1) == 0)
+    {
+      m_helper.NotifyRxStart ();
+      m_rxEvent = event;
+      m_rxStartId = m_nextId - 2;
+    }
+}
+
+void
+InterferenceHelperTest::Check (void)
+{
+  Time now = Simulator::Now ();
+  static const double energies[] = { 0.5, 2.5, 5.5, 12.5, 30.5 };
+  for (uint32_t e = 0; e < sizeof (energies) / sizeof (energies[0]); e++)
+    {
+      // the end of the first change from now on after which the power is
+      // below the energy, or of the last one
+      double power = m_firstPower;
+      Time end = now;
+      for (uint32_t i = 0; i < m_changes.size (); i++)
+        {
+          power += m_changes[i].delta;
+          end = m_changes[i].time;
+          if (end < now)
+            {
+              continue;
+            }
+          if (power < energies[e])
+            {
+              break;
+            }
+        }
+      Time expected = end > now ? end - now : MicroSeconds (0);
+      NS_TEST_EXPECT_MSG_EQ (m_helper.GetEnergyDuration (energies[e]), expected,
+                             "Energy duration above " << energies[e] << " at step " << m_steps);
+    }
+
+  if (m_rxEvent == 0)
+    {
+      return;
+    }
+  // the changes before the start of the packet being received add up to
+  // the noise, and those between its start and its end are returned
+  uint32_t start = FindChange (m_rxStartId);
+  uint32_t end = FindChange (m_rxStartId + 1);
+  double noise = m_firstPower;
+  for (uint32_t i = 0; i < start; i++)
+    {
+      noise += m_changes[i].delta;
+    }
+  InterferenceHelper::NiChanges ni;
+  NS_TEST_EXPECT_MSG_EQ (m_helper.CalculateNoiseInterferenceW (m_rxEvent, &ni), noise,
+                         "Noise and interference at step " << m_steps);
+  NS_TEST_ASSERT_MSG_EQ (ni.size (), end - start + 1, "Number of changes at step " << m_steps);
+  NS_TEST_EXPECT_MSG_EQ (ni[0].GetTime (), m_rxEvent->GetStartTime (), "First change at step " << m_steps);
+  NS_TEST_EXPECT_MSG_EQ (ni[0].GetDelta (), noise, "First change at step " << m_steps);
+  for (uint32_t i = start + 1; i < end; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ni[i - start].GetTime (), m_changes[i].time, "Change " << i - start << " at step " << m_steps);
+      NS_TEST_EXPECT_MSG_EQ (ni[i - start].GetDelta (), m_changes[i].delta, "Change " << i - start << " at step " << m_steps);
+    }
+  NS_TEST_EXPECT_MSG_EQ (ni.back ().GetTime (), m_rxEvent->GetEndTime (), "Last change at step " << m_steps);
+  NS_TEST_EXPECT_MSG_EQ (ni.back ().GetDelta (), 0, "Last change at step " << m_steps);
+}
+
+void
+InterferenceHelperTest::Step (void)
+{
+  uint32_t action = m_random.GetInteger (0, 99);
+  if (action < 45)
+    {
+      AddEvent (MicroSeconds (m_random.GetInteger (0, 6)), m_random.GetInteger (1, 10));
+    }
+  else if (action < 60 && m_rxEvent != 0)
+    {
+      // possibly before the packet ends, as when the phy switches channel
+      m_helper.NotifyRxEnd ();
+      m_rxEvent = 0;
+      // the changes at the current time are kept
+      uint32_t end = 0;
+      while (end < m_changes.size () && m_changes[end].time < Simulator::Now ())
+        {
+          end++;
+        }
+      Prune (end);
+    }
+  else if (action < 61)
+    {
+      m_helper.EraseEvents ();
+      m_changes.clear ();
+      m_firstPower = 0;
+      m_rxEvent = 0;
+    }
+  Check ();
+
+  if (++m_steps < 20000)
+    {
+      // many steps at the same time
+      uint32_t delay = m_random.GetInteger (0, 5);
+      Simulator::Schedule (MicroSeconds (delay < 3 ? 0 : delay - 2), &InterferenceHelperTest::Step, this);
+    }
+}
+
+void
+InterferenceHelperTest::DoRun (void)
+{
+  m_helper.SetNoiseFigure (1);
+  Simulator::Schedule (MicroSeconds (1), &InterferenceHelperTest::Step, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+class InterferenceHelperTestSuite : public TestSuite
+{
+public:
+  InterferenceHelperTestSuite ();
+};
+
+InterferenceHelperTestSuite::InterferenceHelperTestSuite ()
+  : TestSuite ("devices-wifi-interference-helper", UNIT)
+{
+  AddTestCase (new InterferenceHelperTest);
+}
+
+static InterferenceHelperTestSuite g_interferenceHelperTestSuite;
+} // namespace ns3
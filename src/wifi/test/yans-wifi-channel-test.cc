@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+
+class YansWifiChannelRangeTest : public TestCase
+{
+public:
+  YansWifiChannelRangeTest (double maxRange);
+
+  virtual void DoRun (void);
+private:
+  void CreatePhy (void);
+  void Send (uint32_t i);
+  void Stop (uint32_t i);
+  void RxBegin (std::string context, Ptr<const Packet> packet);
+  void RxEnd (Ptr<const Packet> packet);
+
+  double m_maxRange;
+  Ptr<UniformRandomVariable> m_random;
+  Ptr<YansWifiChannel> m_channel;
+  std::vector<Ptr<YansWifiPhy> > m_phys;
+  std::vector<Ptr<ConstantVelocityMobilityModel> > m_mobility;
+  std::vector<uint32_t> m_expected;
+  std::vector<uint32_t> m_received;
+  uint32_t m_passedUp;
+};
+
+YansWifiChannelRangeTest::YansWifiChannelRangeTest (double maxRange)
+  : TestCase (maxRange > 0.0 ? "Check which moving PHYs receive the packets with a MaxRange"
+              : "Check which moving PHYs receive the packets without a MaxRange"),
+    m_maxRange (maxRange),
+    m_passedUp (0)
+{
+}
+
+/* Half of the PHYs drive at up to 40 m/s, which takes them out of their
+ * cells of the channel's grid between two course changes */
+void
+YansWifiChannelRangeTest::CreatePhy (void)
+{
+  uint32_t i = m_phys.size ();
+  Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+  mobility->SetPosition (Vector (m_random->GetValue (0.0, 1000.0), m_random->GetValue (0.0, 1000.0), 0.0));
+  if (i % 2 == 0)
+    {
+      double speed = m_random->GetValue (0.0, 40.0);
+      double direction = m_random->GetValue (0.0, 2 * M_PI);
+      mobility->SetVelocity (Vector (speed * std::cos (direction), speed * std::sin (direction), 0.0));
+    }
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  phy->SetMobility (mobility);
+  phy->SetChannel (m_channel);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  // sync to every packet, however weak
+  phy->SetAttribute ("EnergyDetectionThreshold", DoubleValue (-500.0));
+  std::ostringstream context;
+  context << i;
+  phy->TraceConnect ("PhyRxBegin", context.str (), MakeCallback (&YansWifiChannelRangeTest::RxBegin, this));
+  phy->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&YansWifiChannelRangeTest::RxEnd, this));
+
+  m_phys.push_back (phy);
+  m_mobility.push_back (mobility);
+  m_expected.push_back (0);
+  m_received.push_back (0);
+}
+
+void
+YansWifiChannelRangeTest::Send (uint32_t i)
+{
+  for (uint32_t j = 0; j < m_phys.size (); j++)
+    {
+      if (j != i && (m_maxRange == 0.0 || m_mobility[i]->GetDistanceFrom (m_mobility[j]) <= m_maxRange))
+        {
+          m_expected[j]++;
+        }
+    }
+  m_phys[i]->SendPacket (Create<Packet> (100), WifiPhy::GetOfdmRate6Mbps (), WIFI_PREAMBLE_LONG, 0);
+}
+
+void
+YansWifiChannelRangeTest::Stop (uint32_t i)
+{
+  m_mobility[i]->SetVelocity (Vector (0.0, 0.0, 0.0));
+}
+
+void
+YansWifiChannelRangeTest::RxBegin (std::string context, Ptr<const Packet> packet)
+{
+  m_received[std::atoi (context.c_str ())]++;
+}
+
+void
+YansWifiChannelRangeTest::RxEnd (Ptr<const Packet> packet)
+{
+  m_passedUp++;
+}
+
+void
+YansWifiChannelRangeTest::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  m_channel = CreateObject<YansWifiChannel> ();
+  m_channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  m_channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  m_channel->SetAttribute ("MaxRange", DoubleValue (m_maxRange));
+
+  for (uint32_t i = 0; i < 59; i++)
+    {
+      CreatePhy ();
+    }
+  // one more PHY once the channel's grid is built, and a course change
+  Simulator::Schedule (Seconds (5.05), &YansWifiChannelRangeTest::CreatePhy, this);
+  Simulator::Schedule (Seconds (10.05), &YansWifiChannelRangeTest::Stop, this, 0);
+  for (uint32_t n = 0; n < 200; n++)
+    {
+      Simulator::Schedule (Seconds (0.1 * (n + 1)), &YansWifiChannelRangeTest::Send, this, n % 59);
+    }
+  Simulator::Run ();
+
+  uint32_t nphys = m_phys.size ();
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < nphys; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], m_expected[i], "Wrong number of packets received by PHY " << i);
+      total += m_expected[i];
+    }
+  // only the packets passed up to the MAC are copied
+  NS_TEST_EXPECT_MSG_EQ (m_channel->GetNCopiesAvoided (), total - m_passedUp, "Wrong number of copies avoided");
+  NS_TEST_EXPECT_MSG_GT (m_passedUp, 0, "No packet passed up");
+  Simulator::Destroy ();
+  if (m_maxRange > 0.0)
+    {
+      NS_TEST_EXPECT_MSG_LT (total, 200 * (nphys - 1) / 2, "Too many PHYs in range for the test to be useful");
+    }
+  NS_TEST_EXPECT_MSG_GT (total, 200, "Too few PHYs in range for the test to be useful");
+}
+
+class YansWifiChannelTestSuite : public TestSuite
+{
+public:
+  YansWifiChannelTestSuite ();
+};
+
+YansWifiChannelTestSuite::YansWifiChannelTestSuite ()
+  : TestSuite ("devices-wifi-yans-channel", UNIT)
+{
+  AddTestCase (new YansWifiChannelRangeTest (0.0));
+  AddTestCase (new YansWifiChannelRangeTest (150.0));
+}
+
+static YansWifiChannelTestSuite g_yansWifiChannelTestSuite;
+
+} // namespace ns3